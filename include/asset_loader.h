@@ -0,0 +1,78 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_engine.h"
+#include "image.h"
+#include "wav.h"
+
+enum AssetKind
+{
+    ASSET_SOUND,
+    ASSET_TEXTURE
+};
+
+enum TextureId
+{
+    TEXTURE_BACKGROUND, // Replaces the sky gradient
+    TEXTURE_COUNT
+};
+
+// One decoded asset, ready for upload
+struct LoadedAsset
+{
+    AssetKind kind = ASSET_SOUND;
+    int id = 0;             // SoundId or TextureId
+    std::string path;
+    bool fromFile = false;  // False if the file is missing or unreadable: sounds
+                            // then hold the built-in beep, textures nothing
+    WavData sound;
+    Image image;
+    double decodeMs = 0.0; // Worker time spent reading, decoding or generating
+};
+
+// Reads and decodes the game's sound (assets/sfx/*.wav) and texture
+// (assets/textures/*.tga) files on worker threads. The main thread polls for
+// finished assets and does the GL/AL uploads itself, so the window can draw
+// while loading continues.
+class AssetLoader
+{
+public:
+    AssetLoader() = default;
+    ~AssetLoader();
+    AssetLoader(const AssetLoader &) = delete;
+    AssetLoader &operator=(const AssetLoader &) = delete;
+
+    // Queue every asset under `root` and start `threadCount` workers
+    void start(const char *root, int threadCount = 2);
+
+    // Take the next decoded asset if one is ready; never blocks
+    bool poll(LoadedAsset &asset);
+
+    // Every asset has been handed out by poll()
+    bool finished() const { return started && delivered == jobCount(); }
+
+    static int jobCount();
+
+private:
+    void workerLoop();
+    void decode(int job, LoadedAsset &asset) const;
+
+    std::string root;
+    bool started = false;
+    int delivered = 0;
+
+    std::vector<std::thread> workers;
+    std::atomic<int> nextJob{0};
+
+    std::mutex doneMutex;
+    std::deque<LoadedAsset> done;
+};
+
+#endif // ASSET_LOADER_H
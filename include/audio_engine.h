@@ -0,0 +1,125 @@
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.h"
+#include "world.h"
+
+// Sound effects, each loaded once into its own cached buffer
+enum SoundId
+{
+    SOUND_JUMP,
+    SOUND_SCORE,
+    SOUND_POWERUP,
+    SOUND_GAME_OVER,
+    SOUND_COUNT
+};
+
+struct AudioStats
+{
+    long long played;  // Sounds started
+    long long stolen;  // Started by cutting off a lower-priority (or older) voice
+    long long dropped; // Not started: queue full, or every voice busy with more important sounds
+};
+
+// OpenAL voice pool. A fixed set of sources is created up front; play() only
+// queues a request, and a mixer thread assigns each request a free source or
+// steals the least important busy one. With OpenAL Soft it also runs without
+// a sound card on the null backend (ALSOFT_DRIVERS=null).
+class AudioEngine
+{
+public:
+    static const int MAX_VOICES = 12;
+    static const int SAMPLE_RATE = 44100; // Of the generated sounds
+
+    AudioEngine() = default;
+    ~AudioEngine() { shutdown(); }
+    AudioEngine(const AudioEngine &) = delete;
+    AudioEngine &operator=(const AudioEngine &) = delete;
+
+    // Open the default device, create the voices and (empty) sound buffers
+    // and start the mixer thread. Returns false (and stays silent) without a
+    // device. Sounds stay silent until they are set.
+    bool init();
+
+    // Offline mode: mix into memory through ALC_SOFT_loopback instead of a
+    // sound card, at `sampleRate` in 16-bit stereo. There is no mixer thread;
+    // call update() and render() in step with the simulation. Returns false
+    // if the OpenAL implementation has no loopback support.
+    bool initLoopback(int sampleRate);
+
+    // Fill a sound's buffer with 16-bit PCM (1 or 2 channels). Call from the
+    // thread that called init(), once per sound; returns false if audio is
+    // off, the sound is already set or the format is not supported.
+    bool setSound(SoundId sound, const short *samples, size_t frames, int channels, int sampleRate);
+
+    // The built-in beep for a sound, mono at SAMPLE_RATE. Pure computation,
+    // so it can run on any thread.
+    static void generateSound(SoundId sound, std::vector<short> &samples);
+
+    // Set every sound that is still empty to its built-in beep
+    void generateSounds();
+
+    // Stop the mixer thread and every voice and release all AL objects
+    void shutdown();
+
+    bool active() const { return context != nullptr; }
+
+    // Request a sound from the game thread. Never blocks or allocates; the
+    // request is dropped if audio is off, the sound is not set yet or the
+    // queue is full.
+    void play(SoundId sound);
+
+    // The sounds for a step's WorldEvent bits
+    void playEvents(unsigned int events);
+
+    // Start the queued sounds (done by the mixer thread, or by the caller
+    // in loopback mode)
+    void update();
+
+    // Loopback mode: mix the next `frames` stereo frames into `out`
+    void render(short *out, int frames);
+
+    AudioStats stats() const;
+
+private:
+    struct Voice
+    {
+        ALuint source;
+        int sound;      // SoundId playing (or last played), -1 if never used
+        uint64_t start; // Sequence number of the request that started it
+    };
+
+    bool createContext(const ALCint *attributes);
+    void createVoicesAndBuffers();
+    void startSound(int sound);
+    void mixerLoop();
+
+    ALCdevice *device = nullptr;
+    ALCcontext *context = nullptr;
+    LPALCRENDERSAMPLESSOFT renderSamples = nullptr; // Loopback mode only
+
+    ALuint buffers[SOUND_COUNT] = {};
+    std::atomic<bool> soundSet[SOUND_COUNT] = {};
+    Voice voices[MAX_VOICES] = {};
+    uint64_t requestCount = 0;
+
+    SpscQueue<uint8_t, 64> requests;
+    std::thread mixer;
+    std::atomic<bool> running{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    std::atomic<long long> played{0}, stolen{0}, dropped{0};
+};
+
+#endif // AUDIO_ENGINE_H
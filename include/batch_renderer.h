@@ -0,0 +1,43 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include "vertex_batch.h"
+
+// Per-frame submission counters
+struct RenderStats
+{
+    int vertices;
+    int drawCalls;
+};
+
+// Submits VertexBatch geometry with client-side vertex arrays (GL 1.1+).
+// Draw code records into batch(); flush() must be called before any GL state
+// change or non-batched drawing and at the end of a frame.
+class BatchRenderer
+{
+public:
+    VertexBatch &batch() { return geometry; }
+
+    // Reset the per-frame counters
+    void beginFrame();
+
+    // Draw everything recorded so far and clear the batch
+    void flush();
+
+    const RenderStats &frameStats() const { return stats; }
+
+    // Draw a whole texture stretched over a rectangle, after everything
+    // recorded so far (one extra draw call)
+    void drawImage(unsigned int texture, float x, float y, float w, float h);
+
+    // Texture sampled by every vertex (the glyph atlas; shapes use its solid
+    // texel). 0 draws untextured.
+    void setTexture(unsigned int texture) { atlasTexture = texture; }
+
+private:
+    VertexBatch geometry;
+    RenderStats stats = {0, 0};
+    unsigned int atlasTexture = 0;
+};
+
+#endif // BATCH_RENDERER_H
@@ -0,0 +1,91 @@
+#ifndef CIRCLE_GEOMETRY_H
+#define CIRCLE_GEOMETRY_H
+
+// Unit-circle lookup tables built at compile time, so drawing circles, arcs
+// and the power-up icons needs no sin/cos calls per vertex.
+
+constexpr double CIRCLE_PI = 3.14159265358979323846;
+
+namespace circle_detail
+{
+// Reduce to [-pi, pi] and sum the Taylor series (plenty accurate for floats)
+constexpr double sinApprox(double x)
+{
+    while (x > CIRCLE_PI)
+        x -= 2.0 * CIRCLE_PI;
+    while (x < -CIRCLE_PI)
+        x += 2.0 * CIRCLE_PI;
+
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 16; n++)
+    {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cosApprox(double x)
+{
+    return sinApprox(x + CIRCLE_PI / 2.0);
+}
+} // namespace circle_detail
+
+// N evenly spaced points on the unit circle starting at angle `phase`.
+// Entry N repeats entry 0 so closed loops can index [0, N] directly.
+template <int N>
+struct CircleTable
+{
+    float cosv[N + 1];
+    float sinv[N + 1];
+};
+
+template <int N>
+constexpr CircleTable<N> makeCircleTable(double phase = 0.0)
+{
+    CircleTable<N> table = {};
+    for (int i = 0; i <= N; i++)
+    {
+        double angle = phase + 2.0 * CIRCLE_PI * (i % N) / N;
+        table.cosv[i] = static_cast<float>(circle_detail::cosApprox(angle));
+        table.sinv[i] = static_cast<float>(circle_detail::sinApprox(angle));
+    }
+    return table;
+}
+
+// Finest tessellation; every level of detail is a power-of-two stride into it
+const int CIRCLE_MAX_SEGMENTS = 256;
+constexpr CircleTable<CIRCLE_MAX_SEGMENTS> unitCircle = makeCircleTable<CIRCLE_MAX_SEGMENTS>();
+
+// Segment count for a circle of the given on-screen radius (pixels)
+inline int circleSegmentsForRadius(float radius)
+{
+    if (radius < 6.0f)
+        return 8; // Particles
+    if (radius < 12.0f)
+        return 16;
+    if (radius < 18.0f)
+        return 32;
+    if (radius < 64.0f)
+        return 64; // Ball, clouds, timer rings
+    return 128;
+}
+
+// Points of one level of detail: i in [0, segments], angle = i * 2pi / segments
+class CircleLod
+{
+public:
+    explicit CircleLod(int segmentCount)
+        : count(segmentCount), stride(CIRCLE_MAX_SEGMENTS / segmentCount) {}
+
+    int segments() const { return count; }
+    float cos(int i) const { return unitCircle.cosv[(i * stride) % CIRCLE_MAX_SEGMENTS]; }
+    float sin(int i) const { return unitCircle.sinv[(i * stride) % CIRCLE_MAX_SEGMENTS]; }
+
+private:
+    int count;
+    int stride;
+};
+
+#endif // CIRCLE_GEOMETRY_H
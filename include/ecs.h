@@ -0,0 +1,152 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class WorkStealingPool;
+
+// True if C is one of Components
+template <typename C, typename... Components>
+struct HasComponent;
+
+template <typename C>
+struct HasComponent<C> : std::false_type
+{
+};
+
+template <typename C, typename First, typename... Rest>
+struct HasComponent<C, First, Rest...>
+    : std::integral_constant<bool, std::is_same<C, First>::value || HasComponent<C, Rest...>::value>
+{
+};
+
+// Entities of one archetype (one fixed set of components), stored as one
+// packed array per component: a system that only needs a Scroll walks one
+// contiguous array, whatever else the entities carry. An entity is just its
+// row. Rows keep their insertion order, so iteration (and with it the order of
+// random draws, events and state hashes) is deterministic.
+template <typename... Components>
+class EntityTable
+{
+public:
+    int size() const { return static_cast<int>(std::get<0>(columns).size()); }
+    bool empty() const { return size() == 0; }
+
+    void reserve(int rows)
+    {
+        int expand[] = {(std::get<std::vector<Components>>(columns).reserve(rows), 0)...};
+        (void)expand;
+    }
+
+    void clear()
+    {
+        int expand[] = {(std::get<std::vector<Components>>(columns).clear(), 0)...};
+        (void)expand;
+    }
+
+    // Append one entity
+    void add(const Components &...components)
+    {
+        int expand[] = {(std::get<std::vector<Components>>(columns).push_back(components), 0)...};
+        (void)expand;
+    }
+
+    // Column access; valid until the next add() or removal
+    template <typename C>
+    C *column()
+    {
+        static_assert(HasComponent<C, Components...>::value, "The table has no such component");
+        return std::get<std::vector<C>>(columns).data();
+    }
+
+    template <typename C>
+    const C *column() const
+    {
+        static_assert(HasComponent<C, Components...>::value, "The table has no such component");
+        return std::get<std::vector<C>>(columns).data();
+    }
+
+    template <typename C>
+    C &get(int row) { return column<C>()[row]; }
+
+    template <typename C>
+    const C &get(int row) const { return column<C>()[row]; }
+
+    // Remove every row for which remove(row) returns true, keeping the others
+    // in order. remove() is called once per row, first row first, and sees
+    // the row intact, so it may act on what it removes. Each column is then
+    // compacted by moving the runs between removed rows down in blocks.
+    template <typename Predicate>
+    void removeIf(Predicate remove)
+    {
+        removedRows.clear();
+        for (int row = 0, count = size(); row < count; row++)
+        {
+            if (remove(row))
+                removedRows.push_back(row);
+        }
+        if (removedRows.empty())
+            return;
+        int expand[] = {(compact(std::get<std::vector<Components>>(columns)), 0)...};
+        (void)expand;
+    }
+
+private:
+    template <typename C>
+    void compact(std::vector<C> &column)
+    {
+        int removed = static_cast<int>(removedRows.size());
+        int kept = removedRows[0];
+        for (int r = 0; r < removed; r++)
+        {
+            int begin = removedRows[r] + 1;
+            int end = r + 1 < removed ? removedRows[r + 1] : static_cast<int>(column.size());
+            std::move(column.begin() + begin, column.begin() + end, column.begin() + kept);
+            kept += end - begin;
+        }
+        column.resize(kept);
+    }
+
+    std::vector<int> removedRows; // Scratch for removeIf()
+    std::tuple<std::vector<Components>...> columns;
+};
+
+// Systems with declared access, grouped into stages that may run on several
+// threads at once. Access is a bit mask chosen by the caller (typically one
+// bit per component column, or per table and column). Two systems conflict
+// when one writes what the other reads or writes; a system goes into the
+// first stage after the last one holding a system it conflicts with, so the
+// outcome is the same as running the systems one by one in the order added.
+class SystemSchedule
+{
+public:
+    // name is a string literal, shown as the system's profiler zone
+    void add(const char *name, unsigned reads, unsigned writes, std::function<void()> run);
+
+    // Run every stage in order; the systems of a stage run on the pool (or
+    // one by one on this thread without one)
+    void run(WorkStealingPool *pool = nullptr);
+
+    int stageCount() const { return static_cast<int>(stages.size()); }
+
+private:
+    struct System
+    {
+        const char *name;
+        unsigned reads;
+        unsigned writes;
+        std::function<void()> run;
+    };
+
+    static void runSystem(const System &system);
+
+    std::vector<System> systems;
+    std::vector<std::vector<int>> stages; // Indices into systems
+};
+
+#endif // ECS_H
@@ -0,0 +1,33 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+
+// Notices when a file is written or replaced (editors often save by
+// renaming a new file over the old one). Uses inotify on Linux, without
+// blocking or a thread; elsewhere it compares the modification time at most
+// once a second.
+class FileWatcher
+{
+public:
+    FileWatcher() = default;
+    ~FileWatcher() { stop(); }
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // The file need not exist yet
+    bool watch(const char *path);
+    void stop();
+
+    // True once for each batch of changes since the last call. Never blocks.
+    bool changed();
+
+private:
+    std::string directory, name;
+    int fd = -1;    // inotify descriptor
+    int watchId = -1;
+    long long lastModified = 0; // Polling fallback
+    long long lastCheck = 0;
+};
+
+#endif // FILE_WATCHER_H
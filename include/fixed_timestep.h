@@ -0,0 +1,42 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <chrono>
+
+// Accumulator for running a simulation at a fixed tick rate while rendering at
+// whatever rate the display allows. Call advance() once per rendered frame,
+// run the returned number of ticks, then draw with alpha() to interpolate
+// between the previous and current simulation state.
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(int tickRate);
+
+    void setTickRate(int tickRate);
+    int tickRate() const { return rate; }
+    double tickSeconds() const { return tickLength; }
+
+    // Forget any accumulated time (e.g. after a pause or a long load)
+    void reset();
+
+    // Number of whole ticks that elapsed since the last call. Long stalls are
+    // clamped so a hiccup doesn't trigger a burst of catch-up ticks.
+    int advance();
+
+    // Fraction of the next tick already elapsed, in [0, 1)
+    float alpha() const { return static_cast<float>(accumulator / tickLength); }
+
+    // Time from now until advance() returns a tick, for a loop that sleeps
+    // in between (0 if one is already due)
+    double secondsToNextTick() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    int rate;
+    double tickLength;
+    double accumulator;
+    Clock::time_point lastTime;
+};
+
+#endif // FIXED_TIMESTEP_H
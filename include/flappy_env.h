@@ -0,0 +1,60 @@
+#ifndef FLAPPY_ENV_H
+#define FLAPPY_ENV_H
+
+/* C interface to VecEnv (vec_env.h) for external tools, e.g. from Python:
+ *
+ *   env = lib.flappy_env_create(4096, 2, 60, None)
+ *   lib.flappy_env_reset(env, seeds)
+ *   lib.flappy_env_step(env, actions, observations, rewards, dones)
+ *
+ * Arrays are plain C arrays with one entry per environment (observations:
+ * FLAPPY_ENV_OBSERVATION_SIZE floats per environment, laid out as in
+ * VecEnvObservation). Functions are not thread-safe per handle. */
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(FLAPPY_ENV_BUILD)
+#define FLAPPY_ENV_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define FLAPPY_ENV_API __declspec(dllimport)
+#else
+#define FLAPPY_ENV_API __attribute__((visibility("default")))
+#endif
+
+#define FLAPPY_ENV_OBSERVATION_SIZE 9
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FlappyEnv FlappyEnv;
+
+/* `count` games in `mode` (1: Easy, 2: Medium, 3: Hard, 4: Time Trial) at
+ * `tick_rate` steps per second (0 for the default 60), with the tuning file
+ * at `tuning_path` (NULL for the built-in values). Returns NULL and prints
+ * the reason on bad arguments or an unreadable tuning file. */
+FLAPPY_ENV_API FlappyEnv *flappy_env_create(int count, int mode, int tick_rate, const char *tuning_path);
+FLAPPY_ENV_API void flappy_env_destroy(FlappyEnv *env);
+
+FLAPPY_ENV_API int flappy_env_size(const FlappyEnv *env);
+
+/* Start a new game in every environment (game i from seeds[i]), or in one */
+FLAPPY_ENV_API void flappy_env_reset(FlappyEnv *env, const uint64_t *seeds);
+FLAPPY_ENV_API void flappy_env_reset_one(FlappyEnv *env, int index, uint64_t seed);
+
+/* Advance every running game by one tick; actions[i] != 0 jumps. Outputs
+ * may be NULL. rewards: points scored minus lives lost; dones: 1 once the
+ * game is over (it then stays as it is until reset). */
+FLAPPY_ENV_API void flappy_env_step(FlappyEnv *env, const uint8_t *actions, float *observations, float *rewards,
+                                    uint8_t *dones);
+
+FLAPPY_ENV_API void flappy_env_observe(const FlappyEnv *env, float *observations);
+
+FLAPPY_ENV_API int flappy_env_score(const FlappyEnv *env, int index);
+FLAPPY_ENV_API int flappy_env_ticks(const FlappyEnv *env, int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLAPPY_ENV_H */
@@ -0,0 +1,89 @@
+#ifndef FRAME_EXPORTER_H
+#define FRAME_EXPORTER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ExportStats
+{
+    int frames;         // Frames written
+    double encodeMs;    // Encoder thread busy time
+    double writeMs;     // Writer thread busy time
+    int rendererStalls; // Times acquireFrame() waited for a free buffer
+};
+
+// Writes captured frames to disk on two worker threads: one converts the
+// RGBA capture to the output format, the other writes it, so the renderer
+// only waits when every buffer is still in flight. A path ending in .y4m is
+// written as an uncompressed YUV 4:2:0 video; anything else is a printf
+// pattern for a PPM image sequence (e.g. "frames/frame%05d.ppm") with one
+// integer conversion for the frame number and no other directives but "%%".
+class FrameExporter
+{
+public:
+    static const int BUFFER_COUNT = 4; // Per stage
+
+    FrameExporter() = default;
+    ~FrameExporter() { finish(); }
+    FrameExporter(const FrameExporter &) = delete;
+    FrameExporter &operator=(const FrameExporter &) = delete;
+
+    // Y4M needs an even width and height
+    bool open(const char *path, int width, int height, int fps);
+
+    // Renderer side: a width * height RGBA buffer, bottom row first (as
+    // glReadPixels fills it), to capture the next frame into; then submit it
+    unsigned char *acquireFrame();
+    void submitFrame();
+
+    // Write everything submitted and stop the threads. Returns false if any
+    // write failed.
+    bool finish();
+
+    ExportStats stats() const;
+
+private:
+    // Bounded hand-off of buffer indices between two threads; -1 marks the end
+    class IndexQueue
+    {
+    public:
+        void push(int index);
+        int pop();
+        bool tryPop(int &index);
+
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<int> indices;
+    };
+
+    void encodeLoop();
+    void writeLoop();
+    void encodeY4m(const unsigned char *rgba, std::vector<unsigned char> &out) const;
+    void encodePpm(const unsigned char *rgba, std::vector<unsigned char> &out) const;
+
+    std::string path;
+    bool video = false;
+    int width = 0, height = 0;
+    FILE *videoFile = nullptr;
+    bool writeFailed = false;
+
+    std::vector<std::vector<unsigned char>> captures; // RGBA
+    std::vector<std::vector<unsigned char>> encoded;  // File contents
+    IndexQueue freeCaptures, pendingCaptures;
+    IndexQueue freeEncoded, pendingEncoded;
+    int currentCapture = -1;
+
+    std::thread encoder, writer;
+
+    int framesWritten = 0;
+    double encodeMs = 0.0, writeMs = 0.0;
+    int stalls = 0;
+};
+
+#endif // FRAME_EXPORTER_H
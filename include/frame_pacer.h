@@ -0,0 +1,56 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+
+#include "latency_stats.h"
+
+// Paces rendering to a target frame rate from the steady clock. Call
+// waitForFrame() before drawing a frame and framePresented() after its buffer
+// swap.
+//
+// Frames are scheduled one period apart; waitForFrame() sleeps until the
+// frame's slot, the last stretch by spinning so it lands within a few
+// microseconds. A frame that starts late is not followed by a burst of
+// catch-up frames: the slots it missed are skipped (and counted) and the
+// schedule restarts from now. When the buffer swap itself blocks for a good
+// part of the period, the display (vsync) is already pacing the loop, and
+// waitForFrame() stops sleeping so the two waits do not add up.
+//
+// Uncapped (target 0) never waits; frame times are recorded either way.
+class FramePacer
+{
+public:
+    explicit FramePacer(double fps);
+
+    // Frames per second, or 0 for as fast as possible
+    void setTargetFps(double fps);
+    bool uncapped() const { return period <= 0.0; }
+
+    // Forget the schedule (call when the loop stopped drawing for a while)
+    void reset();
+
+    void waitForFrame();
+    void framePresented(double swapSeconds);
+
+    // Milliseconds between consecutive presents since the last reset()s
+    const LatencyStats &frameTimes() const { return times; }
+    long long skippedFrames() const { return skipped; }
+
+    // The last swaps blocked long enough that the display sets the pace
+    bool displayPaced() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double period; // Seconds, 0 when uncapped
+    bool scheduled;
+    Clock::time_point nextFrame;
+    bool presented;
+    Clock::time_point lastPresent;
+    double swapAverage; // Seconds, smoothed over the last frames
+    long long skipped;
+    LatencyStats times;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,13 @@
+#ifndef GLUT_FONTS_H
+#define GLUT_FONTS_H
+
+#include "glyph_atlas.h"
+
+// Rasterizes the GLUT bitmap fonts (Helvetica 12/18, Times Roman 24) into
+// `atlas` and uploads it as an RGBA texture (white, glyph coverage in alpha).
+// Draws into the back buffer and reads it back, so it needs a current
+// context with a window of at least the atlas size; call it at the start of
+// a frame, before clearing. Returns the texture, or 0 on failure.
+unsigned int bakeGlutFontAtlas(GlyphAtlas &atlas);
+
+#endif // GLUT_FONTS_H
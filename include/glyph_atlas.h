@@ -0,0 +1,132 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <vector>
+
+#include "vertex_batch.h"
+
+// Bitmap fonts baked into one texture, drawn as textured quads through the
+// vertex batch. The atlas only holds metrics and coverage; rasterizing the
+// glyphs and uploading the texture is done by the game (glut_fonts.h).
+
+enum FontId
+{
+    FONT_HELVETICA_12,
+    FONT_HELVETICA_18,
+    FONT_TIMES_ROMAN_24,
+    FONT_COUNT
+};
+
+// Printable ASCII; other characters are skipped
+const int FIRST_GLYPH = 32;
+const int GLYPH_COUNT = 95;
+
+struct Glyph
+{
+    // Quad relative to the pen position on the baseline, in pixels
+    // (zero-sized for blank glyphs)
+    float left, bottom, width, height;
+    float u0, v0, u1, v1;
+    float advance;
+
+    // Atlas pixel the glyph's pen position was placed at when baking
+    int originX, originY;
+};
+
+struct FontFace
+{
+    Glyph glyphs[GLYPH_COUNT];
+    int lineHeight;
+
+    // nullptr for characters outside the atlas
+    const Glyph *glyph(char c) const
+    {
+        int index = static_cast<unsigned char>(c) - FIRST_GLYPH;
+        return index >= 0 && index < GLYPH_COUNT ? &glyphs[index] : nullptr;
+    }
+};
+
+class GlyphAtlas
+{
+public:
+    // Free pixels around every glyph cell, for bitmaps that overhang their
+    // advance or the line
+    static const int PADDING = 2;
+
+    // Assign every glyph a cell in a width x height atlas, given each font's
+    // line height and per-glyph advances. Returns false if they do not fit.
+    bool layout(const int advances[FONT_COUNT][GLYPH_COUNT], const int lineHeights[FONT_COUNT],
+                int width, int height);
+
+    bool ready() const { return atlasWidth > 0; }
+    int width() const { return atlasWidth; }
+    int height() const { return atlasHeight; }
+    const FontFace &font(FontId id) const { return fonts[id]; }
+
+    // Glyph coverage, one byte per pixel, bottom row first. Filled by the
+    // baker; a small block at the origin is kept solid for untextured shapes.
+    std::vector<unsigned char> &coverage() { return pixels; }
+    const std::vector<unsigned char> &coverage() const { return pixels; }
+    void fillSolidBlock();
+
+    // Texture coordinate of the solid block (see VertexBatch::setSolidTexCoord)
+    float solidU() const;
+    float solidV() const;
+
+    // Width of a string in pixels
+    float textWidth(FontId id, const char *text) const;
+
+    // Bumped by every layout(), so cached text knows to lay out again
+    int generation() const { return layoutGeneration; }
+
+private:
+    FontFace fonts[FONT_COUNT] = {};
+    int atlasWidth = 0, atlasHeight = 0;
+    std::vector<unsigned char> pixels;
+    int layoutGeneration = 0;
+};
+
+// Lay out `text` in the current batch color with its baseline starting at
+// (x, y), snapped to whole pixels so the glyphs map 1:1 to texels
+void drawText(VertexBatch &batch, const GlyphAtlas &atlas, FontId font, float x, float y, const char *text);
+
+// A string whose quads are laid out once and reused every frame until the
+// text changes. Draws into the batch like drawText() and never allocates
+// after the first layout of its longest text.
+class CachedText
+{
+public:
+    static const int MAX_LENGTH = 63;
+
+    explicit CachedText(FontId font = FONT_HELVETICA_18);
+
+    // Replace the text (longer strings are cut); re-layout happens on the
+    // next draw only if it differs from the current one
+    void set(const char *text);
+
+    // prefix + value + suffix, formatted only when one of them changed
+    void setNumber(const char *prefix, int value, const char *suffix = "");
+
+    const char *text() const { return buffer; }
+
+    void draw(VertexBatch &batch, const GlyphAtlas &atlas, float x, float y);
+
+    // How many times the quads were rebuilt
+    int layoutCount() const { return layouts; }
+
+private:
+    FontId font;
+    char buffer[MAX_LENGTH + 1];
+    bool dirty;
+
+    // What setNumber() formatted last, to skip formatting unchanged values
+    const char *numberPrefix;
+    const char *numberSuffix;
+    int number;
+
+    int atlasGeneration;
+    std::vector<Vertex> quads; // Two triangles per visible glyph, at the origin
+    int layouts;
+};
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,17 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <vector>
+
+// 8-bit RGBA pixels, bottom row first (the order glTexImage2D expects)
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels; // width * height * 4
+};
+
+// Uncompressed true-color TGA (24 or 32 bits per pixel, either row order)
+bool loadTga(Image &image, const char *path);
+
+#endif // IMAGE_H
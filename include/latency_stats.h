@@ -0,0 +1,38 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <vector>
+
+// Percentiles of one kind of measured duration (in milliseconds)
+struct LatencySummary
+{
+    long long count; // Samples added in total
+    double mean;     // The rest cover the kept samples
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+// Keeps the last `capacity` samples of a duration for percentile reports.
+// add() is O(1) and never allocates; summary() sorts a copy, so call it for
+// reports, not per frame.
+class LatencyStats
+{
+public:
+    explicit LatencyStats(int capacity = 4096);
+
+    void add(double ms);
+    void clear();
+
+    long long count() const { return total; }
+
+    // All zero without samples
+    LatencySummary summary() const;
+
+private:
+    std::vector<double> samples; // Ring buffer
+    long long total;
+};
+
+#endif // LATENCY_STATS_H
@@ -0,0 +1,120 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "planner.h"
+#include "rng.h"
+#include "spsc_queue.h"
+#include "world.h"
+
+// Entries a generator produces per batch
+const int LEVEL_CHUNK_SIZE = 16;
+
+// Seeded generator of spawns for one game. Unlike the classic spawner, every
+// gap is checked to be reachable from the previous one before it is handed
+// out: a JumpPlanner has to find jumps from the previous gap's centre (ball at
+// rest as it enters the pipe) through both pipes. Gaps that fail are drawn
+// again; after MAX_DRAWS failures the gap stays at the previous height.
+//
+// Entries are generated ahead of time, so each uses the difficulty the game
+// is expected to have when it spawns: one point per pipe passed (no double
+// points, no lives lost) or the Time Trial clock. The same seed and settings
+// always give the same entries.
+class LevelGenerator
+{
+public:
+    static const int MAX_DRAWS = 8;
+
+    // Start at spawn `firstSpawn`, the first gap reachable from
+    // `previousGapY` (any gap with -1). Continuing a game part way through
+    // draws different gaps than a game started with the same seed.
+    void reset(uint64_t seed, GameMode mode, const DifficultySettings &settings, const Tuning &tuning,
+               int firstSpawn = 0, float previousGapY = -1.0f);
+
+    // Append the next `count` entries
+    void generate(SpawnEntry *out, int count);
+
+    int generated() const { return spawnIndex; }
+    int redrawn() const { return redrawCount; }  // Gaps drawn again
+    int fallbacks() const { return fallbackCount; } // Gaps left at the previous height
+
+private:
+    struct Difficulty
+    {
+        float pipeSpeed;
+        float gapHeight;
+        float gravity;
+    };
+
+    Difficulty expectedDifficulty(int spawn) const;
+    bool reachable(float fromGapY, float toGapY, const Difficulty &difficulty);
+
+    Rng rng;
+    GameMode mode = MODE_EASY;
+    DifficultySettings settings = modes[0];
+    Tuning tuning = DEFAULT_TUNING;
+    int spawnIndex = 0;
+    float previousGapY = -1.0f;
+    int redrawCount = 0;
+    int fallbackCount = 0;
+
+    JumpPlanner planner;
+    World scratch; // Two-pipe world the planner checks transitions in
+};
+
+// Hands a game its generated spawns. Threaded feeds generate on a worker
+// thread a few minutes of play ahead; next() then only pops a ready entry
+// from a lock-free queue. Unthreaded feeds generate inline (for headless
+// tools). Both give the same entries for the same seed.
+class LevelFeed
+{
+public:
+    explicit LevelFeed(bool threaded = true) : threaded(threaded) {}
+    ~LevelFeed();
+    LevelFeed(const LevelFeed &) = delete;
+    LevelFeed &operator=(const LevelFeed &) = delete;
+
+    // Start over for a new game (called by resetWorld()), or continue one
+    // from spawn `firstSpawn` after a gap at `previousGapY` with new
+    // settings (called by applyTuning()). The first chunk is generated
+    // before this returns.
+    void restart(uint64_t seed, GameMode mode, const DifficultySettings &settings, const Tuning &tuning,
+                 int firstSpawn = 0, float previousGapY = -1.0f);
+
+    // Next entry, for the game thread
+    SpawnEntry next();
+
+    // Entries next() returned since the game started
+    int handedOut() const { return handedOutCount; }
+
+    // next() calls that found the queue empty and waited for the worker
+    long long stalls() const { return stallCount; }
+
+private:
+    static const unsigned QUEUE_SIZE = 256; // About seven minutes at Medium
+
+    void stopWorker();
+    void workerLoop();
+
+    bool threaded;
+    LevelGenerator generator;
+    long long stallCount = 0;
+    int handedOutCount = 0;
+
+    // Unthreaded: the chunk being handed out
+    SpawnEntry chunk[LEVEL_CHUNK_SIZE];
+    int chunkPosition = LEVEL_CHUNK_SIZE;
+
+    // Threaded
+    SpscQueue<SpawnEntry, QUEUE_SIZE> queue;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+};
+
+#endif // LEVEL_GENERATOR_H
@@ -0,0 +1,28 @@
+#ifndef OFFSCREEN_CONTEXT_H
+#define OFFSCREEN_CONTEXT_H
+
+// GL compatibility context without a window or display server: an EGL
+// pbuffer on Mesa's surfaceless platform, which renders with llvmpipe when
+// there is no GPU. Only available when the game is built with EGL.
+class OffscreenContext
+{
+public:
+    OffscreenContext() = default;
+    ~OffscreenContext() { destroy(); }
+    OffscreenContext(const OffscreenContext &) = delete;
+    OffscreenContext &operator=(const OffscreenContext &) = delete;
+
+    // Create a width x height RGBA pbuffer and make its context current
+    bool create(int width, int height);
+    void destroy();
+
+    // The GL renderer string, e.g. "llvmpipe (LLVM 15.0.6, 256 bits)"
+    const char *renderer() const;
+
+private:
+    void *display = nullptr; // EGLDisplay
+    void *surface = nullptr; // EGLSurface
+    void *context = nullptr; // EGLContext
+};
+
+#endif // OFFSCREEN_CONTEXT_H
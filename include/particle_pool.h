@@ -0,0 +1,49 @@
+#ifndef PARTICLE_POOL_H
+#define PARTICLE_POOL_H
+
+#include <vector>
+
+// Fixed-capacity particle storage laid out as structure-of-arrays so the
+// per-frame integration runs as a SIMD kernel (AVX when compiled with it,
+// SSE2 otherwise, plain C++ on other targets). Colors are quantized to 8 bits
+// per channel; alpha is derived from the remaining life when drawing.
+class ParticlePool
+{
+public:
+    explicit ParticlePool(int capacity);
+
+    int size() const { return count; }
+    int capacity() const { return cap; }
+    bool full() const { return count >= cap; }
+    void clear();
+
+    // Add a particle with full life. Returns false (and does nothing) when full.
+    bool spawn(float x, float y, float vx, float vy, float r, float g, float b);
+
+    // Advance every particle by `frames` 60 Hz frames (motion, gravity, drag,
+    // fade) and drop the ones whose life ran out. Removal is swap-and-pop, so
+    // the order of the remaining particles may change.
+    void update(float frames);
+
+    // Per-particle accessors, valid for i in [0, size())
+    float x(int i) const { return px[i]; }
+    float y(int i) const { return py[i]; }
+    float prevX(int i) const { return lastX[i]; }
+    float prevY(int i) const { return lastY[i]; }
+    float life(int i) const { return lifeLeft[i]; }
+    float alpha(int i) const; // Quadratic fade out over the particle's life
+    void color(int i, float &r, float &g, float &b) const;
+
+private:
+    int count;
+    int cap;
+
+    // Arrays are padded to the SIMD width so the kernel needs no scalar tail
+    std::vector<float> px, py;
+    std::vector<float> vx, vy;
+    std::vector<float> lifeLeft;
+    std::vector<float> lastX, lastY;
+    std::vector<unsigned int> rgb; // 0x00BBGGRR
+};
+
+#endif // PARTICLE_POOL_H
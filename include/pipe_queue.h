@@ -0,0 +1,80 @@
+#ifndef PIPE_QUEUE_H
+#define PIPE_QUEUE_H
+
+#include <vector>
+
+// prevX holds the position before the last step, for render interpolation
+struct Pipe
+{
+    float x;
+    float gapY;
+    float prevX;
+};
+
+// Fixed-capacity ring buffer of pipes, oldest (leftmost) first. Pipes spawn
+// at the right edge and all move at the same speed, so the queue stays sorted
+// by x; lowerBound() uses that to find the few pipes near a given column
+// without scanning the rest. Pushing and popping are O(1) and never allocate.
+class PipeQueue
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit PipeQueue(int capacity);
+
+    int size() const { return count; }
+    int capacity() const { return mask + 1; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count > mask; }
+    void clear() { head = count = 0; }
+
+    // i = 0 is the oldest pipe, valid for i in [0, size())
+    Pipe &operator[](int i) { return slots[(head + i) & mask]; }
+    const Pipe &operator[](int i) const { return slots[(head + i) & mask]; }
+    Pipe &front() { return (*this)[0]; }
+    const Pipe &front() const { return (*this)[0]; }
+    Pipe &back() { return (*this)[count - 1]; }
+    const Pipe &back() const { return (*this)[count - 1]; }
+
+    // Append a pipe at the right end. Returns false (and does nothing) when
+    // full; the caller keeps the x order.
+    bool push_back(const Pipe &pipe);
+    void pop_front();
+
+    // Index of the first pipe with x >= minX (size() if there is none)
+    int lowerBound(float minX) const;
+
+    // Range-for support, oldest first
+    template <typename Queue, typename Value>
+    class Iterator
+    {
+    public:
+        Iterator(Queue *queue, int index) : queue(queue), index(index) {}
+        Value &operator*() const { return (*queue)[index]; }
+        Value *operator->() const { return &(*queue)[index]; }
+        Iterator &operator++()
+        {
+            index++;
+            return *this;
+        }
+        bool operator!=(const Iterator &other) const { return index != other.index; }
+
+    private:
+        Queue *queue;
+        int index;
+    };
+    typedef Iterator<PipeQueue, Pipe> iterator;
+    typedef Iterator<const PipeQueue, const Pipe> const_iterator;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+private:
+    std::vector<Pipe> slots;
+    int mask;
+    int head;  // Slot of the oldest pipe
+    int count;
+};
+
+#endif // PIPE_QUEUE_H
@@ -0,0 +1,145 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "world.h"
+
+// Solvability oracle: searches for a jump schedule that keeps the ball alive
+// through a sequence of pipes.
+//
+// Nothing but the ball depends on the jumps as long as no life is lost: pipe
+// movement, scoring and the difficulty it raises, Time Trial steps and power-up
+// timers all follow from the world alone. plan() therefore first replays
+// those for the whole horizon (the "track": gravity, gap height and the pipes
+// in reach of the ball, per tick), then runs a depth-first search over ball
+// states (tick, y, speed) against it. Every state that was expanded is
+// remembered, quantized to PLAN_Y_STEP x PLAN_SPEED_STEP cells, so a cell that
+// led nowhere is never searched twice; states outside the screen or inside a
+// pipe are cut at once. The jump that chases the next gap (as
+// scriptedPolicy() does) is tried first, so easy sequences take little more
+// than one state per tick.
+//
+// A schedule that is found is exact: its ticks use step()'s arithmetic, and
+// playing it in the world survives as long as the world follows the track.
+// Power-ups that would be picked up on the way are not modelled, nor are
+// level-ups from double points gained on the way. "No schedule" is exact up to
+// the quantization.
+
+const float PLAN_Y_STEP = 1.0f;      // Pixels
+const float PLAN_SPEED_STEP = 0.25f; // Pixels per frame
+
+enum PlanResult
+{
+    PLAN_FOUND,      // jumps() survives the whole horizon
+    PLAN_IMPOSSIBLE, // Every schedule loses a life
+    PLAN_GAVE_UP     // The node budget ran out first
+};
+
+class JumpPlanner
+{
+public:
+    JumpPlanner();
+
+    // States expanded per plan() before it gives up
+    void setNodeBudget(int nodes) { nodeBudget = nodes; }
+
+    // Search from the world's current state (which must be PLAYING) for up to
+    // `maxTicks` ticks. Pipes the world has not spawned yet take their gapY
+    // from `upcomingGaps` in order (after world.nextSpawn with generated
+    // levels); the horizon ends before a pipe beyond those could reach the
+    // ball.
+    PlanResult plan(const World &world, const float *upcomingGaps, int upcomingCount, int maxTicks);
+    PlanResult plan(const World &world, int maxTicks) { return plan(world, nullptr, 0, maxTicks); }
+
+    // Length of the last search, in ticks
+    int horizon() const { return static_cast<int>(track.size()); }
+
+    // First tick at which the world spawns a pipe that was not given (or
+    // horizon() if none does): from there on the world knows more than the plan
+    int unknownSpawnTick() const { return firstUnknownSpawn; }
+
+    // Last schedule found: jumps()[t] is the jump for tick t from the
+    // planned state, ballY()/ballSpeed()[t] the ball after that tick
+    const std::vector<uint8_t> &jumps() const { return path; }
+    const std::vector<float> &ballY() const { return pathY; }
+    const std::vector<float> &ballSpeed() const { return pathSpeed; }
+
+    // States expanded by the last search
+    int nodes() const { return nodeCount; }
+
+private:
+    struct TrackTick
+    {
+        float gravity;
+        float gapHeight;
+        float targetY;   // Centre of the next gap the ball has not passed
+        int firstPipe;   // Range in trackPipes the ball can hit this tick
+        int endPipe;
+    };
+
+    struct Frame
+    {
+        float y;
+        float speed;
+        uint8_t preferred; // Jump tried first
+        uint8_t tried;     // Actions tried so far
+    };
+
+    void buildTrack(const World &world, const float *upcomingGaps, int upcomingCount, int maxTicks);
+    bool visit(int tick, float y, float speed); // False if the cell was seen before
+
+    int nodeBudget;
+    int nodeCount;
+    int firstUnknownSpawn;
+    float frames;
+    float jumpPower;
+    bool swept; // world.sweptCollisions
+
+    std::vector<TrackTick> track;
+    std::vector<Pipe> trackPipes;
+    std::vector<Frame> stack;
+    std::vector<uint8_t> path;
+    std::vector<float> pathY;
+    std::vector<float> pathSpeed;
+
+    // Open-addressing set of visited cells; a cell belongs to the current
+    // search when its stamp matches `generation`, so clearing is O(1)
+    std::vector<uint64_t> cellKeys;
+    std::vector<uint32_t> cellStamps;
+    uint32_t generation;
+    int cellCount;
+};
+
+// Demo player built on the planner: follows a planned schedule and plans
+// again whenever the world leaves it (a new pipe, a power-up, a lost life).
+// Falls back to scriptedPolicy() while no schedule exists.
+class Autopilot
+{
+public:
+    Input next(const World &world);
+
+    // Forget the current plan (call when the world is reset)
+    void reset();
+
+    // Searches run, and how many proved that the pipes ahead cannot be
+    // survived from where the ball was
+    int plans() const { return planCount; }
+    int impossiblePlans() const { return impossibleCount; }
+
+private:
+    bool onPlan(const World &world) const;
+
+    JumpPlanner planner;
+    int planStart = 0; // world.tickCount the plan starts from
+    int planEnd = 0;   // First tick (world.tickCount) the plan does not cover
+    bool planned = false;
+    int retryTick = 0; // With no plan, world.tickCount to search again at
+    int livesAtPlan = 0;
+    int powerUpAtPlan = -1;
+    int planCount = 0;
+    int impossibleCount = 0;
+};
+
+#endif // PLANNER_H
@@ -0,0 +1,10 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "world.h"
+
+// Simple scripted player: flap whenever the ball falls below the centre of the
+// next gap. Good enough to keep headless runs alive for a while.
+Input scriptedPolicy(const World &world);
+
+#endif // POLICY_H
@@ -0,0 +1,124 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+// Frame profiler: PROFILE_ZONE("name") times the rest of the enclosing scope
+// into a ring buffer of recent events, and frameMark() separates frames. While
+// the profiler is disabled a zone costs one relaxed atomic load; building with
+// FLAPPY_PROFILING=0 removes the zones entirely. Zone names must be string
+// literals (only the pointer is stored).
+
+#ifndef FLAPPY_PROFILING
+#define FLAPPY_PROFILING 1
+#endif
+
+struct ProfileEvent
+{
+    const char *name;
+    int64_t start; // Nanoseconds since the profiler was created
+    int64_t end;
+    int depth;     // Nesting level on its thread
+    int thread;    // Small per-thread id, 0 for the first thread that records
+};
+
+// Per-zone summary over recent frames
+struct ZoneStats
+{
+    const char *name;
+    int depth;
+    double avgMs;        // Total time per frame, averaged over the frames
+    double maxMs;        // Largest total in a single frame
+    double callsPerFrame;
+};
+
+class Profiler
+{
+public:
+    static const int EVENT_CAPACITY = 1 << 17;
+    static const int FRAME_CAPACITY = 4096;
+
+    Profiler();
+
+    void setEnabled(bool on);
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    int64_t now() const;
+
+    // Called by the zones. Safe from several threads; an event that is being
+    // overwritten while a report reads it may show up garbled.
+    void record(const char *name, int64_t start, int64_t end, int depth);
+
+    // End the current frame and start the next (call once per presented frame)
+    void frameMark();
+
+    // Durations in ms of the last `count` finished frames, oldest first.
+    // Returns how many were available.
+    int frameTimes(float *out, int count) const;
+
+    // Zones recorded in the last `frames` finished frames, by nesting depth and
+    // then in order of first appearance. Returns the number of zones written.
+    int zoneStats(int frames, ZoneStats *out, int maxZones) const;
+
+    // Write the events of the last `seconds` as Chrome trace_event JSON
+    // (load in chrome://tracing or ui.perfetto.dev)
+    bool writeChromeTrace(const char *path, double seconds) const;
+
+private:
+    std::atomic<bool> active;
+    int64_t epochNs;
+
+    std::vector<ProfileEvent> events;
+    std::atomic<uint64_t> eventCount;
+
+    std::vector<int64_t> frameStarts; // Ring of frame start times
+    uint64_t frameCount;              // Frames started so far
+};
+
+extern Profiler profiler;
+
+// Nesting depth of open zones on the current thread
+extern thread_local int profileDepth;
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *zoneName)
+        : name(zoneName), start(-1)
+    {
+        if (profiler.enabled())
+        {
+            start = profiler.now();
+            depth = profileDepth++;
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (start >= 0)
+        {
+            profileDepth--;
+            profiler.record(name, start, profiler.now(), depth);
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    int64_t start;
+    int depth = 0;
+};
+
+#if FLAPPY_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
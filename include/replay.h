@@ -0,0 +1,64 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "world.h"
+
+// Everything needed to re-simulate one game bit for bit: the world's seed,
+// mode, tick rate and collision settings, plus the ticks on which the player
+// jumped (the only input). On disk the jump ticks are stored as
+// variable-length deltas, so a ten-minute session is a few kilobytes.
+struct Replay
+{
+    uint64_t seed = 0;
+    GameMode mode = MODE_EASY;
+    int tickRate = BASE_TICK_RATE;
+    bool generatedLevels = false; // Played with a LevelFeed (level_generator.h)
+    bool sweptCollisions = false; // Played with world.sweptCollisions
+    int tickCount = 0;            // Ticks recorded
+    std::vector<int> jumpTicks;   // Ascending indices of ticks with input.jump set
+    uint64_t finalHash = 0;       // worldHash() after the last tick, 0 if not recorded
+};
+
+// Recording: call beginRecording right after resetWorld, recordInput with the
+// input of every step, and finishRecording once the game is over.
+void beginRecording(Replay &replay, const World &world);
+void recordInput(Replay &replay, const Input &input);
+void finishRecording(Replay &replay, const World &world);
+
+bool saveReplay(const Replay &replay, const char *path);
+bool loadReplay(Replay &replay, const char *path);
+
+// Feeds a replay's inputs back one tick at a time
+class ReplayPlayer
+{
+public:
+    // Reset the world to the replay's seed, mode, tick rate and collision
+    // settings and rewind.
+    // A replay with generated levels needs world.levelFeed set.
+    void start(World &world, const Replay &replay);
+
+    bool finished() const { return !source || tick >= source->tickCount; }
+    int ticksPlayed() const { return tick; }
+
+    // Input for the next tick (no jump once finished)
+    Input next();
+
+private:
+    const Replay *source = nullptr;
+    int tick = 0;
+    size_t nextJump = 0;
+};
+
+// Re-simulate a whole replay as fast as possible, without rendering (the same
+// level feed requirement as ReplayPlayer::start())
+void playReplay(World &world, const Replay &replay);
+
+// Hash of the simulation state (generators, ball, progress, entities) for
+// checking that a playback matched the recorded run
+uint64_t worldHash(const World &world);
+
+#endif // REPLAY_H
@@ -0,0 +1,52 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// PCG32 generator (permuted congruential, 64-bit state). Small enough to live
+// inside every World, so runs are reproducible from their seed and parallel
+// worlds never share a generator.
+class Rng
+{
+public:
+    explicit Rng(uint64_t seed = 0, uint64_t stream = 0) { reseed(seed, stream); }
+
+    // Different streams with the same seed give independent sequences
+    void reseed(uint64_t seed, uint64_t stream = 0)
+    {
+        state = 0;
+        increment = (stream << 1) | 1u;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+
+    // Uniform integer in [0, n), n > 0
+    int below(int n)
+    {
+        return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(n)) >> 32);
+    }
+
+    // Uniform float in [0, 1)
+    float unit()
+    {
+        return (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint64_t currentState() const { return state; }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+#endif // RNG_H
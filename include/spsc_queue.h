@@ -0,0 +1,52 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. push() and pop() never block or allocate; push() fails when the
+// queue is full. Capacity must be a power of two.
+template <typename T, unsigned Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T &item)
+    {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item)
+    {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+    T items[Capacity];
+
+    // Counters only ever increase (wrapping); kept on separate cache lines so
+    // the two threads do not contend
+    char padding0[64];
+    std::atomic<unsigned> head{0}; // Next item to pop, written by the consumer
+    char padding1[64];
+    std::atomic<unsigned> tail{0}; // Next slot to fill, written by the producer
+    char padding2[64];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,32 @@
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include "batch_renderer.h"
+
+// Batched geometry that rarely changes (menu text, screen overlays), compiled
+// once into a GL display list and replayed with a single call until its key
+// changes. The layer is in playfield coordinates, so window resizes do not
+// invalidate it. The list lives as long as the GL context.
+class StaticLayer
+{
+public:
+    StaticLayer() = default;
+    StaticLayer(const StaticLayer &) = delete;
+    StaticLayer &operator=(const StaticLayer &) = delete;
+
+    // Draw the layer. If it was never built, or was built for another key,
+    // `record` is called first to draw it into the renderer's batch.
+    // Anything already in the batch is flushed so the layer keeps its place
+    // in the draw order.
+    void draw(BatchRenderer &renderer, int key, void (*record)());
+
+    // Rebuild on the next draw (e.g. after the font atlas changed)
+    void invalidate() { built = false; }
+
+private:
+    unsigned int list = 0;
+    int builtKey = 0;
+    bool built = false;
+};
+
+#endif // STATIC_LAYER_H
@@ -0,0 +1,56 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Hands the latest value from exactly one producer thread to exactly one
+// consumer thread. The producer fills writeBuffer() and publish()es it; the
+// consumer calls update() and reads readBuffer(). Neither side ever blocks or
+// waits for the other: the three buffers change hands by swapping an index
+// through one atomic, so the producer never writes the buffer being read, and
+// a value published before the consumer took the previous one replaces it.
+// Buffers are reused, so copying into writeBuffer() keeps their allocations.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer side
+    T &writeBuffer() { return buffers[back]; }
+
+    void publish()
+    {
+        unsigned previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX;
+    }
+
+    // Consumer side: switch to the newest published value. Returns false (and
+    // keeps readBuffer()) when nothing was published since the last call.
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        unsigned previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX;
+        return true;
+    }
+
+    const T &readBuffer() const { return buffers[front]; }
+
+private:
+    static const unsigned INDEX = 3; // Buffer index bits of `middle`
+    static const unsigned FRESH = 4; // Set by publish(), cleared by update()
+
+    T buffers[3];
+
+    // The two sides' indices are on separate cache lines from the exchanged
+    // one; `back` is only touched by the producer, `front` by the consumer
+    char padding0[64];
+    unsigned back = 0;
+    char padding1[64];
+    std::atomic<unsigned> middle{1};
+    char padding2[64];
+    unsigned front = 2;
+    char padding3[64];
+};
+
+#endif // TRIPLE_BUFFER_H
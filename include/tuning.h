@@ -0,0 +1,24 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdio.h>
+#include <string>
+
+#include "world.h"
+
+// Tuning config files: one "key = value" per line, '#' starts a comment.
+// Keys are listed by writeTuning(); keys that are left out keep their
+// current value, e.g.
+//
+//   jump_power = -7.5
+//   hard.gap_height = 160   # Per-mode keys: easy., medium., hard., time_trial.
+
+// Update `tuning` from a file. All or nothing: on any error (unreadable
+// file, unknown key, bad or out-of-range value) `tuning` is left unchanged
+// and `error` says what and where.
+bool loadTuning(Tuning &tuning, const char *path, std::string &error);
+
+// Write every key with its value in `tuning`
+void writeTuning(const Tuning &tuning, FILE *out);
+
+#endif // TUNING_H
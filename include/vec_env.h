@@ -0,0 +1,127 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "rng.h"
+#include "world.h"
+
+// Observation layout, OBSERVATION_SIZE floats per game, roughly in [-1, 1].
+// "Pipe" is the first pipe the ball has not passed yet, "next pipe" the one
+// after it; a missing pipe reads as one a screen away with a centred gap.
+enum VecEnvObservation
+{
+    OBS_BALL_Y,               // ballY / WINDOW_HEIGHT
+    OBS_BALL_SPEED,           // ballSpeed / 10, positive while falling
+    OBS_PIPE_DX,              // (pipe right edge - BALL_X) / WINDOW_WIDTH
+    OBS_PIPE_GAP_BOTTOM,      // gapY / WINDOW_HEIGHT
+    OBS_PIPE_GAP_TOP,         // (gapY + current gap height) / WINDOW_HEIGHT
+    OBS_NEXT_PIPE_DX,         // Same as above for the next pipe
+    OBS_NEXT_PIPE_GAP_BOTTOM,
+    OBS_SHIELD,               // 1 while the shield is active
+    OBS_LIVES,                // lives / INITIAL_LIVES
+    OBSERVATION_SIZE
+};
+
+// Lock-step batch of independent games for training and evaluating automated
+// players. Plays by the same rules as step() and gives the same results bit
+// for bit (same seed, mode, tick rate, tuning and jumps), but keeps only the
+// gameplay state: no clouds, particles or events. The state is stored as
+// structure-of-arrays across games, so the per-tick work (timers,
+// difficulty, gravity, pipe and power-up movement) runs as SIMD loops over
+// all games; only spawns, pick-ups and collisions branch per game.
+//
+// Each game has pipeSlots() pipe slots: enough for every pipe that can be on
+// screen at the slowest pipe speed the settings allow (8 for the built-in
+// modes), or World's MAX_PIPES when the speed can drop without bound (a
+// negative speed increase). Like World, a spawn is skipped while they are
+// full, so the two stay in step either way.
+class VecEnv
+{
+public:
+    static const int POWER_UP_SLOTS = 8; // Never full: they move at a fixed speed
+
+    // `count` games in `mode` (not MODE_MENU), all stopped until reset()
+    VecEnv(int count, GameMode mode, int tickRate = BASE_TICK_RATE, const Tuning &tuning = DEFAULT_TUNING);
+
+    int size() const { return count; }
+    GameMode gameMode() const { return mode; }
+    int pipeSlots() const { return pipeSlotCount; }
+
+    // Start a new game in every environment, game i from seeds[i]
+    void reset(const uint64_t *seeds);
+
+    // Start a new game in one environment, as resetWorld() with world.seed = seed
+    void reset(int env, uint64_t seed);
+
+    // Advance every running game by one tick; actions[i] != 0 jumps. Fills
+    // (each optional) observations[size() * OBSERVATION_SIZE], rewards[size()]
+    // with the points scored minus the lives lost this tick, and dones[size()]
+    // with 1 for games that are over. Finished games stay as they are, with
+    // zero reward, until they are reset.
+    void step(const uint8_t *actions, float *observations, float *rewards, uint8_t *dones);
+
+    // Current observations without stepping
+    void observe(float *observations) const;
+
+    int score(int env) const { return scores[env]; }
+    int livesLeft(int env) const { return lives[env]; }
+    int ticks(int env) const { return tickCounts[env]; }
+    bool over(int env) const { return !playing[env]; }
+
+    // Copy a game into a World (for rendering or comparing with step());
+    // visual effects start empty
+    void copyToWorld(int env, World &world) const;
+
+private:
+    template <bool timeTrial>
+    void advance(const uint8_t *actions);
+    void moveEntities();
+    void resolve(int env);
+    void loseLife(int env);
+    void popPipe(int env);
+    void observe(int env, float *out) const;
+
+    int count;
+    GameMode mode;
+    int tickRate;
+    Tuning tuning;
+    DifficultySettings settings;
+    float frames; // Base-rate frames per tick
+    float dt;     // Seconds per tick
+    int pipeSlotCount;
+
+    // Per game, indexed by environment
+    std::vector<uint64_t> seeds;
+    std::vector<Rng> rngs;
+    std::vector<int32_t> playing; // 1 while PLAYING, 0 once over
+    std::vector<int32_t> scores;
+    std::vector<int32_t> lives;
+    std::vector<int32_t> tickCounts;
+    std::vector<int32_t> activePowerUps; // -1, SHIELD, SLOW_MOTION or DOUBLE_POINTS
+    std::vector<int32_t> lastDifficultyIncreases;
+    std::vector<float> ballY;
+    std::vector<float> ballSpeed;
+    std::vector<float> invincibilityTimers;
+    std::vector<float> powerUpTimers;
+    std::vector<float> spawnTimers;
+    std::vector<float> timeTrialTimers;
+    std::vector<float> pipeSpeeds;
+    std::vector<float> gapHeights;
+    std::vector<float> gravities;
+    std::vector<float> pipeSteps; // This tick's pipe movement, 0 for finished games
+    std::vector<int32_t> levels;   // score / difficultyInterval
+    std::vector<int32_t> onLevels; // 1 while the score is a positive multiple of it
+
+    // Entities, pipeSlots() / POWER_UP_SLOTS per game, oldest first
+    std::vector<int32_t> pipeCounts;
+    std::vector<float> pipeX;
+    std::vector<float> pipeGapY;
+    std::vector<int32_t> powerUpCounts;
+    std::vector<float> powerUpX;
+    std::vector<float> powerUpY;
+    std::vector<int32_t> powerUpTypes;
+};
+
+#endif // VEC_ENV_H
@@ -0,0 +1,91 @@
+#ifndef VERTEX_BATCH_H
+#define VERTEX_BATCH_H
+
+#include <vector>
+
+// Interleaved vertex as uploaded to GL (2D position, texture coordinate into
+// the glyph atlas, 8-bit RGBA color). Untextured shapes point at a solid
+// white texel, so text and shapes can share draw calls.
+struct Vertex
+{
+    float x, y;
+    float u, v;
+    unsigned char r, g, b, a;
+};
+
+// The only primitive types that reach the GPU; everything else is converted
+enum BatchPrimitive
+{
+    BATCH_TRIANGLES,
+    BATCH_LINES
+};
+
+// Shapes that can be recorded with begin()/vertex()/end(), mirroring the
+// immediate-mode glBegin() modes the game used to draw with
+enum ShapeMode
+{
+    SHAPE_POLYGON,        // Convex polygon (triangle fan)
+    SHAPE_TRIANGLE_STRIP,
+    SHAPE_QUADS,
+    SHAPE_LINE_STRIP
+};
+
+// A run of consecutive vertices drawn with one glDrawArrays call
+struct DrawCommand
+{
+    BatchPrimitive primitive;
+    int first;
+    int count;
+};
+
+// Collects a frame's geometry into one vertex array. Consecutive shapes that
+// reduce to the same primitive type are merged into a single draw command.
+// Has no GL dependency; submission is done by the renderer.
+class VertexBatch
+{
+public:
+    void clear();
+
+    // Current color, applied to subsequent vertices (like glColor4f)
+    void color(float r, float g, float b, float a = 1.0f);
+    const Vertex &currentColor() const { return current; }
+
+    void begin(ShapeMode mode);
+    void vertex(float x, float y);
+    void end();
+
+    // Axis-aligned filled rectangle in the current color
+    void rect(float x, float y, float w, float h);
+
+    // Texture coordinate given to vertex() (the atlas' solid white texel)
+    void setSolidTexCoord(float u, float v);
+
+    // Pre-built triangles (e.g. laid-out text) offset by (dx, dy), keeping
+    // their texture coordinates and taking the current color
+    void triangles(const Vertex *source, int count, float dx, float dy);
+
+    // Filled circle, tessellated according to its radius
+    void circle(float x, float y, float radius);
+
+    // Ring between two radii swept counter-clockwise from angle 0 over
+    // `fraction` of a full turn (1 draws the closed ring)
+    void ringArc(float x, float y, float innerRadius, float outerRadius, float fraction);
+
+    const std::vector<Vertex> &vertices() const { return verts; }
+    const std::vector<DrawCommand> &commands() const { return cmds; }
+    bool empty() const { return verts.empty(); }
+
+private:
+    void emit(const Vertex &v);
+    void emitPrimitive(BatchPrimitive primitive);
+
+    std::vector<Vertex> verts;
+    std::vector<DrawCommand> cmds;
+
+    Vertex current = {0.0f, 0.0f, 0.0f, 0.0f, 255, 255, 255, 255};
+    ShapeMode mode = SHAPE_POLYGON;
+    int shapeVertexCount = 0;
+    Vertex first = {}, previous = {}, beforePrevious = {};
+};
+
+#endif // VERTEX_BATCH_H
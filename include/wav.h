@@ -0,0 +1,39 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stddef.h>
+#include <vector>
+
+// RIFF/WAVE header up to the end of the "fmt " chunk. A 16-bit PCM file is
+// this header, then the "data" chunk id, its byte size and the samples. The
+// fields are written as-is, so the files are only portable from
+// little-endian hosts.
+struct WAVHeader
+{
+    char riff[4];
+    unsigned int overallSize;
+    char wave[4];
+    char fmt[4];
+    unsigned int fmtSize;
+    unsigned short format;
+    unsigned short channels;
+    unsigned int sampleRate;
+    unsigned int byteRate;
+    unsigned short blockAlign;
+    unsigned short bitsPerSample;
+};
+
+// Interleaved 16-bit PCM
+struct WavData
+{
+    int channels = 0;
+    int sampleRate = 0;
+    std::vector<short> samples; // frames * channels
+};
+
+bool saveWav(const char *path, const short *samples, size_t frames, int channels, int sampleRate);
+
+// Reads 16-bit PCM files, skipping any chunks other than "fmt " and "data"
+bool loadWav(WavData &wav, const char *path);
+
+#endif // WAV_H
@@ -0,0 +1,58 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index ranges. Each worker owns a deque
+// of ranges and works through its own share; idle workers steal half of the
+// oldest range from another worker, so uneven task lengths (short and long
+// games) still keep every core busy.
+class WorkStealingPool
+{
+public:
+    // threadCount <= 0 uses one thread per hardware core
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    int threadCount() const { return static_cast<int>(threads.size()); }
+
+    // Call task(index, worker) for every index in [0, count) and wait until
+    // all calls returned. Indices are handed out `grain` at a time.
+    void parallelFor(int count, const std::function<void(int, int)> &task, int grain = 1);
+
+private:
+    struct Range
+    {
+        int begin, end;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    void workerLoop(int worker);
+    bool popLocal(int worker, Range &range);
+    bool steal(int worker, Range &range);
+
+    std::vector<std::thread> threads;
+    std::vector<WorkerQueue> queues;
+
+    std::mutex jobMutex;
+    std::condition_variable jobStarted;
+    std::condition_variable jobFinished;
+    unsigned long jobGeneration = 0;
+    bool stopping = false;
+
+    const std::function<void(int, int)> *job = nullptr;
+    int jobGrain = 1;
+    int activeWorkers = 0;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,328 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <vector>
+
+#include "ecs.h"
+#include "particle_pool.h"
+#include "pipe_queue.h"
+#include "rng.h"
+
+// Constants
+const float PI = 3.14159265f;
+
+// Playfield constants (the simulation uses window coordinates, origin bottom-left)
+const int WINDOW_WIDTH = 800, WINDOW_HEIGHT = 600;
+const int PIPE_WIDTH = 80;
+const int MAX_PIPES = 64; // Pipes alive at once; spawns are skipped while full
+const int GAP_HEIGHT = 200;
+const float GRAVITY = 0.4f;
+constexpr float POWER = -8.0f; // Tunable, see Tuning
+const float PIPE_SPEED = 3.0f;
+const float BALL_X = 100.0f; // The ball never moves horizontally
+const float ballRadius = 20.0f;
+
+// Difficulty scaling defaults (used when no mode is selected)
+const float SPEED_INCREASE = 0.2f;        // Speed increase per 5 points
+const float GAP_DECREASE = 5.0f;          // Gap decrease per 5 points
+const float GRAVITY_INCREASE = 0.02f;     // Gravity increase per 5 points
+constexpr int DIFFICULTY_INTERVAL = 5;    // Points needed for difficulty increase
+constexpr float MIN_GAP_HEIGHT = 100.0f;  // Minimum gap height
+
+// Time Trial: every 30 seconds the difficulty grows by a fraction of the
+// mode's per-level increments
+constexpr int TIME_TRIAL_INTERVAL = 30;
+constexpr float TIME_TRIAL_SPEED_SCALE = 0.5f;
+constexpr float TIME_TRIAL_GRAVITY_SCALE = 0.3f;
+constexpr float TIME_TRIAL_GAP_SCALE = 0.7f;
+
+// Power-up constants
+const int SHIELD = 0;
+const int SLOW_MOTION = 1;
+const int DOUBLE_POINTS = 2;
+const float POWER_UP_RADIUS = 15.0f;
+constexpr int POWER_UP_DURATION = 300; // Duration in frames (5 seconds at 60 FPS)
+const float POWER_UP_SPEED = 2.0f;
+const int INVINCIBILITY_DURATION = 120; // 2 seconds of invincibility after losing a life
+
+// Visual enhancement constants
+const int MAX_CLOUDS = 5;
+const int MAX_PARTICLES = 200; // Increased for more particles
+const float CLOUD_MIN_SPEED = 0.5f;
+const float CLOUD_MAX_SPEED = 1.5f;
+const float PARTICLE_LIFE = 60.0f; // frames
+const float PARTICLE_SPEED = 5.0f;
+const float EXPLOSION_SPEED = 8.0f;      // Speed for explosion particles
+const int EXPLOSION_PARTICLE_COUNT = 20; // Number of particles in explosion
+const int SCORE_PARTICLE_COUNT = 10;     // Number of particles for scoring
+
+const int INITIAL_LIVES = 3; // Number of lives at game start
+
+// All tuning values above are expressed per frame at this rate. Worlds may be
+// stepped at other rates; step() scales every per-frame quantity accordingly.
+const int BASE_TICK_RATE = 60;
+
+enum GameState
+{
+    MENU,
+    PLAYING,
+    PAUSED,
+    GAME_OVER
+};
+
+// Game mode enum
+enum GameMode
+{
+    MODE_MENU,
+    MODE_EASY,
+    MODE_MEDIUM,
+    MODE_HARD,
+    MODE_TIME_TRIAL
+};
+
+// Difficulty settings for each mode
+struct DifficultySettings
+{
+    float pipeSpeed;
+    float gapHeight;
+    float gravity;
+    int spawnInterval;
+    float speedIncrease;
+    float gapDecrease;
+    float gravityIncrease;
+};
+
+// Indexed by mode - 1 (MODE_MENU has no entry)
+constexpr DifficultySettings modes[4] = {
+    {2.0f, 250.0f, 0.3f, 120, 0.1f, 3.0f, 0.01f}, // Easy
+    {3.0f, 200.0f, 0.4f, 100, 0.2f, 5.0f, 0.02f}, // Medium
+    {4.0f, 150.0f, 0.5f, 80, 0.3f, 7.0f, 0.03f},  // Hard
+    {3.0f, 200.0f, 0.4f, 100, 0.2f, 5.0f, 0.02f}  // Time Trial (starts at medium)
+};
+
+// Gameplay values that can be changed without a rebuild (loaded from a config
+// file, see tuning.h). Each world holds a copy, so step() reads plain fields.
+struct Tuning
+{
+    DifficultySettings modes[4]; // Indexed by mode - 1
+    float jumpPower;             // Ball speed set by a jump (negative is up)
+    int powerUpDuration;         // Frames
+    float minGapHeight;
+    int difficultyInterval; // Points per difficulty level
+    int timeTrialInterval;  // Seconds per Time Trial difficulty step
+    float timeTrialSpeedScale;
+    float timeTrialGravityScale;
+    float timeTrialGapScale;
+};
+
+// The compiled-in values above
+constexpr Tuning DEFAULT_TUNING = {
+    {modes[0], modes[1], modes[2], modes[3]},
+    POWER,
+    POWER_UP_DURATION,
+    MIN_GAP_HEIGHT,
+    DIFFICULTY_INTERVAL,
+    TIME_TRIAL_INTERVAL,
+    TIME_TRIAL_SPEED_SCALE,
+    TIME_TRIAL_GRAVITY_SCALE,
+    TIME_TRIAL_GAP_SCALE};
+
+// Structs
+// Pipes live in a PipeQueue (pipe_queue.h) and particles in a ParticlePool
+// (particle_pool.h); power-ups and clouds are rows of EntityTables (ecs.h)
+// made of the components below.
+
+// Horizontal motion of anything that scrolls; prevX holds the position before
+// the last step, for render interpolation
+struct Scroll
+{
+    float x;
+    float prevX;
+    float speed; // Pixels per frame, leftwards
+};
+
+struct PowerUpBody
+{
+    float y;
+    int type; // 0: Shield, 1: Slow Motion, 2: Double Points
+};
+
+struct CloudBody
+{
+    float y;
+    float scale;
+};
+
+typedef EntityTable<Scroll, PowerUpBody> PowerUpTable;
+typedef EntityTable<Scroll, CloudBody> CloudTable;
+
+// One generated spawn (see level_generator.h): a pipe and maybe a power-up
+struct SpawnEntry
+{
+    float gapY;      // For the gap height it was generated for, see spawnGapY()
+    int powerUpType; // -1 for none
+    float powerUpY;
+};
+
+class LevelFeed;
+
+
+// Things that happened during a step, so the front-end can react (sounds etc.)
+enum WorldEvent
+{
+    EVENT_JUMP = 1 << 0,
+    EVENT_SCORE = 1 << 1,
+    EVENT_POWERUP = 1 << 2,
+    EVENT_LIFE_LOST = 1 << 3,
+    EVENT_GAME_OVER = 1 << 4,
+    EVENT_DIFFICULTY_UP = 1 << 5 // Time Trial difficulty step
+};
+
+// Player input sampled for a single tick
+struct Input
+{
+    bool jump;
+};
+
+// Complete simulation state of one game. Contains no GL/GLUT/OpenAL handles,
+// so any number of worlds can be stepped independently.
+struct World
+{
+    GameState state;
+    GameMode mode;
+    DifficultySettings settings;     // Base settings the current difficulty grows from
+    Tuning tuning = DEFAULT_TUNING;  // Kept across resets; change with applyTuning()
+
+    int tickRate = BASE_TICK_RATE; // Steps per second, kept across resets
+    uint64_t seed = 0;             // Seeds both generators on reset, kept across resets
+
+    Rng rng;   // Gameplay randomness (pipe gaps, power-ups)
+    Rng fxRng; // Visual-only randomness (clouds, particles)
+
+    // Ball state
+    float ballY;
+    float ballSpeed;
+    float prevBallY;
+
+    // Game progress
+    int score;
+    int lives;
+    float invincibilityTimer; // Frames of invincibility left after losing a life
+    int tickCount;            // Steps taken since the game started
+    float spawnTimer;         // Frames since the last pipe spawn
+
+    // Power-up state
+    bool hasShield;
+    bool hasSlowMotion;
+    bool hasDoublePoints;
+    float powerUpTimer; // Frames left on the active power-up
+    int activePowerUp;
+
+    // Current difficulty
+    float currentPipeSpeed;
+    float currentGapHeight;
+    float currentGravity;
+    int currentSpawnInterval;
+
+    // Time Trial progress
+    float timeTrialTimer;
+    int lastDifficultyIncrease;
+
+    // Generated levels: when set, pipes and power-ups come from this feed
+    // (restarted from the seed by resetWorld()) every currentSpawnInterval
+    // frames instead of being drawn at random every 100 frames. Not owned,
+    // kept across resets; nextSpawn is the entry the next spawn uses.
+    LevelFeed *levelFeed = nullptr;
+    SpawnEntry nextSpawn;
+
+    // Test collisions along each step's motion (sweepBallPipe() and
+    // sweepBallPowerUp()) instead of at its end, so large steps and high pipe
+    // speeds cannot jump over a pipe lip or a power-up. Kept across resets.
+    bool sweptCollisions = false;
+
+    PipeQueue pipes = PipeQueue(MAX_PIPES); // Sorted by x, leftmost first
+    PowerUpTable powerUps;
+    CloudTable clouds;
+    ParticlePool particles = ParticlePool(MAX_PARTICLES);
+
+    unsigned int events; // WorldEvent bits raised by the last step
+};
+
+// Start a new game in the given mode using the world's difficulty table
+// (world.tuning.modes).
+// MODE_MENU leaves the world in the MENU state, every other mode in PLAYING.
+// Both generators restart from world.seed, so the same seed, mode, tick rate
+// and inputs always replay the same game.
+void resetWorld(World &world, GameMode mode);
+
+// Same as above but with explicit difficulty settings (used for tuning sweeps)
+void resetWorld(World &world, GameMode mode, const DifficultySettings &settings);
+
+// Replace the world's tuning between steps. A game in progress continues
+// with the new values: its difficulty is recomputed for the level reached,
+// and with generated levels the spawns not yet made are generated again.
+void applyTuning(World &world, const Tuning &tuning);
+
+// Advance the world by one tick (1 / world.tickRate seconds). Does nothing
+// unless the world is PLAYING.
+void step(World &world, const Input &input);
+
+// Blend a value between its state before and after the last step
+inline float interpolate(float previous, float current, float alpha)
+{
+    return previous + (current - previous) * alpha;
+}
+
+// Bottom of a generated gap, kept on screen when the gap is taller than the
+// one the entry was generated for
+inline float spawnGapY(const SpawnEntry &entry, float gapHeight)
+{
+    float highest = WINDOW_HEIGHT - 50 - gapHeight;
+    return entry.gapY < highest ? entry.gapY : highest;
+}
+
+// Narrow-phase collision tests used by step()
+inline bool ballHitsPipe(float ballY, const Pipe &pipe, float gapHeight)
+{
+    // Horizontal overlap, then outside the gap vertically
+    if (BALL_X + ballRadius <= pipe.x || BALL_X - ballRadius >= pipe.x + PIPE_WIDTH)
+        return false;
+    return ballY - ballRadius < pipe.gapY || ballY + ballRadius > pipe.gapY + gapHeight;
+}
+
+inline bool ballTouchesPowerUp(float ballY, float powerUpX, float powerUpY)
+{
+    float dx = BALL_X - powerUpX;
+    float dy = ballY - powerUpY;
+    float reach = ballRadius + POWER_UP_RADIUS;
+    return dx * dx + dy * dy < reach * reach;
+}
+
+// Swept tests for one step: the ball moves from prevBallY to ballY and the
+// pipe or power-up (at height powerUpY) from prevX to x, both at constant
+// speed. Return the
+// fraction of the step (0..1) at which they first touch, or -1 if they do not.
+// A hit at the end of the step always counts, so these never miss what the
+// tests above report.
+float sweepBallPipe(float prevBallY, float ballY, const Pipe &pipe, float gapHeight);
+float sweepBallPowerUp(float prevBallY, float ballY, const Scroll &powerUp, float powerUpY);
+
+// Movement system: every entity of the table scrolls left by its speed
+template <typename Table>
+void scrollEntities(Table &table, float frames)
+{
+    Scroll *scroll = table.template column<Scroll>();
+    for (int i = 0, n = table.size(); i < n; i++)
+    {
+        scroll[i].prevX = scroll[i].x;
+        scroll[i].x -= scroll[i].speed * frames;
+    }
+}
+
+// Visual effects, also used by the front-end for menu decoration
+void initClouds(World &world);
+void addParticles(World &world, float x, float y, float r, float g, float b);
+void createExplosionEffect(World &world, float x, float y, float r, float g, float b);
+void createScoreEffect(World &world, float x, float y);
+
+#endif // WORLD_H
@@ -0,0 +1,42 @@
+#ifndef WORLD_SCENE_H
+#define WORLD_SCENE_H
+
+#include "vertex_batch.h"
+#include "world.h"
+
+// Records the playfield of a world (background, clouds, particles, ball,
+// shield, pipes, power-ups) into a vertex batch. GL-free, so the same code
+// feeds the game and the benchmarks; text and overlays stay in the game.
+
+// Animation phases (radians) of the shield and power-up effects. They follow
+// game time, not the number of frames drawn, so they run at the same speed at
+// any frame rate and a replay always animates the same way.
+struct SceneAnimation
+{
+    float shieldTime = 0.0f;
+    float powerUpTime = 0.0f;
+};
+
+// Phases `seconds` into a game
+SceneAnimation sceneAnimationAt(double seconds);
+
+void drawBackground(VertexBatch &batch);
+void drawCloud(VertexBatch &batch, float x, float y, float scale);
+void drawParticles(VertexBatch &batch, const ParticlePool &particles, float alpha);
+void drawBall(VertexBatch &batch, float x, float y, float radius, float invincibilityTimer);
+void drawShield(VertexBatch &batch, float x, float y, const SceneAnimation &animation);
+void drawPowerUp(VertexBatch &batch, float x, float y, int type, const SceneAnimation &animation);
+
+// Ring, progress arc and icon of an active power-up timer (without the text)
+const float POWER_UP_TIMER_INNER_RADIUS = 20.0f;
+const float POWER_UP_TIMER_OUTER_RADIUS = 25.0f;
+void drawPowerUpTimerRing(VertexBatch &batch, float x, float y, float progress, int type);
+
+// Everything above for the world's current state, with moving objects blended
+// `alpha` of the way from their previous to their current tick position.
+// The ball, pipes and power-ups are only drawn while PLAYING or PAUSED, and
+// animated at the same blended point of the world's game time.
+// Without `background` the sky is left to the caller (e.g. a loaded texture).
+void drawWorldScene(VertexBatch &batch, const World &world, float alpha, bool background = true);
+
+#endif // WORLD_SCENE_H
@@ -0,0 +1,90 @@
+#include "asset_loader.h"
+
+#include <chrono>
+#include <utility>
+
+struct AssetJob
+{
+    AssetKind kind;
+    int id;
+    const char *file; // Relative to the asset root
+};
+
+static const AssetJob assetJobs[] = {
+    {ASSET_SOUND, SOUND_JUMP, "sfx/jump.wav"},
+    {ASSET_SOUND, SOUND_SCORE, "sfx/score.wav"},
+    {ASSET_SOUND, SOUND_POWERUP, "sfx/powerup.wav"},
+    {ASSET_SOUND, SOUND_GAME_OVER, "sfx/game_over.wav"},
+    {ASSET_TEXTURE, TEXTURE_BACKGROUND, "textures/background.tga"}};
+
+int AssetLoader::jobCount()
+{
+    return static_cast<int>(sizeof(assetJobs) / sizeof(assetJobs[0]));
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Workers stop by themselves once the job list is exhausted
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void AssetLoader::start(const char *assetRoot, int threadCount)
+{
+    if (started)
+        return;
+    started = true;
+    root = assetRoot;
+    for (int i = 0; i < threadCount && i < jobCount(); i++)
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+}
+
+bool AssetLoader::poll(LoadedAsset &asset)
+{
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (done.empty())
+        return false;
+    asset = std::move(done.front());
+    done.pop_front();
+    delivered++;
+    return true;
+}
+
+void AssetLoader::workerLoop()
+{
+    for (int job = nextJob++; job < jobCount(); job = nextJob++)
+    {
+        LoadedAsset asset;
+        auto start = std::chrono::steady_clock::now();
+        decode(job, asset);
+        asset.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.push_back(std::move(asset));
+    }
+}
+
+void AssetLoader::decode(int job, LoadedAsset &asset) const
+{
+    const AssetJob &entry = assetJobs[job];
+    asset.kind = entry.kind;
+    asset.id = entry.id;
+    asset.path = root + "/" + entry.file;
+
+    if (entry.kind == ASSET_TEXTURE)
+    {
+        asset.fromFile = loadTga(asset.image, asset.path.c_str());
+        if (!asset.fromFile)
+            asset.image = Image();
+        return;
+    }
+
+    asset.fromFile = loadWav(asset.sound, asset.path.c_str()) &&
+                     (asset.sound.channels == 1 || asset.sound.channels == 2) && !asset.sound.samples.empty();
+    if (!asset.fromFile)
+    {
+        asset.sound.channels = 1;
+        asset.sound.sampleRate = AudioEngine::SAMPLE_RATE;
+        AudioEngine::generateSound(static_cast<SoundId>(entry.id), asset.sound.samples);
+    }
+}
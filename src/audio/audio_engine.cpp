@@ -0,0 +1,266 @@
+#include "audio_engine.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Built-in beeps, used when a sound has no file. When every voice is busy, a sound
+// may only cut off one of equal or lower priority.
+struct SoundDefinition
+{
+    float frequency;
+    float duration; // Seconds
+    int priority;
+};
+
+static const SoundDefinition soundDefinitions[SOUND_COUNT] = {
+    {880.0f, 0.1f, 0},  // Jump: high pitch, the most frequent, cut first
+    {1000.0f, 0.1f, 1}, // Score: higher pitch
+    {660.0f, 0.2f, 2},  // Power-up: medium pitch
+    {440.0f, 0.5f, 3}   // Life lost / game over: low pitch
+};
+
+bool AudioEngine::init()
+{
+    device = alcOpenDevice(nullptr);
+    if (!device || !createContext(nullptr))
+        return false;
+
+    running = true;
+    mixer = std::thread(&AudioEngine::mixerLoop, this);
+    return true;
+}
+
+bool AudioEngine::initLoopback(int sampleRate)
+{
+    if (!alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback"))
+        return false;
+    auto openLoopback = reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(
+        alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+    auto formatSupported = reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(
+        alcGetProcAddress(nullptr, "alcIsRenderFormatSupportedSOFT"));
+    renderSamples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(
+        alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+    if (!openLoopback || !formatSupported || !renderSamples)
+        return false;
+
+    device = openLoopback(nullptr);
+    if (!device)
+        return false;
+    if (!formatSupported(device, sampleRate, ALC_STEREO_SOFT, ALC_SHORT_SOFT))
+    {
+        alcCloseDevice(device);
+        device = nullptr;
+        return false;
+    }
+
+    const ALCint attributes[] = {
+        ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+        ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+        ALC_FREQUENCY, sampleRate,
+        0};
+    return createContext(attributes);
+}
+
+bool AudioEngine::createContext(const ALCint *attributes)
+{
+    context = alcCreateContext(device, attributes);
+    if (!context)
+    {
+        alcCloseDevice(device);
+        device = nullptr;
+        return false;
+    }
+    alcMakeContextCurrent(context);
+
+    createVoicesAndBuffers();
+    return true;
+}
+
+void AudioEngine::createVoicesAndBuffers()
+{
+    alGenBuffers(SOUND_COUNT, buffers);
+    for (Voice &voice : voices)
+    {
+        alGenSources(1, &voice.source);
+        voice.sound = -1;
+        voice.start = 0;
+    }
+}
+
+bool AudioEngine::setSound(SoundId sound, const short *samples, size_t frames, int channels, int sampleRate)
+{
+    if (!active() || soundSet[sound] || (channels != 1 && channels != 2) || frames == 0 || sampleRate <= 0)
+        return false;
+
+    alGetError();
+    alBufferData(buffers[sound], channels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16, samples,
+                 static_cast<ALsizei>(frames * channels * sizeof(short)), sampleRate);
+    if (alGetError() != AL_NO_ERROR)
+        return false;
+
+    // Published last: play() only queues sounds whose buffer is filled
+    soundSet[sound] = true;
+    return true;
+}
+
+void AudioEngine::generateSound(SoundId sound, std::vector<short> &samples)
+{
+    const SoundDefinition &definition = soundDefinitions[sound];
+    samples.resize(static_cast<size_t>(definition.duration * SAMPLE_RATE));
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        float t = static_cast<float>(i) / SAMPLE_RATE;
+        samples[i] = static_cast<short>(32767 * std::sin(2.0f * 3.14159265f * definition.frequency * t));
+    }
+}
+
+void AudioEngine::generateSounds()
+{
+    std::vector<short> samples;
+    for (int s = 0; s < SOUND_COUNT; s++)
+    {
+        if (soundSet[s])
+            continue;
+        generateSound(static_cast<SoundId>(s), samples);
+        setSound(static_cast<SoundId>(s), samples.data(), samples.size(), 1, SAMPLE_RATE);
+    }
+}
+
+void AudioEngine::shutdown()
+{
+    if (mixer.joinable())
+    {
+        running = false;
+        wake.notify_all();
+        mixer.join();
+    }
+
+    if (!context)
+        return;
+
+    for (Voice &voice : voices)
+    {
+        alSourceStop(voice.source);
+        alSourcei(voice.source, AL_BUFFER, 0);
+        alDeleteSources(1, &voice.source);
+    }
+    alDeleteBuffers(SOUND_COUNT, buffers);
+    for (std::atomic<bool> &set : soundSet)
+        set = false;
+
+    alcMakeContextCurrent(nullptr);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+    context = nullptr;
+    device = nullptr;
+    renderSamples = nullptr;
+}
+
+void AudioEngine::play(SoundId sound)
+{
+    if (!active() || !soundSet[sound])
+        return;
+    if (!requests.push(static_cast<uint8_t>(sound)))
+    {
+        dropped++;
+        return;
+    }
+    wake.notify_one();
+}
+
+void AudioEngine::playEvents(unsigned int events)
+{
+    if (events & EVENT_JUMP)
+        play(SOUND_JUMP);
+    if (events & EVENT_POWERUP)
+        play(SOUND_POWERUP);
+    if (events & EVENT_SCORE)
+        play(SOUND_SCORE);
+    if (events & (EVENT_LIFE_LOST | EVENT_GAME_OVER))
+        play(SOUND_GAME_OVER);
+}
+
+void AudioEngine::update()
+{
+    uint8_t sound;
+    while (requests.pop(sound))
+        startSound(sound);
+}
+
+void AudioEngine::render(short *out, int frames)
+{
+    if (renderSamples)
+        renderSamples(device, out, frames);
+}
+
+void AudioEngine::startSound(int sound)
+{
+    requestCount++;
+    int priority = soundDefinitions[sound].priority;
+
+    // A finished voice if there is one, otherwise the least important busy
+    // one (the oldest among equals)
+    Voice *chosen = nullptr;
+    bool busy = true;
+    for (Voice &voice : voices)
+    {
+        ALint state;
+        alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+        if (state != AL_PLAYING)
+        {
+            chosen = &voice;
+            busy = false;
+            break;
+        }
+        if (!chosen)
+        {
+            chosen = &voice;
+            continue;
+        }
+        int voicePriority = soundDefinitions[voice.sound].priority;
+        int chosenPriority = soundDefinitions[chosen->sound].priority;
+        if (voicePriority < chosenPriority || (voicePriority == chosenPriority && voice.start < chosen->start))
+            chosen = &voice;
+    }
+
+    if (busy)
+    {
+        if (soundDefinitions[chosen->sound].priority > priority)
+        {
+            dropped++;
+            return;
+        }
+        alSourceStop(chosen->source);
+        stolen++;
+    }
+
+    alSourcei(chosen->source, AL_BUFFER, static_cast<ALint>(buffers[sound]));
+    alSourcePlay(chosen->source);
+    chosen->sound = sound;
+    chosen->start = requestCount;
+    played++;
+}
+
+void AudioEngine::mixerLoop()
+{
+    while (running)
+    {
+        update();
+
+        // play() notifies without taking the lock, so a wake-up can slip in
+        // between the check and the wait; the timeout bounds that delay
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, std::chrono::milliseconds(5),
+                      [this] { return !running || !requests.empty(); });
+    }
+}
+
+AudioStats AudioEngine::stats() const
+{
+    AudioStats result;
+    result.played = played;
+    result.stolen = stolen;
+    result.dropped = dropped;
+    return result;
+}
@@ -0,0 +1,73 @@
+#include "wav.h"
+
+#include <cstring>
+#include <stdio.h>
+
+bool saveWav(const char *path, const short *samples, size_t frames, int channels, int sampleRate)
+{
+    unsigned int dataSize = static_cast<unsigned int>(frames * channels * sizeof(short));
+
+    WAVHeader header;
+    memcpy(header.riff, "RIFF", 4);
+    // Everything after the size field: the rest of this header, the data
+    // chunk's id and size, and the samples
+    header.overallSize = static_cast<unsigned int>(sizeof(WAVHeader) + dataSize);
+    memcpy(header.wave, "WAVE", 4);
+    memcpy(header.fmt, "fmt ", 4);
+    header.fmtSize = 16;
+    header.format = 1; // PCM
+    header.channels = static_cast<unsigned short>(channels);
+    header.sampleRate = static_cast<unsigned int>(sampleRate);
+    header.byteRate = static_cast<unsigned int>(sampleRate * channels * sizeof(short));
+    header.blockAlign = static_cast<unsigned short>(channels * sizeof(short));
+    header.bitsPerSample = 16;
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite("data", 4, 1, file) == 1 &&
+              fwrite(&dataSize, sizeof(dataSize), 1, file) == 1 &&
+              (dataSize == 0 || fwrite(samples, dataSize, 1, file) == 1);
+    return fclose(file) == 0 && ok;
+}
+
+bool loadWav(WavData &wav, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    // The "fmt " chunk may be longer than 16 bytes; only the start is used
+    WAVHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.riff, "RIFF", 4) == 0 && memcmp(header.wave, "WAVE", 4) == 0 &&
+              memcmp(header.fmt, "fmt ", 4) == 0 && header.fmtSize >= 16 &&
+              header.format == 1 && header.bitsPerSample == 16 && header.channels > 0 &&
+              fseek(file, static_cast<long>(header.fmtSize - 16), SEEK_CUR) == 0;
+
+    while (ok)
+    {
+        char id[4];
+        unsigned int size;
+        if (fread(id, 4, 1, file) != 1 || fread(&size, sizeof(size), 1, file) != 1)
+        {
+            ok = false;
+            break;
+        }
+        if (memcmp(id, "data", 4) == 0)
+        {
+            wav.channels = header.channels;
+            wav.sampleRate = static_cast<int>(header.sampleRate);
+            wav.samples.resize(size / sizeof(short));
+            ok = wav.samples.empty() ||
+                 fread(wav.samples.data(), wav.samples.size() * sizeof(short), 1, file) == 1;
+            break;
+        }
+        // Chunks are padded to an even size
+        ok = fseek(file, static_cast<long>(size + (size & 1)), SEEK_CUR) == 0;
+    }
+
+    fclose(file);
+    return ok;
+}
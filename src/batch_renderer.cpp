@@ -0,0 +1,72 @@
+#include "batch_renderer.h"
+#include "profiler.h"
+
+#include <GL/freeglut.h>
+
+void BatchRenderer::beginFrame()
+{
+    stats.vertices = 0;
+    stats.drawCalls = 0;
+}
+
+void BatchRenderer::flush()
+{
+    PROFILE_ZONE("flushBatch");
+
+    if (geometry.empty())
+        return;
+
+    const std::vector<Vertex> &verts = geometry.vertices();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &verts[0].x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &verts[0].r);
+    if (atlasTexture)
+    {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &verts[0].u);
+    }
+
+    for (const DrawCommand &cmd : geometry.commands())
+    {
+        glDrawArrays(cmd.primitive == BATCH_LINES ? GL_LINES : GL_TRIANGLES, cmd.first, cmd.count);
+        stats.drawCalls++;
+    }
+
+    if (atlasTexture)
+    {
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisable(GL_TEXTURE_2D);
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    stats.vertices += static_cast<int>(verts.size());
+    geometry.clear();
+}
+
+void BatchRenderer::drawImage(unsigned int texture, float x, float y, float w, float h)
+{
+    flush();
+
+    const float corners[8] = {x, y, x + w, y, x + w, y + h, x, y + h};
+    const float texCoords[8] = {0, 0, 1, 0, 1, 1, 0, 1};
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, corners);
+    glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+    glDrawArrays(GL_QUADS, 0, 4);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+
+    stats.vertices += 4;
+    stats.drawCalls++;
+}
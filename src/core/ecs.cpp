@@ -0,0 +1,47 @@
+#include "ecs.h"
+#include "profiler.h"
+#include "work_stealing_pool.h"
+
+void SystemSchedule::add(const char *name, unsigned reads, unsigned writes, std::function<void()> run)
+{
+    int index = static_cast<int>(systems.size());
+    systems.push_back(System{name, reads, writes, std::move(run)});
+
+    // After the last stage with a conflicting system
+    int stage = 0;
+    for (int s = static_cast<int>(stages.size()) - 1; s >= 0 && stage == 0; s--)
+    {
+        for (int other : stages[s])
+        {
+            const System &o = systems[other];
+            if ((writes & (o.reads | o.writes)) || (o.writes & reads))
+            {
+                stage = s + 1;
+                break;
+            }
+        }
+    }
+    if (stage == static_cast<int>(stages.size()))
+        stages.emplace_back();
+    stages[stage].push_back(index);
+}
+
+void SystemSchedule::runSystem(const System &system)
+{
+    PROFILE_ZONE(system.name);
+    system.run();
+}
+
+void SystemSchedule::run(WorkStealingPool *pool)
+{
+    for (const auto &stage : stages)
+    {
+        if (!pool || stage.size() == 1)
+        {
+            for (int index : stage)
+                runSystem(systems[index]);
+            continue;
+        }
+        pool->parallelFor(static_cast<int>(stage.size()), [this, &stage](int i, int) { runSystem(systems[stage[i]]); });
+    }
+}
@@ -0,0 +1,49 @@
+#include "fixed_timestep.h"
+
+#include <algorithm>
+
+// Longest frame we try to catch up on; anything beyond is dropped
+static const double MAX_FRAME_SECONDS = 0.25;
+
+FixedTimestep::FixedTimestep(int tickRate)
+{
+    setTickRate(tickRate);
+    reset();
+}
+
+void FixedTimestep::setTickRate(int tickRate)
+{
+    rate = tickRate;
+    tickLength = 1.0 / tickRate;
+}
+
+void FixedTimestep::reset()
+{
+    accumulator = 0.0;
+    lastTime = Clock::now();
+}
+
+int FixedTimestep::advance()
+{
+    Clock::time_point now = Clock::now();
+    double frameSeconds = std::chrono::duration<double>(now - lastTime).count();
+    lastTime = now;
+
+    if (frameSeconds > MAX_FRAME_SECONDS)
+        frameSeconds = MAX_FRAME_SECONDS;
+
+    accumulator += frameSeconds;
+    int ticks = 0;
+    while (accumulator >= tickLength)
+    {
+        accumulator -= tickLength;
+        ticks++;
+    }
+    return ticks;
+}
+
+double FixedTimestep::secondsToNextTick() const
+{
+    double elapsed = std::chrono::duration<double>(Clock::now() - lastTime).count();
+    return std::max(0.0, tickLength - accumulator - elapsed);
+}
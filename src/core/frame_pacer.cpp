@@ -0,0 +1,81 @@
+#include "frame_pacer.h"
+#include "profiler.h"
+
+#include <thread>
+
+// Sleeps can overshoot by the scheduler's granularity; the end of a wait is
+// spun instead
+static const double SPIN_SECONDS = 0.0015;
+
+// Share of the period a swap has to block (on average) for the display to
+// count as pacing the loop
+static const double DISPLAY_PACED_FRACTION = 0.25;
+
+// Frame times kept for the percentiles (a minute at 1000 fps)
+static const int FRAME_HISTORY = 1 << 16;
+
+FramePacer::FramePacer(double fps)
+    : skipped(0), times(FRAME_HISTORY)
+{
+    setTargetFps(fps);
+    reset();
+}
+
+void FramePacer::setTargetFps(double fps)
+{
+    period = fps > 0.0 ? 1.0 / fps : 0.0;
+}
+
+void FramePacer::reset()
+{
+    scheduled = false;
+    presented = false;
+    swapAverage = 0.0;
+}
+
+bool FramePacer::displayPaced() const
+{
+    return !uncapped() && swapAverage > period * DISPLAY_PACED_FRACTION;
+}
+
+void FramePacer::waitForFrame()
+{
+    PROFILE_ZONE("waitForFrame");
+
+    Clock::time_point now = Clock::now();
+    if (uncapped())
+        return;
+
+    if (!scheduled || displayPaced())
+    {
+        // Start a new schedule with this frame
+        scheduled = true;
+        nextFrame = now;
+    }
+    else if (now < nextFrame)
+    {
+        double remaining = std::chrono::duration<double>(nextFrame - now).count();
+        if (remaining > SPIN_SECONDS)
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_SECONDS));
+        while (Clock::now() < nextFrame)
+            std::this_thread::yield();
+    }
+    else
+    {
+        double late = std::chrono::duration<double>(now - nextFrame).count();
+        skipped += static_cast<long long>(late / period);
+        nextFrame = now;
+    }
+
+    nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+}
+
+void FramePacer::framePresented(double swapSeconds)
+{
+    Clock::time_point now = Clock::now();
+    if (presented)
+        times.add(std::chrono::duration<double, std::milli>(now - lastPresent).count());
+    presented = true;
+    lastPresent = now;
+    swapAverage += (swapSeconds - swapAverage) * 0.1;
+}
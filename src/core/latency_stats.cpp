@@ -0,0 +1,46 @@
+#include "latency_stats.h"
+
+#include <algorithm>
+
+LatencyStats::LatencyStats(int capacity)
+    : samples(capacity), total(0)
+{
+}
+
+void LatencyStats::add(double ms)
+{
+    samples[total % samples.size()] = ms;
+    total++;
+}
+
+void LatencyStats::clear()
+{
+    total = 0;
+}
+
+// Nearest-rank percentile of an ascending array
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+LatencySummary LatencyStats::summary() const
+{
+    LatencySummary result = {total, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (total == 0)
+        return result;
+
+    std::vector<double> sorted(samples.begin(),
+                               samples.begin() + std::min<long long>(total, static_cast<long long>(samples.size())));
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ms : sorted)
+        sum += ms;
+    result.mean = sum / sorted.size();
+    result.p50 = percentile(sorted, 50);
+    result.p90 = percentile(sorted, 90);
+    result.p99 = percentile(sorted, 99);
+    result.max = sorted.back();
+    return result;
+}
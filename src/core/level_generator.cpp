@@ -0,0 +1,221 @@
+#include "level_generator.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+void LevelGenerator::reset(uint64_t seed, GameMode mode, const DifficultySettings &settings, const Tuning &tuning,
+                           int firstSpawn, float previousGapY)
+{
+    // Its own stream, so the world's generators are untouched
+    rng.reseed(seed + firstSpawn, 3);
+    this->mode = mode;
+    this->settings = settings;
+    this->tuning = tuning;
+    spawnIndex = firstSpawn;
+    this->previousGapY = previousGapY;
+    redrawCount = 0;
+    fallbackCount = 0;
+    planner.setNodeBudget(1 << 16);
+}
+
+LevelGenerator::Difficulty LevelGenerator::expectedDifficulty(int spawn) const
+{
+    // Spawn n happens (n + 1) intervals into the game
+    float interval = static_cast<float>(settings.spawnInterval);
+    float frame = (spawn + 1) * interval;
+
+    float level, speedScale, gravityScale, gapScale;
+    if (mode == MODE_TIME_TRIAL)
+    {
+        int seconds = static_cast<int>(frame / BASE_TICK_RATE);
+        level = static_cast<float>(seconds / tuning.timeTrialInterval);
+        speedScale = tuning.timeTrialSpeedScale;
+        gravityScale = tuning.timeTrialGravityScale;
+        gapScale = tuning.timeTrialGapScale;
+    }
+    else
+    {
+        // Pipes passed by then, each scoring a point once it has crossed the
+        // screen (at the speed of the level it is expected to cross at)
+        int score = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            float speed = settings.pipeSpeed + (score / tuning.difficultyInterval) * settings.speedIncrease;
+            float travel = (WINDOW_WIDTH + PIPE_WIDTH - BALL_X) / speed;
+            score = std::max(0, static_cast<int>(std::floor((frame - travel) / interval)));
+        }
+        level = static_cast<float>(score / tuning.difficultyInterval);
+        speedScale = gravityScale = gapScale = 1.0f;
+    }
+
+    Difficulty difficulty;
+    difficulty.pipeSpeed = settings.pipeSpeed + level * settings.speedIncrease * speedScale;
+    difficulty.gravity = settings.gravity + level * settings.gravityIncrease * gravityScale;
+    difficulty.gapHeight = std::max(tuning.minGapHeight, settings.gapHeight - level * settings.gapDecrease * gapScale);
+    return difficulty;
+}
+
+// Whether the planner gets a ball that enters the pipe at fromGapY (centred,
+// at rest) through it and the next pipe at toGapY
+bool LevelGenerator::reachable(float fromGapY, float toGapY, const Difficulty &difficulty)
+{
+    World &world = scratch;
+    world.state = PLAYING;
+    world.mode = MODE_EASY; // Score 0 below: no level-ups during the check
+    world.settings = settings;
+    world.tuning = tuning;
+    world.tickRate = BASE_TICK_RATE;
+    world.score = 0;
+    world.hasShield = world.hasSlowMotion = world.hasDoublePoints = false;
+    world.activePowerUp = -1;
+    world.powerUpTimer = 0;
+    world.currentPipeSpeed = difficulty.pipeSpeed;
+    world.currentGapHeight = difficulty.gapHeight;
+    world.currentGravity = difficulty.gravity;
+    world.spawnTimer = -1e9f; // Nothing else spawns
+
+    float x = BALL_X + ballRadius;
+    float nextX = x + settings.spawnInterval * difficulty.pipeSpeed;
+    world.pipes.clear();
+    world.pipes.push_back(Pipe{x, fromGapY, x});
+    world.pipes.push_back(Pipe{nextX, toGapY, nextX});
+    world.ballY = fromGapY + difficulty.gapHeight / 2;
+    world.ballSpeed = 0;
+
+    int ticks = static_cast<int>(std::ceil((nextX + PIPE_WIDTH - (BALL_X - ballRadius)) / difficulty.pipeSpeed)) + 1;
+    return planner.plan(world, ticks) == PLAN_FOUND;
+}
+
+void LevelGenerator::generate(SpawnEntry *out, int count)
+{
+    PROFILE_ZONE("LevelGenerator::generate");
+
+    for (int i = 0; i < count; i++)
+    {
+        Difficulty difficulty = expectedDifficulty(spawnIndex);
+
+        // Same ranges as the classic spawner
+        int range = WINDOW_HEIGHT - static_cast<int>(difficulty.gapHeight) - 100;
+        float gapY = static_cast<float>(rng.below(range) + 50);
+        if (previousGapY >= 0.0f)
+        {
+            int draws = 1;
+            while (!reachable(previousGapY, gapY, difficulty))
+            {
+                if (draws == MAX_DRAWS)
+                {
+                    gapY = std::min(previousGapY, static_cast<float>(range + 49));
+                    fallbackCount++;
+                    break;
+                }
+                gapY = static_cast<float>(rng.below(range) + 50);
+                draws++;
+                redrawCount++;
+            }
+        }
+
+        SpawnEntry &entry = out[i];
+        entry.gapY = gapY;
+        entry.powerUpType = -1;
+        entry.powerUpY = 0.0f;
+        if (rng.below(5) == 0)
+        {
+            entry.powerUpY = static_cast<float>(rng.below(WINDOW_HEIGHT - 100) + 50);
+            entry.powerUpType = rng.below(3);
+        }
+
+        previousGapY = gapY;
+        spawnIndex++;
+    }
+}
+
+LevelFeed::~LevelFeed()
+{
+    stopWorker();
+}
+
+void LevelFeed::stopWorker()
+{
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running = false;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void LevelFeed::restart(uint64_t seed, GameMode mode, const DifficultySettings &settings, const Tuning &tuning,
+                        int firstSpawn, float previousGapY)
+{
+    // With the worker stopped this thread may empty the queue
+    stopWorker();
+    SpawnEntry entry;
+    while (queue.pop(entry))
+    {
+    }
+
+    generator.reset(seed, mode, settings, tuning, firstSpawn, previousGapY);
+    handedOutCount = firstSpawn;
+    chunkPosition = LEVEL_CHUNK_SIZE;
+    if (!threaded)
+        return;
+
+    // Hand the worker a queue that already holds the first chunk
+    generator.generate(chunk, LEVEL_CHUNK_SIZE);
+    for (const SpawnEntry &first : chunk)
+        queue.push(first);
+    running = true;
+    worker = std::thread(&LevelFeed::workerLoop, this);
+}
+
+SpawnEntry LevelFeed::next()
+{
+    handedOutCount++;
+    if (!threaded)
+    {
+        if (chunkPosition == LEVEL_CHUNK_SIZE)
+        {
+            generator.generate(chunk, LEVEL_CHUNK_SIZE);
+            chunkPosition = 0;
+        }
+        return chunk[chunkPosition++];
+    }
+
+    SpawnEntry entry;
+    if (!queue.pop(entry))
+    {
+        // Only when the worker is a whole queue behind
+        stallCount++;
+        while (!queue.pop(entry))
+            std::this_thread::yield();
+    }
+    return entry;
+}
+
+void LevelFeed::workerLoop()
+{
+    SpawnEntry pending[LEVEL_CHUNK_SIZE];
+    int position = LEVEL_CHUNK_SIZE;
+    while (running)
+    {
+        if (position == LEVEL_CHUNK_SIZE)
+        {
+            generator.generate(pending, LEVEL_CHUNK_SIZE);
+            position = 0;
+        }
+        while (position < LEVEL_CHUNK_SIZE && queue.push(pending[position]))
+            position++;
+
+        // Queue full: the game takes an entry every second or two, so a slow
+        // poll keeps it topped up
+        if (position < LEVEL_CHUNK_SIZE)
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(50), [this] { return !running; });
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include "particle_pool.h"
+#include "world.h"
+#include "profiler.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLE_SIMD_WIDTH 4
+#else
+#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+const float PARTICLE_GRAVITY = 0.2f; // Per frame, pulls particles up the screen
+const float PARTICLE_DRAG = 0.99f;   // Velocity kept per frame (air resistance)
+
+// Life of unused slots, so the kernel never reports them as dying
+const float UNUSED_LIFE = 1e30f;
+
+static unsigned char quantize(float c)
+{
+    if (c <= 0.0f)
+        return 0;
+    if (c >= 1.0f)
+        return 255;
+    return static_cast<unsigned char>(c * 255.0f + 0.5f);
+}
+
+ParticlePool::ParticlePool(int capacity)
+    : count(0), cap(capacity)
+{
+    int padded = (capacity + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH * PARTICLE_SIMD_WIDTH;
+    px.assign(padded, 0.0f);
+    py.assign(padded, 0.0f);
+    vx.assign(padded, 0.0f);
+    vy.assign(padded, 0.0f);
+    lifeLeft.assign(padded, UNUSED_LIFE);
+    lastX.assign(padded, 0.0f);
+    lastY.assign(padded, 0.0f);
+    rgb.assign(padded, 0);
+}
+
+void ParticlePool::clear()
+{
+    for (int i = 0; i < count; i++)
+        lifeLeft[i] = UNUSED_LIFE;
+    count = 0;
+}
+
+bool ParticlePool::spawn(float x, float y, float velX, float velY, float r, float g, float b)
+{
+    if (count >= cap)
+        return false;
+
+    px[count] = x;
+    py[count] = y;
+    lastX[count] = x;
+    lastY[count] = y;
+    vx[count] = velX;
+    vy[count] = velY;
+    lifeLeft[count] = PARTICLE_LIFE;
+    rgb[count] = quantize(r) | (quantize(g) << 8) | (quantize(b) << 16);
+    count++;
+    return true;
+}
+
+float ParticlePool::alpha(int i) const
+{
+    float t = lifeLeft[i] / PARTICLE_LIFE;
+    return t * t;
+}
+
+void ParticlePool::color(int i, float &r, float &g, float &b) const
+{
+    r = (rgb[i] & 0xFF) / 255.0f;
+    g = ((rgb[i] >> 8) & 0xFF) / 255.0f;
+    b = ((rgb[i] >> 16) & 0xFF) / 255.0f;
+}
+
+// Integrate [0, n) (n a multiple of the SIMD width) and return true if any
+// particle in range ran out of life
+static bool integrate(float *x, float *y, float *vx, float *vy, float *life,
+                      float *prevX, float *prevY, int n, float frames, float drag)
+{
+#if PARTICLE_SIMD_WIDTH == 8
+    const __m256 f = _mm256_set1_ps(frames);
+    const __m256 gravity = _mm256_set1_ps(PARTICLE_GRAVITY * frames);
+    const __m256 dragV = _mm256_set1_ps(drag);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 dead = zero;
+    for (int i = 0; i < n; i += 8)
+    {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pvx = _mm256_loadu_ps(vx + i);
+        __m256 pvy = _mm256_loadu_ps(vy + i);
+        __m256 pl = _mm256_sub_ps(_mm256_loadu_ps(life + i), f);
+        _mm256_storeu_ps(prevX + i, px);
+        _mm256_storeu_ps(prevY + i, py);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(px, _mm256_mul_ps(pvx, f)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(py, _mm256_mul_ps(pvy, f)));
+        _mm256_storeu_ps(vy + i, _mm256_add_ps(pvy, gravity));
+        _mm256_storeu_ps(vx + i, _mm256_mul_ps(pvx, dragV));
+        _mm256_storeu_ps(life + i, pl);
+        dead = _mm256_or_ps(dead, _mm256_cmp_ps(pl, zero, _CMP_LE_OQ));
+    }
+    return _mm256_movemask_ps(dead) != 0;
+#elif PARTICLE_SIMD_WIDTH == 4
+    const __m128 f = _mm_set1_ps(frames);
+    const __m128 gravity = _mm_set1_ps(PARTICLE_GRAVITY * frames);
+    const __m128 dragV = _mm_set1_ps(drag);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 dead = zero;
+    for (int i = 0; i < n; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pvx = _mm_loadu_ps(vx + i);
+        __m128 pvy = _mm_loadu_ps(vy + i);
+        __m128 pl = _mm_sub_ps(_mm_loadu_ps(life + i), f);
+        _mm_storeu_ps(prevX + i, px);
+        _mm_storeu_ps(prevY + i, py);
+        _mm_storeu_ps(x + i, _mm_add_ps(px, _mm_mul_ps(pvx, f)));
+        _mm_storeu_ps(y + i, _mm_add_ps(py, _mm_mul_ps(pvy, f)));
+        _mm_storeu_ps(vy + i, _mm_add_ps(pvy, gravity));
+        _mm_storeu_ps(vx + i, _mm_mul_ps(pvx, dragV));
+        _mm_storeu_ps(life + i, pl);
+        dead = _mm_or_ps(dead, _mm_cmple_ps(pl, zero));
+    }
+    return _mm_movemask_ps(dead) != 0;
+#else
+    bool anyDead = false;
+    for (int i = 0; i < n; i++)
+    {
+        prevX[i] = x[i];
+        prevY[i] = y[i];
+        x[i] += vx[i] * frames;
+        y[i] += vy[i] * frames;
+        vy[i] += PARTICLE_GRAVITY * frames;
+        vx[i] *= drag;
+        life[i] -= frames;
+        anyDead |= life[i] <= 0.0f;
+    }
+    return anyDead;
+#endif
+}
+
+void ParticlePool::update(float frames)
+{
+    PROFILE_ZONE("updateParticles");
+
+    if (count == 0)
+        return;
+
+    const float drag = frames == 1.0f ? PARTICLE_DRAG : powf(PARTICLE_DRAG, frames);
+    int n = (count + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH * PARTICLE_SIMD_WIDTH;
+
+    // Lanes past count are unused slots; they are updated but never read
+    bool anyDead = integrate(&px[0], &py[0], &vx[0], &vy[0], &lifeLeft[0],
+                             &lastX[0], &lastY[0], n, frames, drag);
+    if (!anyDead)
+        return;
+
+    // Swap-and-pop: move the last live particle into each dead slot, so the
+    // cost scales with the number of deaths rather than the pool size
+    int i = 0;
+    while (i < count)
+    {
+        if (lifeLeft[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+        int last = --count;
+        px[i] = px[last];
+        py[i] = py[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        lifeLeft[i] = lifeLeft[last];
+        lastX[i] = lastX[last];
+        lastY[i] = lastY[last];
+        rgb[i] = rgb[last];
+        lifeLeft[last] = UNUSED_LIFE;
+    }
+}
@@ -0,0 +1,42 @@
+#include "pipe_queue.h"
+
+PipeQueue::PipeQueue(int capacity)
+    : mask(0), head(0), count(0)
+{
+    int size = 1;
+    while (size < capacity)
+        size *= 2;
+    slots.resize(size);
+    mask = size - 1;
+}
+
+bool PipeQueue::push_back(const Pipe &pipe)
+{
+    if (full())
+        return false;
+    slots[(head + count) & mask] = pipe;
+    count++;
+    return true;
+}
+
+void PipeQueue::pop_front()
+{
+    if (count == 0)
+        return;
+    head = (head + 1) & mask;
+    count--;
+}
+
+int PipeQueue::lowerBound(float minX) const
+{
+    int low = 0, high = count;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if ((*this)[middle].x < minX)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
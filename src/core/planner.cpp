@@ -0,0 +1,357 @@
+#include "planner.h"
+#include "policy.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Marks a pipe whose gap is not known (real gaps are at least 50)
+static const float UNKNOWN_GAP = -1.0f;
+
+// Longest schedule the autopilot plans; normally the next unknown pipe ends
+// the horizon well before that
+static const int AUTOPILOT_SECONDS = 10;
+
+JumpPlanner::JumpPlanner()
+    : nodeBudget(1 << 20), nodeCount(0), firstUnknownSpawn(0), frames(1.0f), jumpPower(POWER), swept(false),
+      cellKeys(1 << 12), cellStamps(1 << 12, 0), generation(0), cellCount(0)
+{
+}
+
+// Replays the ball-independent part of step() (timers, difficulty, spawns,
+// pipe movement, scoring) and records what the ball will face on each tick
+void JumpPlanner::buildTrack(const World &world, const float *upcomingGaps, int upcomingCount, int maxTicks)
+{
+    track.clear();
+    trackPipes.clear();
+    firstUnknownSpawn = -1;
+
+    const DifficultySettings &settings = world.settings;
+    const Tuning &tuning = world.tuning;
+    const float dt = 1.0f / world.tickRate;
+    frames = (float)BASE_TICK_RATE / world.tickRate;
+    jumpPower = tuning.jumpPower;
+    swept = world.sweptCollisions;
+
+    int score = world.score;
+    int activePowerUp = world.activePowerUp;
+    float powerUpTimer = world.powerUpTimer;
+    bool hasShield = world.hasShield;
+    bool hasSlowMotion = world.hasSlowMotion;
+    bool hasDoublePoints = world.hasDoublePoints;
+    float timeTrialTimer = world.timeTrialTimer;
+    int lastDifficultyIncrease = world.lastDifficultyIncrease;
+    float pipeSpeed = world.currentPipeSpeed;
+    float gapHeight = world.currentGapHeight;
+    float gravity = world.currentGravity;
+    float spawnTimer = world.spawnTimer;
+
+    std::vector<Pipe> pipes;
+    for (const Pipe &pipe : world.pipes)
+        pipes.push_back(pipe);
+    int spawns = 0;
+
+    // Generated levels spawn every currentSpawnInterval frames, and the
+    // world already holds the next entry
+    const bool generated = world.levelFeed != nullptr;
+    const float spawnInterval = generated ? static_cast<float>(world.currentSpawnInterval) : 100.0f;
+
+    for (int t = 0; t < maxTicks; t++)
+    {
+        TrackTick tick;
+
+        // What scriptedPolicy() would aim for before this tick
+        tick.targetY = WINDOW_HEIGHT / 2;
+        for (const Pipe &pipe : pipes)
+        {
+            if (pipe.x + PIPE_WIDTH >= BALL_X - ballRadius)
+            {
+                if (pipe.gapY != UNKNOWN_GAP)
+                    tick.targetY = pipe.gapY + gapHeight / 2;
+                break;
+            }
+        }
+
+        if (activePowerUp != -1 && powerUpTimer > 0)
+        {
+            powerUpTimer -= frames;
+            if (powerUpTimer <= 0)
+            {
+                hasShield = hasShield && activePowerUp != SHIELD;
+                hasSlowMotion = hasSlowMotion && activePowerUp != SLOW_MOTION;
+                hasDoublePoints = hasDoublePoints && activePowerUp != DOUBLE_POINTS;
+                activePowerUp = -1;
+                powerUpTimer = 0;
+            }
+        }
+
+        if (world.mode == MODE_TIME_TRIAL)
+        {
+            timeTrialTimer += dt;
+            int currentTime = static_cast<int>(timeTrialTimer);
+            if (currentTime >= lastDifficultyIncrease + tuning.timeTrialInterval)
+            {
+                lastDifficultyIncrease = currentTime;
+                pipeSpeed += settings.speedIncrease * tuning.timeTrialSpeedScale;
+                gravity += settings.gravityIncrease * tuning.timeTrialGravityScale;
+                float newGapHeight = gapHeight - (settings.gapDecrease * tuning.timeTrialGapScale);
+                gapHeight = (newGapHeight < tuning.minGapHeight) ? tuning.minGapHeight : newGapHeight;
+            }
+        }
+        else if (score > 0 && score % tuning.difficultyInterval == 0)
+        {
+            int level = score / tuning.difficultyInterval;
+            float speedIncrease = level * settings.speedIncrease;
+            pipeSpeed = hasSlowMotion ? settings.pipeSpeed + speedIncrease * 0.5f : settings.pipeSpeed + speedIncrease;
+            gravity = settings.gravity + level * settings.gravityIncrease;
+            float newGapHeight = settings.gapHeight - level * settings.gapDecrease;
+            gapHeight = (newGapHeight < tuning.minGapHeight) ? tuning.minGapHeight : newGapHeight;
+        }
+        tick.gravity = gravity;
+        tick.gapHeight = gapHeight;
+
+        // The world uses up a gap for every spawn, even one skipped while full
+        spawnTimer += frames;
+        if (spawnTimer >= spawnInterval)
+        {
+            spawnTimer -= spawnInterval;
+            int gap = generated ? spawns - 1 : spawns;
+            Pipe pipe;
+            pipe.x = WINDOW_WIDTH;
+            if (gap < 0)
+                pipe.gapY = spawnGapY(world.nextSpawn, gapHeight);
+            else
+                pipe.gapY = gap < upcomingCount ? upcomingGaps[gap] : UNKNOWN_GAP;
+            pipe.prevX = pipe.x;
+            spawns++;
+            if (static_cast<int>(pipes.size()) < world.pipes.capacity())
+                pipes.push_back(pipe);
+            if (pipe.gapY == UNKNOWN_GAP && firstUnknownSpawn < 0)
+                firstUnknownSpawn = t;
+        }
+
+        const float pipeStep = pipeSpeed * frames;
+        for (Pipe &pipe : pipes)
+        {
+            pipe.prevX = pipe.x;
+            pipe.x -= pipeStep;
+        }
+        while (!pipes.empty() && pipes.front().x + PIPE_WIDTH < 0)
+            pipes.erase(pipes.begin());
+
+        // Same broadphase as checkCollisions(); the horizon ends at the first
+        // unknown pipe in it
+        float reach = (swept ? pipeStep + ballRadius : std::max(pipeStep, ballRadius)) + 1.0f;
+        size_t first = 0;
+        while (first < pipes.size() && pipes[first].x < BALL_X - PIPE_WIDTH - reach)
+            first++;
+        tick.firstPipe = static_cast<int>(trackPipes.size());
+        bool unknownInReach = false;
+        for (size_t i = first; i < pipes.size() && pipes[i].x < BALL_X + ballRadius; i++)
+        {
+            const Pipe &pipe = pipes[i];
+            if (pipe.gapY == UNKNOWN_GAP)
+            {
+                unknownInReach = true;
+                break;
+            }
+            if (!hasShield)
+                trackPipes.push_back(pipe);
+            if (pipe.x + PIPE_WIDTH < BALL_X && pipe.x + PIPE_WIDTH + pipeStep >= BALL_X)
+                score += hasDoublePoints ? 2 : 1;
+        }
+        if (unknownInReach)
+        {
+            trackPipes.resize(tick.firstPipe);
+            break;
+        }
+        tick.endPipe = static_cast<int>(trackPipes.size());
+        track.push_back(tick);
+    }
+
+    if (firstUnknownSpawn < 0)
+        firstUnknownSpawn = static_cast<int>(track.size());
+}
+
+bool JumpPlanner::visit(int tick, float y, float speed)
+{
+    // Grow before the table is half full; only this search's cells move over
+    if (cellCount * 2 >= static_cast<int>(cellKeys.size()))
+    {
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> stamps;
+        keys.swap(cellKeys);
+        stamps.swap(cellStamps);
+        cellKeys.assign(keys.size() * 2, 0);
+        cellStamps.assign(keys.size() * 2, 0);
+        uint32_t current = generation;
+        generation = 1;
+        cellCount = 0;
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (stamps[i] != current)
+                continue;
+            size_t mask = cellKeys.size() - 1;
+            size_t slot = static_cast<size_t>((keys[i] * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+            while (cellStamps[slot] == generation)
+                slot = (slot + 1) & mask;
+            cellKeys[slot] = keys[i];
+            cellStamps[slot] = generation;
+            cellCount++;
+        }
+    }
+
+    int yCell = static_cast<int>(std::floor(y / PLAN_Y_STEP));
+    int speedCell = static_cast<int>(std::floor(std::max(-32768.0f, std::min(speed / PLAN_SPEED_STEP, 32767.0f))));
+    uint64_t key = (static_cast<uint64_t>(tick) << 32) | (static_cast<uint64_t>(yCell & 0xFFFF) << 16) |
+                   static_cast<uint64_t>((speedCell + 0x8000) & 0xFFFF);
+
+    size_t mask = cellKeys.size() - 1;
+    size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (cellStamps[slot] == generation)
+    {
+        if (cellKeys[slot] == key)
+            return false;
+        slot = (slot + 1) & mask;
+    }
+    cellKeys[slot] = key;
+    cellStamps[slot] = generation;
+    cellCount++;
+    return true;
+}
+
+PlanResult JumpPlanner::plan(const World &world, const float *upcomingGaps, int upcomingCount, int maxTicks)
+{
+    PROFILE_ZONE("JumpPlanner::plan");
+
+    buildTrack(world, upcomingGaps, upcomingCount, maxTicks);
+    const int ticks = static_cast<int>(track.size());
+
+    // A fresh stamp empties the visited set
+    if (++generation == 0)
+    {
+        std::fill(cellStamps.begin(), cellStamps.end(), 0);
+        generation = 1;
+    }
+    cellCount = 0;
+    nodeCount = 0;
+
+    path.assign(ticks, 0);
+    pathY.assign(ticks, 0.0f);
+    pathSpeed.assign(ticks, 0.0f);
+    stack.resize(ticks + 1);
+
+    auto prefer = [this, ticks](int t, float y, float speed) -> uint8_t {
+        return t < ticks && speed > 0 && y < track[t].targetY;
+    };
+
+    // Depth-first, one frame per tick; a frame is popped once both of its
+    // actions led nowhere
+    stack[0] = Frame{world.ballY, world.ballSpeed, prefer(0, world.ballY, world.ballSpeed), 0};
+    int depth = 0;
+    while (depth >= 0)
+    {
+        if (depth == ticks)
+            return PLAN_FOUND;
+
+        Frame &frame = stack[depth];
+        if (frame.tried == 2)
+        {
+            depth--;
+            continue;
+        }
+        if (nodeCount >= nodeBudget)
+        {
+            path.clear();
+            pathY.clear();
+            pathSpeed.clear();
+            return PLAN_GAVE_UP;
+        }
+
+        uint8_t jump = frame.tried == 0 ? frame.preferred : !frame.preferred;
+        frame.tried++;
+        nodeCount++;
+
+        // The ball part of step()
+        const TrackTick &tick = track[depth];
+        float speed = jump ? jumpPower : frame.speed;
+        speed += tick.gravity * frames;
+        float y = frame.y - speed * frames;
+
+        if (y < 0 || y + 30 > WINDOW_HEIGHT)
+            continue;
+        bool hit = false;
+        for (int i = tick.firstPipe; i < tick.endPipe && !hit; i++)
+        {
+            hit = swept ? sweepBallPipe(frame.y, y, trackPipes[i], tick.gapHeight) >= 0.0f
+                        : ballHitsPipe(y, trackPipes[i], tick.gapHeight);
+        }
+        if (hit || !visit(depth + 1, y, speed))
+            continue;
+
+        path[depth] = jump;
+        pathY[depth] = y;
+        pathSpeed[depth] = speed;
+        depth++;
+        stack[depth] = Frame{y, speed, prefer(depth, y, speed), 0};
+    }
+
+    path.clear();
+    pathY.clear();
+    pathSpeed.clear();
+    return PLAN_IMPOSSIBLE;
+}
+
+void Autopilot::reset()
+{
+    planned = false;
+    planStart = 0;
+    planEnd = 0;
+    retryTick = 0;
+}
+
+bool Autopilot::onPlan(const World &world) const
+{
+    int index = world.tickCount - planStart;
+    if (index < 0 || world.tickCount >= planEnd || world.lives != livesAtPlan ||
+        world.activePowerUp != powerUpAtPlan)
+    {
+        return false;
+    }
+    return index == 0 ||
+           (world.ballY == planner.ballY()[index - 1] && world.ballSpeed == planner.ballSpeed()[index - 1]);
+}
+
+Input Autopilot::next(const World &world)
+{
+    // Leaving the plan (or a new game) calls for a new search right away; with
+    // no schedule, search again once the world has changed
+    bool changed = world.tickCount < planStart || world.lives != livesAtPlan || world.activePowerUp != powerUpAtPlan;
+    if (planned && !onPlan(world))
+    {
+        planned = false;
+        retryTick = 0;
+    }
+    if (!planned && (changed || world.tickCount >= retryTick))
+    {
+        PlanResult result = planner.plan(world, world.tickRate * AUTOPILOT_SECONDS);
+        planCount++;
+        if (result == PLAN_IMPOSSIBLE)
+            impossibleCount++;
+
+        // The plan holds until the world spawns a pipe it did not know about
+        planStart = world.tickCount;
+        planEnd = planStart + std::min(planner.horizon(), planner.unknownSpawnTick() + 1);
+        livesAtPlan = world.lives;
+        powerUpAtPlan = world.activePowerUp;
+        planned = result == PLAN_FOUND && planEnd > planStart;
+        retryTick = std::max(planEnd, planStart + 1);
+    }
+
+    if (!planned)
+        return scriptedPolicy(world);
+
+    Input input;
+    input.jump = planner.jumps()[world.tickCount - planStart] != 0;
+    return input;
+}
@@ -0,0 +1,20 @@
+#include "policy.h"
+
+Input scriptedPolicy(const World &world)
+{
+    // Aim for the centre of the first pipe the ball has not passed yet
+    float targetY = WINDOW_HEIGHT / 2;
+    for (const auto &pipe : world.pipes)
+    {
+        if (pipe.x + PIPE_WIDTH >= BALL_X - ballRadius)
+        {
+            targetY = pipe.gapY + world.currentGapHeight / 2;
+            break;
+        }
+    }
+
+    // ballSpeed is positive while falling
+    Input input;
+    input.jump = world.ballSpeed > 0 && world.ballY < targetY;
+    return input;
+}
@@ -0,0 +1,188 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+
+Profiler profiler;
+thread_local int profileDepth = 0;
+
+static std::atomic<int> nextThreadId(0);
+static thread_local int threadId = -1;
+
+static int64_t steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Profiler::Profiler()
+    : active(false), epochNs(steadyNs()), events(EVENT_CAPACITY), eventCount(0),
+      frameStarts(FRAME_CAPACITY), frameCount(0)
+{
+}
+
+void Profiler::setEnabled(bool on)
+{
+    if (on && !enabled())
+    {
+        // Frames from an earlier session would span the time we were off
+        frameCount = 0;
+    }
+    active.store(on, std::memory_order_relaxed);
+}
+
+int64_t Profiler::now() const
+{
+    return steadyNs() - epochNs;
+}
+
+void Profiler::record(const char *name, int64_t start, int64_t end, int depth)
+{
+    if (threadId < 0)
+        threadId = nextThreadId.fetch_add(1);
+
+    uint64_t index = eventCount.fetch_add(1, std::memory_order_relaxed);
+    ProfileEvent &event = events[index % EVENT_CAPACITY];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    event.depth = depth;
+    event.thread = threadId;
+}
+
+void Profiler::frameMark()
+{
+    if (!enabled())
+        return;
+    frameStarts[frameCount % FRAME_CAPACITY] = now();
+    frameCount++;
+}
+
+int Profiler::frameTimes(float *out, int count) const
+{
+    // frameCount - 1 frames are finished; the ring holds the starts of the
+    // last FRAME_CAPACITY frames, so FRAME_CAPACITY - 1 durations
+    uint64_t finished = frameCount > 0 ? frameCount - 1 : 0;
+    uint64_t available = std::min<uint64_t>(finished, FRAME_CAPACITY - 1);
+    int n = static_cast<int>(std::min<uint64_t>(available, count));
+
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t frame = finished - n + i;
+        int64_t begin = frameStarts[frame % FRAME_CAPACITY];
+        int64_t end = frameStarts[(frame + 1) % FRAME_CAPACITY];
+        out[i] = static_cast<float>((end - begin) / 1e6);
+    }
+    return n;
+}
+
+int Profiler::zoneStats(int frames, ZoneStats *out, int maxZones) const
+{
+    uint64_t finished = frameCount > 0 ? frameCount - 1 : 0;
+    int n = static_cast<int>(std::min<uint64_t>(std::min<uint64_t>(finished, FRAME_CAPACITY - 1), frames));
+    if (n <= 0 || maxZones <= 0)
+        return 0;
+
+    // Frame boundaries of the window: frame i covers [bounds[i], bounds[i + 1])
+    std::vector<int64_t> bounds(n + 1);
+    for (int i = 0; i <= n; i++)
+        bounds[i] = frameStarts[(finished - n + i) % FRAME_CAPACITY];
+
+    // Per-zone time in each frame of the window
+    int zoneCount = 0;
+    std::vector<double> perFrame(static_cast<size_t>(maxZones) * n, 0.0);
+    std::vector<long long> calls(maxZones, 0);
+
+    // Events are stored roughly in the order they ended, so walk back from
+    // the newest until they end before the window
+    uint64_t count = eventCount.load(std::memory_order_relaxed);
+    uint64_t oldest = count > EVENT_CAPACITY ? count - EVENT_CAPACITY : 0;
+    for (uint64_t i = count; i > oldest; i--)
+    {
+        const ProfileEvent &event = events[(i - 1) % EVENT_CAPACITY];
+        if (event.end < bounds[0])
+            break;
+        if (event.start < bounds[0] || event.start >= bounds[n])
+            continue;
+
+        int frame = static_cast<int>(std::upper_bound(bounds.begin(), bounds.end(), event.start) - bounds.begin()) - 1;
+
+        int zone = 0;
+        while (zone < zoneCount && out[zone].name != event.name && strcmp(out[zone].name, event.name) != 0)
+            zone++;
+        if (zone == zoneCount)
+        {
+            if (zoneCount == maxZones)
+                continue;
+            out[zone].name = event.name;
+            out[zone].depth = event.depth;
+            zoneCount++;
+        }
+        perFrame[static_cast<size_t>(zone) * n + frame] += (event.end - event.start) / 1e6;
+        calls[zone]++;
+    }
+
+    for (int zone = 0; zone < zoneCount; zone++)
+    {
+        double total = 0.0, largest = 0.0;
+        for (int f = 0; f < n; f++)
+        {
+            double ms = perFrame[static_cast<size_t>(zone) * n + f];
+            total += ms;
+            largest = std::max(largest, ms);
+        }
+        out[zone].avgMs = total / n;
+        out[zone].maxMs = largest;
+        out[zone].callsPerFrame = static_cast<double>(calls[zone]) / n;
+    }
+
+    // Zones were found newest first; list them in order of first appearance,
+    // outer zones before the ones nested in them
+    std::reverse(out, out + zoneCount);
+    std::stable_sort(out, out + zoneCount, [](const ZoneStats &a, const ZoneStats &b) {
+        return a.depth < b.depth;
+    });
+    return zoneCount;
+}
+
+bool Profiler::writeChromeTrace(const char *path, double seconds) const
+{
+    int64_t since = now() - static_cast<int64_t>(seconds * 1e9);
+
+    uint64_t count = eventCount.load(std::memory_order_relaxed);
+    uint64_t oldest = count > EVENT_CAPACITY ? count - EVENT_CAPACITY : 0;
+    uint64_t first = count;
+    while (first > oldest && events[(first - 1) % EVENT_CAPACITY].end >= since)
+        first--;
+
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool comma = false;
+    for (uint64_t i = first; i < count; i++)
+    {
+        const ProfileEvent &event = events[i % EVENT_CAPACITY];
+        fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                comma ? ",\n" : "", event.name, event.thread, event.start / 1e3, (event.end - event.start) / 1e3);
+        comma = true;
+    }
+
+    // Frame boundaries as global instant events
+    uint64_t frames = std::min<uint64_t>(frameCount, FRAME_CAPACITY);
+    for (uint64_t i = frameCount - frames; i < frameCount; i++)
+    {
+        int64_t start = frameStarts[i % FRAME_CAPACITY];
+        if (start < since)
+            continue;
+        fprintf(file, "%s{\"name\": \"frame\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, \"tid\": 0, \"ts\": %.3f}",
+                comma ? ",\n" : "", start / 1e3);
+        comma = true;
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,273 @@
+#include "replay.h"
+
+#include <cstring>
+#include <stdio.h>
+
+// File layout (little-endian):
+//   "FBRP", u8 version, u8 mode, u8 flags (version 2 on), u16 tick rate,
+//   u64 seed, u32 tick count, u64 final hash, u32 jump count, then one varint
+//   delta per jump tick
+static const char REPLAY_MAGIC[4] = {'F', 'B', 'R', 'P'};
+static const int REPLAY_VERSION = 2;
+static const int REPLAY_GENERATED_LEVELS = 1 << 0;
+static const int REPLAY_SWEPT_COLLISIONS = 1 << 1;
+
+void beginRecording(Replay &replay, const World &world)
+{
+    replay.seed = world.seed;
+    replay.mode = world.mode;
+    replay.tickRate = world.tickRate;
+    replay.generatedLevels = world.levelFeed != nullptr;
+    replay.sweptCollisions = world.sweptCollisions;
+    replay.tickCount = 0;
+    replay.jumpTicks.clear();
+    replay.finalHash = 0;
+}
+
+void recordInput(Replay &replay, const Input &input)
+{
+    if (input.jump)
+        replay.jumpTicks.push_back(replay.tickCount);
+    replay.tickCount++;
+}
+
+void finishRecording(Replay &replay, const World &world)
+{
+    replay.finalHash = worldHash(world);
+}
+
+static void putBytes(std::vector<unsigned char> &out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+static void putVarint(std::vector<unsigned char> &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Reads from a byte buffer; every read fails once the buffer runs out
+struct ByteReader
+{
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+
+    bool getBytes(uint64_t &value, int bytes)
+    {
+        if (pos + bytes > size)
+            return false;
+        value = 0;
+        for (int i = 0; i < bytes; i++)
+            value |= static_cast<uint64_t>(data[pos++]) << (8 * i);
+        return true;
+    }
+
+    bool getVarint(uint32_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (pos >= size)
+                return false;
+            unsigned char byte = data[pos++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+};
+
+bool saveReplay(const Replay &replay, const char *path)
+{
+    int flags = (replay.generatedLevels ? REPLAY_GENERATED_LEVELS : 0) |
+                (replay.sweptCollisions ? REPLAY_SWEPT_COLLISIONS : 0);
+    std::vector<unsigned char> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    putBytes(out, REPLAY_VERSION, 1);
+    putBytes(out, replay.mode, 1);
+    putBytes(out, flags, 1);
+    putBytes(out, replay.tickRate, 2);
+    putBytes(out, replay.seed, 8);
+    putBytes(out, replay.tickCount, 4);
+    putBytes(out, replay.finalHash, 8);
+    putBytes(out, replay.jumpTicks.size(), 4);
+
+    int previous = 0;
+    for (int tick : replay.jumpTicks)
+    {
+        putVarint(out, static_cast<uint32_t>(tick - previous));
+        previous = tick;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return fclose(file) == 0 && ok;
+}
+
+bool loadReplay(Replay &replay, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    std::vector<unsigned char> data;
+    unsigned char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+
+    if (data.size() < 4 || memcmp(data.data(), REPLAY_MAGIC, 4) != 0)
+        return false;
+
+    ByteReader reader = {data.data(), data.size(), 4};
+    uint64_t version, mode, flags = 0, tickRate, seed, tickCount, finalHash, jumpCount;
+    if (!reader.getBytes(version, 1) || version < 1 || version > REPLAY_VERSION ||
+        !reader.getBytes(mode, 1) || (version >= 2 && !reader.getBytes(flags, 1)) ||
+        !reader.getBytes(tickRate, 2) ||
+        !reader.getBytes(seed, 8) || !reader.getBytes(tickCount, 4) ||
+        !reader.getBytes(finalHash, 8) || !reader.getBytes(jumpCount, 4))
+        return false;
+    if (mode < MODE_EASY || mode > MODE_TIME_TRIAL || (flags & ~(REPLAY_GENERATED_LEVELS | REPLAY_SWEPT_COLLISIONS)) || tickRate == 0 ||
+        tickCount > 0x7FFFFFFF || jumpCount > tickCount)
+        return false;
+
+    Replay loaded;
+    loaded.seed = seed;
+    loaded.mode = static_cast<GameMode>(mode);
+    loaded.tickRate = static_cast<int>(tickRate);
+    loaded.generatedLevels = (flags & REPLAY_GENERATED_LEVELS) != 0;
+    loaded.sweptCollisions = (flags & REPLAY_SWEPT_COLLISIONS) != 0;
+    loaded.tickCount = static_cast<int>(tickCount);
+    loaded.finalHash = finalHash;
+    loaded.jumpTicks.reserve(jumpCount);
+
+    uint64_t tick = 0;
+    for (uint64_t i = 0; i < jumpCount; i++)
+    {
+        uint32_t delta;
+        if (!reader.getVarint(delta))
+            return false;
+        tick += delta;
+        if (tick >= tickCount || (i > 0 && delta == 0))
+            return false;
+        loaded.jumpTicks.push_back(static_cast<int>(tick));
+    }
+
+    replay = loaded;
+    return true;
+}
+
+void ReplayPlayer::start(World &world, const Replay &replay)
+{
+    source = &replay;
+    tick = 0;
+    nextJump = 0;
+
+    world.tickRate = replay.tickRate;
+    world.seed = replay.seed;
+    world.sweptCollisions = replay.sweptCollisions;
+    resetWorld(world, replay.mode);
+}
+
+Input ReplayPlayer::next()
+{
+    Input input = {false};
+    if (finished())
+        return input;
+
+    if (nextJump < source->jumpTicks.size() && source->jumpTicks[nextJump] == tick)
+    {
+        input.jump = true;
+        nextJump++;
+    }
+    tick++;
+    return input;
+}
+
+void playReplay(World &world, const Replay &replay)
+{
+    ReplayPlayer player;
+    player.start(world, replay);
+    while (!player.finished())
+        step(world, player.next());
+}
+
+// FNV-1a over the raw bytes of each value
+struct StateHasher
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    template <typename T>
+    void add(const T &value)
+    {
+        unsigned char bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        for (unsigned char byte : bytes)
+        {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+    }
+};
+
+uint64_t worldHash(const World &world)
+{
+    StateHasher h;
+    h.add(static_cast<int>(world.state));
+    h.add(world.rng.currentState());
+    h.add(world.fxRng.currentState());
+    h.add(world.ballY);
+    h.add(world.ballSpeed);
+    h.add(world.score);
+    h.add(world.lives);
+    h.add(world.tickCount);
+    h.add(world.invincibilityTimer);
+    h.add(world.spawnTimer);
+    h.add(world.powerUpTimer);
+    h.add(world.activePowerUp);
+    h.add(world.currentPipeSpeed);
+    h.add(world.currentGapHeight);
+    h.add(world.currentGravity);
+    h.add(world.timeTrialTimer);
+    if (world.levelFeed)
+    {
+        h.add(world.nextSpawn.gapY);
+        h.add(world.nextSpawn.powerUpType);
+        h.add(world.nextSpawn.powerUpY);
+    }
+
+    h.add(static_cast<uint64_t>(world.pipes.size()));
+    for (const auto &pipe : world.pipes)
+    {
+        h.add(pipe.x);
+        h.add(pipe.gapY);
+    }
+    h.add(static_cast<uint64_t>(world.powerUps.size()));
+    for (int i = 0; i < world.powerUps.size(); i++)
+    {
+        h.add(world.powerUps.get<Scroll>(i).x);
+        h.add(world.powerUps.get<PowerUpBody>(i).y);
+        h.add(world.powerUps.get<PowerUpBody>(i).type);
+    }
+    for (int i = 0; i < world.clouds.size(); i++)
+    {
+        h.add(world.clouds.get<Scroll>(i).x);
+        h.add(world.clouds.get<CloudBody>(i).y);
+    }
+    h.add(world.particles.size());
+    for (int i = 0; i < world.particles.size(); i++)
+    {
+        h.add(world.particles.x(i));
+        h.add(world.particles.y(i));
+    }
+    return h.hash;
+}
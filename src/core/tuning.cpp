@@ -0,0 +1,165 @@
+#include "tuning.h"
+
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// A named field of a Tuning, as a pointer into one particular instance
+struct TuningField
+{
+    std::string name;
+    float *real;
+    int *integer;
+    float minimum; // Smallest accepted value
+    float maximum; // Largest accepted value
+};
+
+static void listFields(Tuning &tuning, std::vector<TuningField> &fields)
+{
+    const float ANY = -1e9f;
+    const float NONE = FLT_MAX;
+    // Gaps are placed in [50, WINDOW_HEIGHT - 50), so no taller gap fits
+    const float MAX_GAP = WINDOW_HEIGHT - 100;
+    // Level generation divides by the pipe speed; at 0.1 px a frame a pipe
+    // already takes over two minutes to cross the screen
+    const float MIN_SPEED = 0.1f;
+    fields.push_back({"jump_power", &tuning.jumpPower, nullptr, ANY, NONE});
+    fields.push_back({"power_up_duration", nullptr, &tuning.powerUpDuration, 1, NONE});
+    fields.push_back({"min_gap_height", &tuning.minGapHeight, nullptr, 0, MAX_GAP});
+    fields.push_back({"difficulty_interval", nullptr, &tuning.difficultyInterval, 1, NONE});
+    fields.push_back({"time_trial_interval", nullptr, &tuning.timeTrialInterval, 1, NONE});
+    fields.push_back({"time_trial_speed_scale", &tuning.timeTrialSpeedScale, nullptr, ANY, NONE});
+    fields.push_back({"time_trial_gravity_scale", &tuning.timeTrialGravityScale, nullptr, ANY, NONE});
+    fields.push_back({"time_trial_gap_scale", &tuning.timeTrialGapScale, nullptr, ANY, NONE});
+
+    static const char *const modeNames[4] = {"easy", "medium", "hard", "time_trial"};
+    for (int m = 0; m < 4; m++)
+    {
+        DifficultySettings &settings = tuning.modes[m];
+        std::string prefix = std::string(modeNames[m]) + ".";
+        fields.push_back({prefix + "pipe_speed", &settings.pipeSpeed, nullptr, MIN_SPEED, NONE});
+        fields.push_back({prefix + "gap_height", &settings.gapHeight, nullptr, 0, MAX_GAP});
+        fields.push_back({prefix + "gravity", &settings.gravity, nullptr, ANY, NONE});
+        fields.push_back({prefix + "spawn_interval", nullptr, &settings.spawnInterval, 1, NONE});
+        fields.push_back({prefix + "speed_increase", &settings.speedIncrease, nullptr, ANY, NONE});
+        fields.push_back({prefix + "gap_decrease", &settings.gapDecrease, nullptr, ANY, NONE});
+        fields.push_back({prefix + "gravity_increase", &settings.gravityIncrease, nullptr, ANY, NONE});
+    }
+}
+
+// Strip leading and trailing whitespace in place
+static char *trim(char *text)
+{
+    while (*text == ' ' || *text == '\t')
+        text++;
+    char *end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+        *--end = '\0';
+    return text;
+}
+
+bool loadTuning(Tuning &tuning, const char *path, std::string &error)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        error = std::string("cannot open ") + path + ": " + strerror(errno);
+        return false;
+    }
+
+    // Parse into a copy so a bad file changes nothing
+    Tuning loaded = tuning;
+    std::vector<TuningField> fields;
+    listFields(loaded, fields);
+
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+        char *text = trim(line);
+        if (*text == '\0')
+            continue;
+
+        char where[300];
+        snprintf(where, sizeof(where), "%s:%d: ", path, lineNumber);
+
+        char *equals = strchr(text, '=');
+        if (!equals)
+        {
+            error = std::string(where) + "expected key = value";
+            ok = false;
+            break;
+        }
+        *equals = '\0';
+        const char *key = trim(text);
+        const char *value = trim(equals + 1);
+
+        const TuningField *field = nullptr;
+        for (const TuningField &candidate : fields)
+            if (candidate.name == key)
+                field = &candidate;
+        if (!field)
+        {
+            error = std::string(where) + "unknown key '" + key + "'";
+            ok = false;
+            break;
+        }
+
+        // strtod() accepts "nan" and "inf", and NaN passes every comparison;
+        // integers must fit an int, and reals a float
+        char *end;
+        errno = 0;
+        double number;
+        bool inRange;
+        if (field->real)
+        {
+            number = static_cast<float>(strtod(value, &end)); // Limits apply to the stored float
+            inRange = std::isfinite(number);
+        }
+        else
+        {
+            long integer = strtol(value, &end, 10);
+            number = static_cast<double>(integer);
+            inRange = errno != ERANGE && integer >= INT_MIN && integer <= INT_MAX;
+        }
+        if (end == value || *end != '\0' || !inRange || number < field->minimum ||
+            number > field->maximum)
+        {
+            error = std::string(where) + "bad value '" + value + "' for " + key;
+            ok = false;
+            break;
+        }
+        if (field->real)
+            *field->real = static_cast<float>(number);
+        else
+            *field->integer = static_cast<int>(number);
+    }
+
+    fclose(file);
+    if (ok)
+        tuning = loaded;
+    return ok;
+}
+
+void writeTuning(const Tuning &tuning, FILE *out)
+{
+    Tuning copy = tuning;
+    std::vector<TuningField> fields;
+    listFields(copy, fields);
+    for (const TuningField &field : fields)
+    {
+        if (field.real)
+            fprintf(out, "%s = %g\n", field.name.c_str(), *field.real);
+        else
+            fprintf(out, "%s = %d\n", field.name.c_str(), *field.integer);
+    }
+}
@@ -0,0 +1,529 @@
+#include "vec_env.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VEC_ENV_SSE2 1
+#else
+#define VEC_ENV_SSE2 0
+#endif
+
+// Most pipes a game can hold at once. A pipe lives until it is PIPE_WIDTH
+// past the left edge (checked once per tick), and one spawns at most every
+// 100 frames; the speed never drops below the mode's base speed unless a
+// level-up can lower it.
+static int pipeSlotsFor(GameMode mode, const DifficultySettings &settings, const Tuning &tuning, float frames)
+{
+    bool slowsDown = settings.speedIncrease < 0.0f || (mode == MODE_TIME_TRIAL && tuning.timeTrialSpeedScale < 0.0f);
+    if (slowsDown || settings.pipeSpeed <= 0.0f)
+        return MAX_PIPES;
+    float lifeFrames = (WINDOW_WIDTH + PIPE_WIDTH) / settings.pipeSpeed + frames;
+    if (lifeFrames >= MAX_PIPES * 100.0f)
+        return MAX_PIPES;
+    int pipes = static_cast<int>(lifeFrames / 100.0f) + 2;
+    return std::min(MAX_PIPES, (pipes + 3) / 4 * 4); // Moved four at a time
+}
+
+VecEnv::VecEnv(int count, GameMode mode, int tickRate, const Tuning &tuning)
+    : count(count), mode(mode), tickRate(tickRate), tuning(tuning), settings(tuning.modes[mode - 1]),
+      frames((float)BASE_TICK_RATE / tickRate), dt(1.0f / tickRate),
+      pipeSlotCount(pipeSlotsFor(mode, settings, tuning, frames)),
+      seeds(count), rngs(count), playing(count), scores(count), lives(count), tickCounts(count),
+      activePowerUps(count), lastDifficultyIncreases(count), ballY(count), ballSpeed(count),
+      invincibilityTimers(count), powerUpTimers(count), spawnTimers(count), timeTrialTimers(count),
+      pipeSpeeds(count), gapHeights(count), gravities(count), pipeSteps(count),
+      levels(count), onLevels(count),
+      pipeCounts(count), pipeX(count * pipeSlotCount), pipeGapY(count * pipeSlotCount),
+      powerUpCounts(count), powerUpX(count * POWER_UP_SLOTS), powerUpY(count * POWER_UP_SLOTS),
+      powerUpTypes(count * POWER_UP_SLOTS)
+{
+}
+
+void VecEnv::reset(const uint64_t *seeds)
+{
+    for (int i = 0; i < count; i++)
+        reset(i, seeds[i]);
+}
+
+void VecEnv::reset(int env, uint64_t seed)
+{
+    // Mirrors the gameplay part of resetWorld()
+    seeds[env] = seed;
+    rngs[env].reseed(seed, 1);
+    playing[env] = 1;
+    scores[env] = 0;
+    lives[env] = INITIAL_LIVES;
+    tickCounts[env] = 0;
+    activePowerUps[env] = -1;
+    lastDifficultyIncreases[env] = 0;
+    ballY[env] = WINDOW_HEIGHT / 2;
+    ballSpeed[env] = 0;
+    invincibilityTimers[env] = 0;
+    powerUpTimers[env] = 0;
+    spawnTimers[env] = 0.0f;
+    timeTrialTimers[env] = 0.0f;
+    pipeSpeeds[env] = settings.pipeSpeed;
+    gapHeights[env] = settings.gapHeight;
+    gravities[env] = settings.gravity;
+    pipeSteps[env] = 0.0f;
+    levels[env] = 0;
+    onLevels[env] = 0;
+    pipeCounts[env] = 0;
+    powerUpCounts[env] = 0;
+
+    // Unused slots still move with the rest, so keep them finite
+    std::fill_n(&pipeX[env * pipeSlotCount], pipeSlotCount, 0.0f);
+    std::fill_n(&powerUpX[env * POWER_UP_SLOTS], POWER_UP_SLOTS, 0.0f);
+}
+
+#if VEC_ENV_SSE2
+// Per-lane a ? b : c, with `mask` all ones or all zeros in each lane
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+// The start of step() up to the ball movement: jump, timers, difficulty and
+// gravity. Four games at a time with SSE2 (compilers do not vectorize the
+// selects on their own; finished games select their old values), then plain
+// code for the rest. Both do the same float operations in the same order as
+// step(), so the results are identical.
+template <bool timeTrial>
+void VecEnv::advance(const uint8_t *actions)
+{
+    const int32_t *active = playing.data();
+    int32_t *powerUps = activePowerUps.data();
+    int32_t *ticks = tickCounts.data();
+    int32_t *lastIncrease = lastDifficultyIncreases.data();
+    const int32_t *level = levels.data();
+    const int32_t *onLevel = onLevels.data();
+    float *y = ballY.data();
+    float *speed = ballSpeed.data();
+    float *invincibility = invincibilityTimers.data();
+    float *powerUpTimer = powerUpTimers.data();
+    float *spawnTimer = spawnTimers.data();
+    float *timeTrialTimer = timeTrialTimers.data();
+    float *pipeSpeed = pipeSpeeds.data();
+    float *gapHeight = gapHeights.data();
+    float *gravity = gravities.data();
+    float *pipeStep = pipeSteps.data();
+
+    const DifficultySettings s = settings;
+    const float frames = this->frames, dt = this->dt;
+    const float jumpPower = tuning.jumpPower, minGapHeight = tuning.minGapHeight;
+    const int timeTrialInterval = tuning.timeTrialInterval;
+    const float timeTrialSpeedStep = s.speedIncrease * tuning.timeTrialSpeedScale;
+    const float timeTrialGravityStep = s.gravityIncrease * tuning.timeTrialGravityScale;
+    const float timeTrialGapStep = s.gapDecrease * tuning.timeTrialGapScale;
+    const int n = count;
+
+    int i = 0;
+#if VEC_ENV_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i zeroInt = _mm_setzero_si128();
+    const __m128i allOnes = _mm_set1_epi32(-1); // Also "no power-up"
+    const __m128i slowMotion = _mm_set1_epi32(SLOW_MOTION);
+    const __m128 framesV = _mm_set1_ps(frames);
+    const __m128 jumpPowerV = _mm_set1_ps(jumpPower);
+    const __m128 minGapHeightV = _mm_set1_ps(minGapHeight);
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128i onInt = _mm_xor_si128(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(active + i)), zeroInt), allOnes);
+        const __m128 on = _mm_castsi128_ps(onInt);
+
+        int packedActions;
+        memcpy(&packedActions, actions + i, sizeof(packedActions));
+        const __m128i actionWords = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedActions), zeroInt), zeroInt);
+        const __m128 jump = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(actionWords, zeroInt)), on);
+        const __m128 ballSpeed = select(jump, jumpPowerV, _mm_loadu_ps(speed + i));
+
+        const __m128 oldInvincibility = _mm_loadu_ps(invincibility + i);
+        const __m128 counting = _mm_and_ps(on, _mm_cmpgt_ps(oldInvincibility, zero));
+        _mm_storeu_ps(invincibility + i, select(counting, _mm_sub_ps(oldInvincibility, framesV), oldInvincibility));
+
+        const __m128i oldPowerUp = _mm_loadu_si128((const __m128i *)(powerUps + i));
+        const __m128 oldTimer = _mm_loadu_ps(powerUpTimer + i);
+        const __m128 hasPowerUp = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(oldPowerUp, allOnes)), on);
+        const __m128 running = _mm_and_ps(hasPowerUp, _mm_cmpgt_ps(oldTimer, zero));
+        const __m128 timer = select(running, _mm_sub_ps(oldTimer, framesV), oldTimer);
+        const __m128 expired = _mm_and_ps(running, _mm_cmple_ps(timer, zero));
+        const __m128i powerUp = _mm_or_si128(_mm_castps_si128(expired), oldPowerUp); // -1 once expired
+        _mm_storeu_si128((__m128i *)(powerUps + i), powerUp);
+        _mm_storeu_ps(powerUpTimer + i, _mm_andnot_ps(expired, timer));
+
+        const __m128 oldPipeSpeed = _mm_loadu_ps(pipeSpeed + i);
+        const __m128 oldGravity = _mm_loadu_ps(gravity + i);
+        const __m128 oldGapHeight = _mm_loadu_ps(gapHeight + i);
+        __m128 levelUp, newPipeSpeed, newGravity, newGapHeight;
+        if (timeTrial)
+        {
+            const __m128 oldElapsed = _mm_loadu_ps(timeTrialTimer + i);
+            const __m128 elapsed = select(on, _mm_add_ps(oldElapsed, _mm_set1_ps(dt)), oldElapsed);
+            _mm_storeu_ps(timeTrialTimer + i, elapsed);
+            const __m128i currentTime = _mm_cvttps_epi32(elapsed);
+            const __m128i oldIncrease = _mm_loadu_si128((const __m128i *)(lastIncrease + i));
+            const __m128i due = _mm_add_epi32(oldIncrease, _mm_set1_epi32(timeTrialInterval));
+            levelUp = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(due, currentTime)), on);
+            _mm_storeu_si128((__m128i *)(lastIncrease + i), select(_mm_castps_si128(levelUp), currentTime, oldIncrease));
+            newPipeSpeed = _mm_add_ps(oldPipeSpeed, _mm_set1_ps(timeTrialSpeedStep));
+            newGravity = _mm_add_ps(oldGravity, _mm_set1_ps(timeTrialGravityStep));
+            newGapHeight = _mm_sub_ps(oldGapHeight, _mm_set1_ps(timeTrialGapStep));
+        }
+        else
+        {
+            const __m128i atLevel = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(onLevel + i)), zeroInt);
+            levelUp = _mm_andnot_ps(_mm_castsi128_ps(atLevel), on);
+            const __m128 levelV = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(level + i)));
+            const __m128 speedIncrease = _mm_mul_ps(levelV, _mm_set1_ps(s.speedIncrease));
+            const __m128 basePipeSpeed = _mm_set1_ps(s.pipeSpeed);
+            const __m128 slow = _mm_castsi128_ps(_mm_cmpeq_epi32(powerUp, slowMotion));
+            newPipeSpeed = select(slow, _mm_add_ps(basePipeSpeed, _mm_mul_ps(speedIncrease, _mm_set1_ps(0.5f))),
+                                  _mm_add_ps(basePipeSpeed, speedIncrease));
+            newGravity = _mm_add_ps(_mm_set1_ps(s.gravity), _mm_mul_ps(levelV, _mm_set1_ps(s.gravityIncrease)));
+            newGapHeight = _mm_sub_ps(_mm_set1_ps(s.gapHeight), _mm_mul_ps(levelV, _mm_set1_ps(s.gapDecrease)));
+        }
+        newGapHeight = select(_mm_cmplt_ps(newGapHeight, minGapHeightV), minGapHeightV, newGapHeight);
+        const __m128 currentPipeSpeed = select(levelUp, newPipeSpeed, oldPipeSpeed);
+        const __m128 currentGravity = select(levelUp, newGravity, oldGravity);
+        _mm_storeu_ps(pipeSpeed + i, currentPipeSpeed);
+        _mm_storeu_ps(gravity + i, currentGravity);
+        _mm_storeu_ps(gapHeight + i, select(levelUp, newGapHeight, oldGapHeight));
+
+        const __m128 newSpeed = _mm_add_ps(ballSpeed, _mm_mul_ps(currentGravity, framesV));
+        const __m128 oldY = _mm_loadu_ps(y + i);
+        _mm_storeu_ps(speed + i, select(on, newSpeed, ballSpeed));
+        _mm_storeu_ps(y + i, select(on, _mm_sub_ps(oldY, _mm_mul_ps(newSpeed, framesV)), oldY));
+        const __m128i oldTicks = _mm_loadu_si128((const __m128i *)(ticks + i));
+        _mm_storeu_si128((__m128i *)(ticks + i), _mm_sub_epi32(oldTicks, onInt));
+        const __m128 oldSpawnTimer = _mm_loadu_ps(spawnTimer + i);
+        _mm_storeu_ps(spawnTimer + i, select(on, _mm_add_ps(oldSpawnTimer, framesV), oldSpawnTimer));
+        _mm_storeu_ps(pipeStep + i, _mm_and_ps(on, _mm_mul_ps(currentPipeSpeed, framesV)));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        if (!active[i])
+        {
+            pipeStep[i] = 0.0f; // Finished games stand still
+            continue;
+        }
+
+        if (actions[i])
+            speed[i] = jumpPower;
+        if (invincibility[i] > 0)
+            invincibility[i] -= frames;
+
+        // Only the active power-up's flag is ever set, so the type alone is the state
+        if (powerUps[i] != -1 && powerUpTimer[i] > 0)
+        {
+            powerUpTimer[i] -= frames;
+            if (powerUpTimer[i] <= 0)
+            {
+                powerUps[i] = -1;
+                powerUpTimer[i] = 0.0f;
+            }
+        }
+
+        if (timeTrial)
+        {
+            timeTrialTimer[i] += dt;
+            int currentTime = static_cast<int>(timeTrialTimer[i]);
+            if (currentTime >= lastIncrease[i] + timeTrialInterval)
+            {
+                lastIncrease[i] = currentTime;
+                pipeSpeed[i] += timeTrialSpeedStep;
+                gravity[i] += timeTrialGravityStep;
+                float newGapHeight = gapHeight[i] - timeTrialGapStep;
+                gapHeight[i] = (newGapHeight < minGapHeight) ? minGapHeight : newGapHeight;
+            }
+        }
+        else if (onLevel[i])
+        {
+            // Recomputed on every tick the score sits on a level, as step() does
+            float speedIncrease = level[i] * s.speedIncrease;
+            pipeSpeed[i] = powerUps[i] == SLOW_MOTION ? s.pipeSpeed + speedIncrease * 0.5f : s.pipeSpeed + speedIncrease;
+            gravity[i] = s.gravity + level[i] * s.gravityIncrease;
+            float newGapHeight = s.gapHeight - level[i] * s.gapDecrease;
+            gapHeight[i] = (newGapHeight < minGapHeight) ? minGapHeight : newGapHeight;
+        }
+
+        speed[i] += gravity[i] * frames;
+        y[i] -= speed[i] * frames;
+        ticks[i]++;
+        spawnTimer[i] += frames;
+        pipeStep[i] = pipeSpeed[i] * frames;
+    }
+}
+
+// Move every pipe and power-up slot, used or not, so there are no branches.
+// Pipes spawned this tick are placed after the move (see resolve()).
+void VecEnv::moveEntities()
+{
+    static_assert(MAX_PIPES % 4 == 0 && POWER_UP_SLOTS % 4 == 0, "Slots are moved four at a time");
+
+    float *pipes = pipeX.data();
+    float *powerUps = powerUpX.data();
+    const float *pipeStep = pipeSteps.data();
+    const int32_t *active = playing.data();
+    const float powerUpStep = POWER_UP_SPEED * frames;
+    const int n = count;
+    for (int i = 0; i < n; i++)
+    {
+        float *x = pipes + i * pipeSlotCount;
+        float *powerUp = powerUps + i * POWER_UP_SLOTS;
+        const float powerUpMove = active[i] ? powerUpStep : 0.0f;
+#if VEC_ENV_SSE2
+        const __m128 step = _mm_set1_ps(pipeStep[i]);
+        for (int s = 0; s < pipeSlotCount; s += 4)
+            _mm_storeu_ps(x + s, _mm_sub_ps(_mm_loadu_ps(x + s), step));
+        const __m128 move = _mm_set1_ps(powerUpMove);
+        for (int s = 0; s < POWER_UP_SLOTS; s += 4)
+            _mm_storeu_ps(powerUp + s, _mm_sub_ps(_mm_loadu_ps(powerUp + s), move));
+#else
+        for (int s = 0; s < pipeSlotCount; s++)
+            x[s] -= pipeStep[i];
+        for (int s = 0; s < POWER_UP_SLOTS; s++)
+            powerUp[s] -= powerUpMove;
+#endif
+    }
+}
+
+void VecEnv::popPipe(int env)
+{
+    float *x = &pipeX[env * pipeSlotCount];
+    float *gapY = &pipeGapY[env * pipeSlotCount];
+    int n = --pipeCounts[env];
+    std::copy(x + 1, x + 1 + n, x);
+    std::copy(gapY + 1, gapY + 1 + n, gapY);
+}
+
+void VecEnv::loseLife(int env)
+{
+    lives[env]--;
+    if (lives[env] <= 0)
+    {
+        playing[env] = 0;
+        return;
+    }
+
+    ballY[env] = WINDOW_HEIGHT / 2;
+    ballSpeed[env] = 0;
+    invincibilityTimers[env] = INVINCIBILITY_DURATION;
+    while (pipeCounts[env] > 0 && pipeX[env * pipeSlotCount] < WINDOW_WIDTH / 2)
+        popPipe(env);
+}
+
+// The rest of step() for one running game: spawns, removals, pick-ups and
+// collisions, in step()'s order
+void VecEnv::resolve(int env)
+{
+    const float pipeStep = pipeSteps[env];
+    const int pipeBase = env * pipeSlotCount;
+    const int powerUpBase = env * POWER_UP_SLOTS;
+    const float y = ballY[env];
+
+    // Spawn at the right edge, then apply this tick's move like the others.
+    // The random numbers are drawn even when the pipe does not fit.
+    if (spawnTimers[env] >= 100.0f)
+    {
+        spawnTimers[env] -= 100.0f;
+
+        Rng &rng = rngs[env];
+        float gapY = rng.below(WINDOW_HEIGHT - (int)gapHeights[env] - 100) + 50;
+        if (pipeCounts[env] < pipeSlotCount)
+        {
+            int slot = pipeBase + pipeCounts[env]++;
+            float x = WINDOW_WIDTH;
+            pipeX[slot] = x - pipeStep;
+            pipeGapY[slot] = gapY;
+        }
+
+        if (rng.below(5) == 0)
+        {
+            int slot = powerUpBase + powerUpCounts[env]++;
+            float x = WINDOW_WIDTH;
+            powerUpX[slot] = x - POWER_UP_SPEED * frames;
+            powerUpY[slot] = rng.below(WINDOW_HEIGHT - 100) + 50;
+            powerUpTypes[slot] = rng.below(3);
+        }
+    }
+
+    while (pipeCounts[env] > 0 && pipeX[pipeBase] + PIPE_WIDTH < 0)
+        popPipe(env);
+
+    // Power-ups are sorted by x too: only the leftmost can have left the
+    // screen, and only those short of BALL_X + reach can touch the ball
+    const float reach = ballRadius + POWER_UP_RADIUS;
+    int s = 0;
+    while (s < powerUpCounts[env] && powerUpX[powerUpBase + s] < BALL_X + reach)
+    {
+        int slot = powerUpBase + s;
+        float dx = BALL_X - powerUpX[slot];
+        float dy = y - powerUpY[slot];
+        bool touched = dx * dx + dy * dy < reach * reach;
+        if (touched)
+        {
+            powerUpTimers[env] = tuning.powerUpDuration;
+            activePowerUps[env] = powerUpTypes[slot];
+        }
+        if (touched || powerUpX[slot] + POWER_UP_RADIUS < 0)
+        {
+            int last = powerUpBase + --powerUpCounts[env];
+            std::copy(&powerUpX[slot + 1], &powerUpX[last + 1], &powerUpX[slot]);
+            std::copy(&powerUpY[slot + 1], &powerUpY[last + 1], &powerUpY[slot]);
+            std::copy(&powerUpTypes[slot + 1], &powerUpTypes[last + 1], &powerUpTypes[slot]);
+        }
+        else
+        {
+            s++;
+        }
+    }
+
+    // Same pipes as step()'s broadphase, in the same order, so a game over
+    // part way through scores and collides exactly like it does
+    const int scoreBefore = scores[env];
+    const float minX = BALL_X - PIPE_WIDTH - (std::max(pipeStep, ballRadius) + 1.0f);
+    int first = 0;
+    while (first < pipeCounts[env] && pipeX[pipeBase + first] < minX)
+        first++;
+    for (int p = first; p < pipeCounts[env] && pipeX[pipeBase + p] < BALL_X + ballRadius; p++)
+    {
+        Pipe pipe = {pipeX[pipeBase + p], pipeGapY[pipeBase + p], 0.0f};
+        if (activePowerUps[env] != SHIELD && ballHitsPipe(ballY[env], pipe, gapHeights[env]))
+        {
+            loseLife(env);
+            if (playing[env])
+                break;
+        }
+
+        if (pipe.x + PIPE_WIDTH < BALL_X && pipe.x + PIPE_WIDTH + pipeStep >= BALL_X)
+            scores[env] += activePowerUps[env] == DOUBLE_POINTS ? 2 : 1;
+    }
+
+    if (ballY[env] < 0 || ballY[env] + 30 > WINDOW_HEIGHT)
+        loseLife(env);
+
+    if (scores[env] != scoreBefore)
+    {
+        levels[env] = scores[env] / tuning.difficultyInterval;
+        onLevels[env] = scores[env] > 0 && scores[env] % tuning.difficultyInterval == 0;
+    }
+}
+
+void VecEnv::step(const uint8_t *actions, float *observations, float *rewards, uint8_t *dones)
+{
+    PROFILE_ZONE("VecEnv::step");
+
+    if (mode == MODE_TIME_TRIAL)
+        advance<true>(actions);
+    else
+        advance<false>(actions);
+    moveEntities();
+
+    for (int i = 0; i < count; i++)
+    {
+        // Rewards come from the change in score and lives; a game that ends
+        // this tick still gets its reward
+        float reward = 0.0f;
+        if (playing[i])
+        {
+            int scoreBefore = scores[i], livesBefore = lives[i];
+            resolve(i);
+            reward = static_cast<float>((scores[i] - scoreBefore) - (livesBefore - lives[i]));
+        }
+        if (rewards)
+            rewards[i] = reward;
+        if (dones)
+            dones[i] = playing[i] ? 0 : 1;
+        if (observations)
+            observe(i, observations + i * OBSERVATION_SIZE);
+    }
+}
+
+void VecEnv::observe(float *observations) const
+{
+    for (int i = 0; i < count; i++)
+        observe(i, observations + i * OBSERVATION_SIZE);
+}
+
+void VecEnv::observe(int env, float *out) const
+{
+    const float toHeight = 1.0f / WINDOW_HEIGHT, toWidth = 1.0f / WINDOW_WIDTH;
+    const float gap = gapHeights[env] * toHeight;
+
+    // The first two pipes the ball has not passed (same test as scriptedPolicy)
+    float dx[2] = {1.0f, 1.0f};
+    float gapBottom[2];
+    gapBottom[0] = gapBottom[1] = 0.5f - gap * 0.5f;
+    const int base = env * pipeSlotCount;
+    int found = 0;
+    for (int s = 0; s < pipeCounts[env] && found < 2; s++)
+    {
+        float right = pipeX[base + s] + PIPE_WIDTH;
+        if (right < BALL_X - ballRadius)
+            continue;
+        dx[found] = (right - BALL_X) * toWidth;
+        gapBottom[found] = pipeGapY[base + s] * toHeight;
+        found++;
+    }
+
+    out[OBS_BALL_Y] = ballY[env] * toHeight;
+    out[OBS_BALL_SPEED] = ballSpeed[env] * 0.1f;
+    out[OBS_PIPE_DX] = dx[0];
+    out[OBS_PIPE_GAP_BOTTOM] = gapBottom[0];
+    out[OBS_PIPE_GAP_TOP] = gapBottom[0] + gap;
+    out[OBS_NEXT_PIPE_DX] = dx[1];
+    out[OBS_NEXT_PIPE_GAP_BOTTOM] = gapBottom[1];
+    out[OBS_SHIELD] = activePowerUps[env] == SHIELD ? 1.0f : 0.0f;
+    out[OBS_LIVES] = lives[env] * (1.0f / INITIAL_LIVES);
+}
+
+void VecEnv::copyToWorld(int env, World &world) const
+{
+    world.tuning = tuning;
+    world.tickRate = tickRate;
+    world.seed = seeds[env];
+    world.levelFeed = nullptr; // VecEnv only plays the classic spawns
+    resetWorld(world, mode);
+
+    world.state = playing[env] ? PLAYING : GAME_OVER;
+    world.rng = rngs[env];
+    world.ballY = world.prevBallY = ballY[env];
+    world.ballSpeed = ballSpeed[env];
+    world.score = scores[env];
+    world.lives = lives[env];
+    world.invincibilityTimer = invincibilityTimers[env];
+    world.tickCount = tickCounts[env];
+    world.spawnTimer = spawnTimers[env];
+    world.activePowerUp = activePowerUps[env];
+    world.hasShield = world.activePowerUp == SHIELD;
+    world.hasSlowMotion = world.activePowerUp == SLOW_MOTION;
+    world.hasDoublePoints = world.activePowerUp == DOUBLE_POINTS;
+    world.powerUpTimer = powerUpTimers[env];
+    world.currentPipeSpeed = pipeSpeeds[env];
+    world.currentGapHeight = gapHeights[env];
+    world.currentGravity = gravities[env];
+    world.timeTrialTimer = timeTrialTimers[env];
+    world.lastDifficultyIncrease = lastDifficultyIncreases[env];
+
+    for (int s = 0; s < pipeCounts[env]; s++)
+    {
+        float x = pipeX[env * pipeSlotCount + s];
+        world.pipes.push_back(Pipe{x, pipeGapY[env * pipeSlotCount + s], x});
+    }
+    for (int s = 0; s < powerUpCounts[env]; s++)
+    {
+        int slot = env * POWER_UP_SLOTS + s;
+        world.powerUps.add(Scroll{powerUpX[slot], powerUpX[slot], POWER_UP_SPEED}, PowerUpBody{powerUpY[slot], powerUpTypes[slot]});
+    }
+}
@@ -0,0 +1,149 @@
+#include "work_stealing_pool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    queues = std::vector<WorkerQueue>(threadCount);
+    threads.reserve(threadCount);
+    for (int w = 0; w < threadCount; w++)
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, w);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobStarted.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void WorkStealingPool::parallelFor(int count, const std::function<void(int, int)> &task, int grain)
+{
+    if (count <= 0)
+        return;
+
+    // Deal out one contiguous block per worker; stealing evens out the rest
+    int workers = threadCount();
+    for (int w = 0; w < workers; w++)
+    {
+        int begin = static_cast<int>(static_cast<long long>(count) * w / workers);
+        int end = static_cast<int>(static_cast<long long>(count) * (w + 1) / workers);
+        if (begin < end)
+        {
+            std::lock_guard<std::mutex> lock(queues[w].mutex);
+            queues[w].ranges.push_back(Range{begin, end});
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    job = &task;
+    jobGrain = grain > 0 ? grain : 1;
+    activeWorkers = workers;
+    jobGeneration++;
+    jobStarted.notify_all();
+
+    // Wait for every worker to leave the job, not just for the last index, so
+    // `task` is not referenced after we return
+    jobFinished.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+bool WorkStealingPool::popLocal(int worker, Range &range)
+{
+    WorkerQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty())
+        return false;
+
+    // Take one grain off the newest range and leave the remainder in place
+    Range &back = queue.ranges.back();
+    range.begin = back.begin;
+    range.end = back.end - back.begin > jobGrain ? back.begin + jobGrain : back.end;
+    back.begin = range.end;
+    if (back.begin == back.end)
+        queue.ranges.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int worker, Range &range)
+{
+    int workers = threadCount();
+    for (int offset = 1; offset < workers; offset++)
+    {
+        WorkerQueue &victim = queues[(worker + offset) % workers];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if (victim.ranges.empty())
+            continue;
+
+        // Steal the upper half of the oldest range, or all of it if it is small
+        Range loot;
+        Range &front = victim.ranges.front();
+        if (front.end - front.begin > jobGrain)
+        {
+            int mid = front.begin + (front.end - front.begin) / 2;
+            loot.begin = mid;
+            loot.end = front.end;
+            front.end = mid;
+        }
+        else
+        {
+            loot = front;
+            victim.ranges.pop_front();
+        }
+        lock.unlock();
+
+        // Run the first grain right away: the loot passes through no deque
+        // before we hold some of it, so another thief cannot take it all
+        range.begin = loot.begin;
+        range.end = loot.end - loot.begin > jobGrain ? loot.begin + jobGrain : loot.end;
+        loot.begin = range.end;
+
+        // Keep the rest in our own deque so others can steal from it in turn
+        if (loot.begin != loot.end)
+        {
+            std::lock_guard<std::mutex> ownLock(queues[worker].mutex);
+            queues[worker].ranges.push_back(loot);
+        }
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker)
+{
+    unsigned long seenGeneration = 0;
+    for (;;)
+    {
+        const std::function<void(int, int)> *task;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStarted.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = jobGeneration;
+            task = job;
+        }
+
+        // No work is added once a job starts, so when neither our own deque
+        // nor any victim has a range left, everything is already being run
+        Range range;
+        while (popLocal(worker, range) || steal(worker, range))
+        {
+            for (int i = range.begin; i < range.end; i++)
+                (*task)(i, worker);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (--activeWorkers == 0)
+                jobFinished.notify_one();
+        }
+    }
+}
@@ -0,0 +1,600 @@
+#include "world.h"
+#include "circle_geometry.h"
+#include "level_generator.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Particle directions: evenly spaced for explosions, whole degrees for bursts
+constexpr CircleTable<EXPLOSION_PARTICLE_COUNT> explosionDirections = makeCircleTable<EXPLOSION_PARTICLE_COUNT>();
+constexpr CircleTable<360> degreeDirections = makeCircleTable<360>();
+
+// Settings used while no mode is selected (menu background)
+static const DifficultySettings defaultSettings = {
+    PIPE_SPEED, GAP_HEIGHT, GRAVITY, 100, SPEED_INCREASE, GAP_DECREASE, GRAVITY_INCREASE};
+
+static void clearActivePowerUp(World &world)
+{
+    switch (world.activePowerUp)
+    {
+    case SHIELD:
+        world.hasShield = false;
+        break;
+    case SLOW_MOTION:
+        world.hasSlowMotion = false;
+        break;
+    case DOUBLE_POINTS:
+        world.hasDoublePoints = false;
+        break;
+    }
+    world.activePowerUp = -1;
+}
+
+// Function to handle losing a life
+static void loseLife(World &world)
+{
+    world.lives--;
+    if (world.lives <= 0)
+    {
+        world.state = GAME_OVER;
+        world.events |= EVENT_GAME_OVER;
+    }
+    else
+    {
+        // Reset ball position and give temporary invincibility
+        world.ballY = WINDOW_HEIGHT / 2;
+        world.prevBallY = world.ballY;
+        world.ballSpeed = 0;
+        world.invincibilityTimer = INVINCIBILITY_DURATION;
+        world.events |= EVENT_LIFE_LOST;
+
+        // Clear nearby obstacles (the pipes are sorted, so that is a prefix)
+        while (!world.pipes.empty() && world.pipes.front().x < WINDOW_WIDTH / 2)
+            world.pipes.pop_front();
+    }
+}
+
+void resetWorld(World &world, GameMode mode)
+{
+    resetWorld(world, mode, mode != MODE_MENU ? world.tuning.modes[mode - 1] : defaultSettings);
+}
+
+void resetWorld(World &world, GameMode mode, const DifficultySettings &settings)
+{
+    world.mode = mode;
+    world.state = mode != MODE_MENU ? PLAYING : MENU;
+    world.settings = settings;
+
+    // Reset ball state
+    world.ballY = WINDOW_HEIGHT / 2;
+    world.prevBallY = world.ballY;
+    world.ballSpeed = 0;
+
+    // Reset game progress
+    world.score = 0;
+    world.lives = INITIAL_LIVES;
+    world.invincibilityTimer = 0;
+    world.timeTrialTimer = 0.0f;
+    world.lastDifficultyIncrease = 0;
+    world.tickCount = 0;
+    world.spawnTimer = 0.0f;
+
+    // Clear game objects
+    world.pipes.clear();
+    world.powerUps.clear();
+    world.particles.clear();
+
+    // Reset power-up states
+    world.hasShield = false;
+    world.hasSlowMotion = false;
+    world.hasDoublePoints = false;
+    world.powerUpTimer = 0;
+    world.activePowerUp = -1;
+
+    // Set initial difficulty
+    world.currentPipeSpeed = settings.pipeSpeed;
+    world.currentGapHeight = settings.gapHeight;
+    world.currentGravity = settings.gravity;
+    world.currentSpawnInterval = settings.spawnInterval;
+
+    world.events = 0;
+
+    world.rng.reseed(world.seed, 1);
+    world.fxRng.reseed(world.seed, 2);
+    if (world.levelFeed && mode != MODE_MENU)
+    {
+        world.levelFeed->restart(world.seed, mode, settings, world.tuning);
+        world.nextSpawn = world.levelFeed->next();
+    }
+
+    // Initialize visual effects
+    initClouds(world);
+}
+
+void applyTuning(World &world, const Tuning &tuning)
+{
+    const Tuning previous = world.tuning;
+    world.tuning = tuning;
+    if (world.mode == MODE_MENU)
+        return;
+
+    const DifficultySettings &before = previous.modes[world.mode - 1];
+    world.settings = tuning.modes[world.mode - 1];
+    const DifficultySettings &settings = world.settings;
+    world.currentSpawnInterval = settings.spawnInterval;
+    world.powerUpTimer = std::min(world.powerUpTimer, static_cast<float>(tuning.powerUpDuration));
+
+    // Level reached and how much of a level's increments it applies
+    bool timeTrial = world.mode == MODE_TIME_TRIAL;
+    float level, speedScale, gravityScale, gapScale;
+    bool levelChanged;
+    if (timeTrial)
+    {
+        level = static_cast<float>(world.lastDifficultyIncrease / tuning.timeTrialInterval);
+        speedScale = tuning.timeTrialSpeedScale;
+        gravityScale = tuning.timeTrialGravityScale;
+        gapScale = tuning.timeTrialGapScale;
+        levelChanged = tuning.timeTrialInterval != previous.timeTrialInterval;
+    }
+    else
+    {
+        level = static_cast<float>(world.score / tuning.difficultyInterval);
+        speedScale = gravityScale = gapScale = 1.0f;
+        levelChanged = tuning.difficultyInterval != previous.difficultyInterval;
+    }
+
+    // Rebuild each current value whose inputs changed, as if the game had been
+    // played with the new values up to the same level. The others stay as
+    // they are: the speed may carry a slow-motion discount from the last
+    // level-up that cannot be reconstructed.
+    if (levelChanged || settings.pipeSpeed != before.pipeSpeed || settings.speedIncrease != before.speedIncrease ||
+        (timeTrial && tuning.timeTrialSpeedScale != previous.timeTrialSpeedScale))
+    {
+        world.currentPipeSpeed = settings.pipeSpeed + level * settings.speedIncrease * speedScale;
+    }
+    if (levelChanged || settings.gravity != before.gravity || settings.gravityIncrease != before.gravityIncrease ||
+        (timeTrial && tuning.timeTrialGravityScale != previous.timeTrialGravityScale))
+    {
+        world.currentGravity = settings.gravity + level * settings.gravityIncrease * gravityScale;
+    }
+    if (levelChanged || settings.gapHeight != before.gapHeight || settings.gapDecrease != before.gapDecrease ||
+        tuning.minGapHeight != previous.minGapHeight ||
+        (timeTrial && tuning.timeTrialGapScale != previous.timeTrialGapScale))
+    {
+        float gapHeight = settings.gapHeight - level * settings.gapDecrease * gapScale;
+        world.currentGapHeight = gapHeight < tuning.minGapHeight ? tuning.minGapHeight : gapHeight;
+    }
+
+    // Generated spawns were checked against the old values: generate the
+    // rest of the game again, from the spawn that is next (already taken
+    // from the feed) on, reachable from the last pipe spawned
+    if (world.levelFeed)
+    {
+        int nextSpawn = std::max(0, world.levelFeed->handedOut() - 1);
+        float previousGapY = world.pipes.empty() ? -1.0f : world.pipes.back().gapY;
+        world.levelFeed->restart(world.seed, world.mode, settings, tuning, nextSpawn, previousGapY);
+        world.nextSpawn = world.levelFeed->next();
+    }
+}
+
+// frames is the number of base-rate frames covered by this step
+static void updateClouds(World &world, float frames)
+{
+    PROFILE_ZONE("updateClouds");
+
+    scrollEntities(world.clouds, frames);
+
+    // Clouds that left the screen come back on the right with a new look
+    Scroll *scroll = world.clouds.column<Scroll>();
+    CloudBody *body = world.clouds.column<CloudBody>();
+    for (int i = 0; i < world.clouds.size(); i++)
+    {
+        if (scroll[i].x + 100 < 0)
+        {
+            scroll[i].x = WINDOW_WIDTH + 100;
+            scroll[i].prevX = scroll[i].x;
+            body[i].y = world.fxRng.below(WINDOW_HEIGHT / 2);
+            body[i].scale = 0.5f + world.fxRng.below(100) / 100.0f;
+        }
+    }
+}
+
+// Generated levels: the entry was prepared ahead of time by the level feed
+static void spawnGenerated(World &world, float frames)
+{
+    const float interval = static_cast<float>(world.currentSpawnInterval);
+    world.spawnTimer += frames;
+    if (world.spawnTimer < interval)
+        return;
+    world.spawnTimer -= interval;
+
+    const SpawnEntry &entry = world.nextSpawn;
+    Pipe newPipe;
+    newPipe.x = WINDOW_WIDTH;
+    newPipe.prevX = newPipe.x;
+    newPipe.gapY = spawnGapY(entry, world.currentGapHeight);
+    world.pipes.push_back(newPipe);
+
+    if (entry.powerUpType >= 0)
+        world.powerUps.add(Scroll{WINDOW_WIDTH, WINDOW_WIDTH, POWER_UP_SPEED}, PowerUpBody{entry.powerUpY, entry.powerUpType});
+
+    world.nextSpawn = world.levelFeed->next();
+}
+
+static void spawnObstacles(World &world, float frames)
+{
+    PROFILE_ZONE("spawnObstacles");
+
+    if (world.levelFeed)
+    {
+        spawnGenerated(world, frames);
+        return;
+    }
+
+    // Add new pipe every 100 frames
+    world.spawnTimer += frames;
+    if (world.spawnTimer >= 100.0f)
+    {
+        world.spawnTimer -= 100.0f;
+
+        Pipe newPipe;
+        newPipe.x = WINDOW_WIDTH;
+        newPipe.prevX = newPipe.x;
+        newPipe.gapY = world.rng.below(WINDOW_HEIGHT - (int)world.currentGapHeight - 100) + 50;
+        world.pipes.push_back(newPipe);
+
+        // 20% chance to spawn a power-up
+        if (world.rng.below(5) == 0)
+        {
+            PowerUpBody body;
+            body.y = world.rng.below(WINDOW_HEIGHT - 100) + 50;
+            body.type = world.rng.below(3); // Random power-up type
+            world.powerUps.add(Scroll{WINDOW_WIDTH, WINDOW_WIDTH, POWER_UP_SPEED}, body);
+        }
+    }
+}
+
+static void movePipes(World &world, float pipeStep)
+{
+    PROFILE_ZONE("movePipes");
+
+    // Move pipes
+    for (auto &pipe : world.pipes)
+    {
+        pipe.prevX = pipe.x;
+        pipe.x -= pipeStep;
+    }
+
+    // Remove off-screen pipes
+    while (!world.pipes.empty() && world.pipes.front().x + PIPE_WIDTH < 0)
+        world.pipes.pop_front();
+}
+
+// Activate a power-up the ball picked up
+static void collectPowerUp(World &world, int type)
+{
+    // Deactivate any existing power-up
+    clearActivePowerUp(world);
+
+    // Activate new power-up
+    world.powerUpTimer = world.tuning.powerUpDuration;
+    world.activePowerUp = type;
+
+    switch (type)
+    {
+    case SHIELD:
+        world.hasShield = true;
+        addParticles(world, BALL_X, world.ballY, 0.0f, 0.0f, 1.0f); // Blue particles for shield
+        break;
+    case SLOW_MOTION:
+        world.hasSlowMotion = true;
+        addParticles(world, BALL_X, world.ballY, 0.0f, 1.0f, 0.0f); // Green particles for slow motion
+        break;
+    case DOUBLE_POINTS:
+        world.hasDoublePoints = true;
+        addParticles(world, BALL_X, world.ballY, 1.0f, 1.0f, 0.0f); // Yellow particles for double points
+        break;
+    }
+    world.events |= EVENT_POWERUP;
+}
+
+static void updatePowerUps(World &world, float frames)
+{
+    PROFILE_ZONE("updatePowerUps");
+
+    scrollEntities(world.powerUps, frames);
+
+    // Collision with the ball, then lifetime: power-ups leave the table when
+    // picked up or off screen
+    const Scroll *scroll = world.powerUps.column<Scroll>();
+    const PowerUpBody *body = world.powerUps.column<PowerUpBody>();
+    world.powerUps.removeIf([&](int i) {
+        bool touched = world.sweptCollisions ? sweepBallPowerUp(world.prevBallY, world.ballY, scroll[i], body[i].y) >= 0.0f
+                                             : ballTouchesPowerUp(world.ballY, scroll[i].x, body[i].y);
+        if (touched)
+        {
+            collectPowerUp(world, body[i].type);
+            return true;
+        }
+        return scroll[i].x + POWER_UP_RADIUS < 0;
+    });
+}
+
+// Part [t0, t1] of the step during which lo < a + b * t < hi. Whether the
+// bounds themselves count is left to the end-of-step tests.
+static bool linearSpan(float a, float b, float lo, float hi, float &t0, float &t1)
+{
+    t0 = 0.0f;
+    t1 = 1.0f;
+    if (lo >= hi)
+        return false;
+    if (b == 0.0f)
+        return lo < a && a < hi;
+    float enter = (lo - a) / b;
+    float leave = (hi - a) / b;
+    if (enter > leave)
+        std::swap(enter, leave);
+    t0 = std::max(t0, enter);
+    t1 = std::min(t1, leave);
+    return t0 < t1;
+}
+
+float sweepBallPipe(float prevBallY, float ballY, const Pipe &pipe, float gapHeight)
+{
+    // The ball's box overlaps the pipe horizontally during [across0, across1]
+    // and fits the gap vertically during [inGap0, inGap1]; it hits at the
+    // first overlapping moment outside the gap
+    float toi = -1.0f;
+    float across0, across1, inGap0, inGap1;
+    if (linearSpan(pipe.prevX, pipe.x - pipe.prevX, BALL_X - ballRadius - PIPE_WIDTH, BALL_X + ballRadius, across0, across1))
+    {
+        bool fits = linearSpan(prevBallY, ballY - prevBallY, pipe.gapY + ballRadius, pipe.gapY + gapHeight - ballRadius,
+                               inGap0, inGap1);
+        if (!fits || across0 < inGap0 || across0 > inGap1)
+            toi = across0;
+        else if (inGap1 < across1)
+            toi = inGap1;
+    }
+    if (toi < 0.0f && ballHitsPipe(ballY, pipe, gapHeight))
+        toi = 1.0f;
+    return toi;
+}
+
+float sweepBallPowerUp(float prevBallY, float ballY, const Scroll &powerUp, float powerUpY)
+{
+    // Offset from the power-up to the ball is d + v * t; solve |d + v t| = reach
+    float dx = BALL_X - powerUp.prevX;
+    float dy = prevBallY - powerUpY;
+    float vx = powerUp.prevX - powerUp.x;
+    float vy = ballY - prevBallY;
+    float reach = ballRadius + POWER_UP_RADIUS;
+
+    float c = dx * dx + dy * dy - reach * reach;
+    if (c < 0.0f)
+        return 0.0f;
+    float a = vx * vx + vy * vy;
+    float halfB = dx * vx + dy * vy;
+    float discriminant = halfB * halfB - a * c;
+    if (halfB < 0.0f && discriminant > 0.0f)
+    {
+        float t = (-halfB - std::sqrt(discriminant)) / a;
+        if (t <= 1.0f)
+            return t;
+    }
+    return ballTouchesPowerUp(ballY, powerUp.x, powerUpY) ? 1.0f : -1.0f;
+}
+
+// pipeStep is how far the pipes moved this step (for scoring)
+static void checkCollisions(World &world, float pipeStep)
+{
+    PROFILE_ZONE("checkCollisions");
+
+    // Broadphase: only pipes that overlap the ball column or crossed behind
+    // it this step can collide or score. The queue is sorted by x, so they
+    // form a short run starting at the binary-searched index (1 px of slack
+    // keeps rounding from dropping a pipe the exact tests below would accept).
+    // A swept test also reaches pipes that crossed the whole column.
+    float reach = (world.sweptCollisions ? pipeStep + ballRadius : std::max(pipeStep, ballRadius)) + 1.0f;
+    int first = world.pipes.lowerBound(BALL_X - PIPE_WIDTH - reach);
+
+    // Check collisions and score
+    for (int i = first; i < world.pipes.size() && world.pipes[i].x < BALL_X + ballRadius; i++)
+    {
+        const Pipe &pipe = world.pipes[i];
+
+        // Where the ball was when it hit
+        float impactY = world.ballY;
+        bool hit = false;
+        if (!world.hasShield && world.sweptCollisions)
+        {
+            float toi = sweepBallPipe(world.prevBallY, world.ballY, pipe, world.currentGapHeight);
+            hit = toi >= 0.0f;
+            impactY = interpolate(world.prevBallY, world.ballY, toi);
+        }
+        else if (!world.hasShield)
+        {
+            hit = ballHitsPipe(world.ballY, pipe, world.currentGapHeight);
+        }
+
+        if (hit)
+        {
+            // Create red explosion effect on impact
+            createExplosionEffect(world, BALL_X, impactY, 1.0f, 0.2f, 0.2f);
+            loseLife(world);
+
+            // Losing a life clears every pipe near the ball, so nothing
+            // left in the list can collide or score this tick
+            if (world.state == PLAYING)
+                break;
+        }
+
+        // Score update
+        if (pipe.x + PIPE_WIDTH < BALL_X && pipe.x + PIPE_WIDTH + pipeStep >= BALL_X)
+        {
+            world.score += world.hasDoublePoints ? 2 : 1;
+            // Create golden score effect
+            createScoreEffect(world, BALL_X, world.ballY);
+            world.events |= EVENT_SCORE;
+        }
+    }
+
+    if (world.ballY < 0 || world.ballY + 30 > WINDOW_HEIGHT)
+    {
+        // Create red explosion effect on boundary collision
+        createExplosionEffect(world, BALL_X, world.ballY, 1.0f, 0.2f, 0.2f);
+        loseLife(world);
+    }
+}
+
+void step(World &world, const Input &input)
+{
+    PROFILE_ZONE("step");
+
+    world.events = 0;
+    if (world.state != PLAYING)
+    {
+        return;
+    }
+
+    // Tuning values are per 60 Hz frame; scale them to the length of this step
+    const float dt = 1.0f / world.tickRate;
+    const float frames = (float)BASE_TICK_RATE / world.tickRate;
+
+    world.prevBallY = world.ballY;
+
+    if (input.jump)
+    {
+        world.ballSpeed = world.tuning.jumpPower;
+        // Add jump particles
+        addParticles(world, BALL_X, world.ballY, 1.0f, 1.0f, 1.0f); // White particles for jumping
+        world.events |= EVENT_JUMP;
+    }
+
+    // Update visual effects
+    updateClouds(world, frames);
+    world.particles.update(frames);
+
+    // Update invincibility timer
+    if (world.invincibilityTimer > 0)
+    {
+        world.invincibilityTimer -= frames;
+    }
+
+    // Update power-up timer
+    if (world.activePowerUp != -1 && world.powerUpTimer > 0)
+    {
+        world.powerUpTimer -= frames;
+        if (world.powerUpTimer <= 0)
+        {
+            clearActivePowerUp(world);
+            world.powerUpTimer = 0;
+        }
+    }
+
+    const DifficultySettings &settings = world.settings;
+    const Tuning &tuning = world.tuning;
+
+    // Update Time Trial timer and difficulty
+    if (world.mode == MODE_TIME_TRIAL)
+    {
+        world.timeTrialTimer += dt;
+
+        // Increase difficulty every 30 seconds (by default)
+        int currentTime = static_cast<int>(world.timeTrialTimer);
+        if (currentTime >= world.lastDifficultyIncrease + tuning.timeTrialInterval)
+        {
+            world.lastDifficultyIncrease = currentTime;
+
+            // Use gentler difficulty scaling (half speed, 30% gravity and 70% gap steps by default)
+            world.currentPipeSpeed += settings.speedIncrease * tuning.timeTrialSpeedScale;
+            world.currentGravity += settings.gravityIncrease * tuning.timeTrialGravityScale;
+            float newGapHeight = world.currentGapHeight - (settings.gapDecrease * tuning.timeTrialGapScale);
+            world.currentGapHeight = (newGapHeight < tuning.minGapHeight) ? tuning.minGapHeight : newGapHeight;
+            world.events |= EVENT_DIFFICULTY_UP;
+        }
+    }
+    // Update difficulty based on score for other modes
+    else if (world.score > 0 && world.score % tuning.difficultyInterval == 0)
+    {
+        int level = world.score / tuning.difficultyInterval;
+        float speedIncrease = level * settings.speedIncrease;
+        world.currentPipeSpeed = world.hasSlowMotion ? settings.pipeSpeed + speedIncrease * 0.5f : // Half speed if slow motion is active
+                                     settings.pipeSpeed + speedIncrease;
+        world.currentGravity = settings.gravity + level * settings.gravityIncrease;
+        float newGapHeight = settings.gapHeight - level * settings.gapDecrease;
+        world.currentGapHeight = (newGapHeight < tuning.minGapHeight) ? tuning.minGapHeight : newGapHeight;
+    }
+
+    world.ballSpeed += world.currentGravity * frames;
+    world.ballY -= world.ballSpeed * frames;
+
+    world.tickCount++;
+    spawnObstacles(world, frames);
+
+    const float pipeStep = world.currentPipeSpeed * frames;
+    movePipes(world, pipeStep);
+    updatePowerUps(world, frames);
+    checkCollisions(world, pipeStep);
+}
+
+void initClouds(World &world)
+{
+    world.clouds.clear();
+    for (int i = 0; i < MAX_CLOUDS; i++)
+    {
+        Scroll scroll;
+        CloudBody body;
+        scroll.x = world.fxRng.below(WINDOW_WIDTH);
+        body.y = world.fxRng.below(WINDOW_HEIGHT / 2);
+        body.scale = 0.5f + world.fxRng.below(100) / 100.0f;
+        scroll.speed = CLOUD_MIN_SPEED + world.fxRng.below(100) * (CLOUD_MAX_SPEED - CLOUD_MIN_SPEED) / 100.0f;
+        scroll.prevX = scroll.x;
+        world.clouds.add(scroll, body);
+    }
+}
+
+// Function to create an explosion effect
+void createExplosionEffect(World &world, float x, float y, float r, float g, float b)
+{
+    for (int i = 0; i < EXPLOSION_PARTICLE_COUNT; i++)
+    {
+        // Create a circular explosion pattern
+        world.particles.spawn(x, y,
+                              explosionDirections.cosv[i] * EXPLOSION_SPEED,
+                              explosionDirections.sinv[i] * EXPLOSION_SPEED,
+                              r, g, b);
+    }
+}
+
+// Function to create score collection effect
+void createScoreEffect(World &world, float x, float y)
+{
+    for (int i = 0; i < SCORE_PARTICLE_COUNT; i++)
+    {
+        if (!world.particles.full())
+        {
+            // Create upward moving particles
+            float angle = (PI / 4.0f) + (PI / 2.0f) * world.fxRng.unit(); // Spread between 45 and 135 degrees
+            float speed = PARTICLE_SPEED * (0.5f + world.fxRng.unit());   // Random speed variation
+            // Gold color with slight variation
+            float g = 0.8f + world.fxRng.unit() * 0.2f;
+            world.particles.spawn(x, y, cos(angle) * speed, sin(angle) * speed, 1.0f, g, 0.0f);
+        }
+    }
+}
+
+void addParticles(World &world, float x, float y, float r, float g, float b)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        if (!world.particles.full())
+        {
+            int degrees = world.fxRng.below(360);
+            world.particles.spawn(x, y,
+                                  degreeDirections.cosv[degrees] * PARTICLE_SPEED,
+                                  degreeDirections.sinv[degrees] * PARTICLE_SPEED,
+                                  r, g, b);
+        }
+    }
+}
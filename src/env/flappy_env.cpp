@@ -0,0 +1,87 @@
+// C interface to VecEnv, built as the flappy-env shared library
+#include "flappy_env.h"
+#include "tuning.h"
+#include "vec_env.h"
+
+#include <new>
+#include <stdio.h>
+#include <string>
+
+static_assert(FLAPPY_ENV_OBSERVATION_SIZE == OBSERVATION_SIZE, "C and C++ observation sizes differ");
+
+struct FlappyEnv
+{
+    VecEnv env;
+
+    FlappyEnv(int count, GameMode mode, int tickRate, const Tuning &tuning) : env(count, mode, tickRate, tuning) {}
+};
+
+FlappyEnv *flappy_env_create(int count, int mode, int tick_rate, const char *tuning_path)
+{
+    if (tick_rate == 0)
+        tick_rate = BASE_TICK_RATE;
+    if (count <= 0 || mode < MODE_EASY || mode > MODE_TIME_TRIAL || tick_rate < 1)
+    {
+        fprintf(stderr, "flappy_env_create: bad arguments (count %d, mode %d, tick rate %d)\n", count, mode, tick_rate);
+        return nullptr;
+    }
+
+    Tuning tuning = DEFAULT_TUNING;
+    std::string error;
+    if (tuning_path && !loadTuning(tuning, tuning_path, error))
+    {
+        fprintf(stderr, "flappy_env_create: %s\n", error.c_str());
+        return nullptr;
+    }
+
+    // No exceptions across the C boundary
+    try
+    {
+        return new FlappyEnv(count, static_cast<GameMode>(mode), tick_rate, tuning);
+    }
+    catch (const std::bad_alloc &)
+    {
+        fprintf(stderr, "flappy_env_create: out of memory for %d environments\n", count);
+        return nullptr;
+    }
+}
+
+void flappy_env_destroy(FlappyEnv *env)
+{
+    delete env;
+}
+
+int flappy_env_size(const FlappyEnv *env)
+{
+    return env->env.size();
+}
+
+void flappy_env_reset(FlappyEnv *env, const uint64_t *seeds)
+{
+    env->env.reset(seeds);
+}
+
+void flappy_env_reset_one(FlappyEnv *env, int index, uint64_t seed)
+{
+    env->env.reset(index, seed);
+}
+
+void flappy_env_step(FlappyEnv *env, const uint8_t *actions, float *observations, float *rewards, uint8_t *dones)
+{
+    env->env.step(actions, observations, rewards, dones);
+}
+
+void flappy_env_observe(const FlappyEnv *env, float *observations)
+{
+    env->env.observe(observations);
+}
+
+int flappy_env_score(const FlappyEnv *env, int index)
+{
+    return env->env.score(index);
+}
+
+int flappy_env_ticks(const FlappyEnv *env, int index)
+{
+    return env->env.ticks(index);
+}
@@ -0,0 +1,92 @@
+#include "file_watcher.h"
+
+#include <chrono>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static long long modificationTime(const std::string &path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long long>(info.st_mtime) : 0;
+}
+
+bool FileWatcher::watch(const char *path)
+{
+    stop();
+
+    // Watch the directory, since the file itself may be replaced
+    std::string fullPath = path;
+    size_t slash = fullPath.find_last_of("/\\");
+    directory = slash == std::string::npos ? "." : fullPath.substr(0, slash);
+    name = slash == std::string::npos ? fullPath : fullPath.substr(slash + 1);
+    lastModified = modificationTime(fullPath);
+
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+    watchId = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchId < 0)
+    {
+        stop();
+        return false;
+    }
+#endif
+    return true;
+}
+
+void FileWatcher::stop()
+{
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+    fd = -1;
+    watchId = -1;
+}
+
+bool FileWatcher::changed()
+{
+    if (name.empty())
+        return false;
+
+#ifdef __linux__
+    if (fd < 0)
+        return false;
+
+    // Drain every pending event; only the watched name counts
+    bool matched = false;
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        for (char *p = buffer; p < buffer + length;)
+        {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(p);
+            if (event->len > 0 && name == event->name)
+                matched = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return matched;
+#else
+    long long now = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    if (now == lastCheck)
+        return false;
+    lastCheck = now;
+
+    long long modified = modificationTime(directory + "/" + name);
+    if (modified == lastModified)
+        return false;
+    lastModified = modified;
+    return true;
+#endif
+}
@@ -0,0 +1,91 @@
+#include "glut_fonts.h"
+#include "world.h"
+
+#include <GL/freeglut.h>
+
+// Atlas sizes to try, smallest first; all fit in the game window
+static const int ATLAS_SIZES[][2] = {{256, 256}, {512, 256}, {512, 512}};
+
+static void *glutFont(int font)
+{
+    switch (font)
+    {
+    case FONT_HELVETICA_12:
+        return GLUT_BITMAP_HELVETICA_12;
+    case FONT_TIMES_ROMAN_24:
+        return GLUT_BITMAP_TIMES_ROMAN_24;
+    default:
+        return GLUT_BITMAP_HELVETICA_18;
+    }
+}
+
+unsigned int bakeGlutFontAtlas(GlyphAtlas &atlas)
+{
+    int advances[FONT_COUNT][GLYPH_COUNT];
+    int lineHeights[FONT_COUNT];
+    for (int f = 0; f < FONT_COUNT; f++)
+    {
+        lineHeights[f] = glutBitmapHeight(glutFont(f));
+        for (int i = 0; i < GLYPH_COUNT; i++)
+            advances[f][i] = glutBitmapWidth(glutFont(f), FIRST_GLYPH + i);
+    }
+
+    bool fits = false;
+    for (const auto &size : ATLAS_SIZES)
+    {
+        if (atlas.layout(advances, lineHeights, size[0], size[1]))
+        {
+            fits = true;
+            break;
+        }
+    }
+    if (!fits)
+        return 0;
+
+    // Draw every glyph at its origin with one window pixel per unit
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    for (int f = 0; f < FONT_COUNT; f++)
+    {
+        const FontFace &face = atlas.font(static_cast<FontId>(f));
+        for (int i = 0; i < GLYPH_COUNT; i++)
+        {
+            const Glyph &glyph = face.glyphs[i];
+            if (glyph.width <= 0.0f)
+                continue;
+            glRasterPos2i(glyph.originX, glyph.originY);
+            glutBitmapCharacter(glutFont(f), FIRST_GLYPH + i);
+        }
+    }
+
+    // The red channel of white-on-black is the coverage
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, atlas.width(), atlas.height(), GL_RED, GL_UNSIGNED_BYTE, atlas.coverage().data());
+    atlas.fillSolidBlock();
+    glClear(GL_COLOR_BUFFER_BIT);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    std::vector<unsigned char> rgba(atlas.coverage().size() * 4);
+    for (size_t i = 0; i < atlas.coverage().size(); i++)
+    {
+        rgba[i * 4 + 0] = 255;
+        rgba[i * 4 + 1] = 255;
+        rgba[i * 4 + 2] = 255;
+        rgba[i * 4 + 3] = atlas.coverage()[i];
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.width(), atlas.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
@@ -0,0 +1,81 @@
+#include "offscreen_context.h"
+
+#include <GL/freeglut.h>
+#include <stdio.h>
+
+#if FLAPPY_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+bool OffscreenContext::create(int width, int height)
+{
+    destroy();
+
+    // The surfaceless platform needs no X or Wayland display
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    EGLDisplay eglDisplay = getPlatformDisplay
+                                ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                                : EGL_NO_DISPLAY;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr))
+    {
+        printf("EGL: no surfaceless display (needs Mesa's EGL_MESA_platform_surfaceless)\n");
+        return false;
+    }
+    display = eglDisplay;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    const EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0 ||
+        (surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes)) == EGL_NO_SURFACE ||
+        (context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, nullptr)) == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(eglDisplay, surface, surface, context))
+    {
+        printf("EGL: could not create a %dx%d OpenGL pbuffer (error 0x%x)\n", width, height, eglGetError());
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenContext::destroy()
+{
+    if (!display)
+        return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context && context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    if (surface && surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    eglTerminate(display);
+    display = surface = context = nullptr;
+}
+
+#else
+
+bool OffscreenContext::create(int, int)
+{
+    printf("Offscreen rendering needs a build with EGL\n");
+    return false;
+}
+
+void OffscreenContext::destroy()
+{
+}
+
+#endif
+
+const char *OffscreenContext::renderer() const
+{
+    return context ? reinterpret_cast<const char *>(glGetString(GL_RENDERER)) : "none";
+}
@@ -0,0 +1,263 @@
+#include "frame_exporter.h"
+
+#include <chrono>
+#include <cstring>
+
+void FrameExporter::IndexQueue::push(int index)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        indices.push_back(index);
+    }
+    ready.notify_one();
+}
+
+int FrameExporter::IndexQueue::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this] { return !indices.empty(); });
+    int index = indices.front();
+    indices.pop_front();
+    return index;
+}
+
+bool FrameExporter::IndexQueue::tryPop(int &index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (indices.empty())
+        return false;
+    index = indices.front();
+    indices.pop_front();
+    return true;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// True if `pattern` is a safe printf format for one int: exactly one %d,
+// %i or %u conversion (with optional flags, width and precision) and no
+// other directives except "%%"
+static bool isFramePattern(const char *pattern)
+{
+    int conversions = 0;
+    for (const char *c = strchr(pattern, '%'); c; c = strchr(c + 1, '%'))
+    {
+        c++;
+        if (*c == '%')
+            continue;
+        c += strspn(c, "-+ #0");
+        c += strspn(c, "0123456789");
+        if (*c == '.')
+        {
+            c++;
+            c += strspn(c, "0123456789");
+        }
+        if (*c != 'd' && *c != 'i' && *c != 'u')
+            return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+bool FrameExporter::open(const char *outputPath, int frameWidth, int frameHeight, int fps)
+{
+    if (encoder.joinable() || frameWidth <= 0 || frameHeight <= 0 || fps <= 0)
+        return false;
+
+    path = outputPath;
+    width = frameWidth;
+    height = frameHeight;
+    video = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+    writeFailed = false;
+    framesWritten = 0;
+    encodeMs = writeMs = 0.0;
+    stalls = 0;
+
+    if (!video && !isFramePattern(outputPath))
+        return false;
+
+    if (video)
+    {
+        if (width % 2 || height % 2)
+            return false;
+        videoFile = fopen(outputPath, "wb");
+        if (!videoFile)
+            return false;
+        // Full-range BT.601 chroma, as produced by encodeY4m
+        fprintf(videoFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fps);
+    }
+
+    size_t captureSize = static_cast<size_t>(width) * height * 4;
+    captures.assign(BUFFER_COUNT, std::vector<unsigned char>(captureSize));
+    encoded.assign(BUFFER_COUNT, std::vector<unsigned char>());
+    for (int i = 0; i < BUFFER_COUNT; i++)
+    {
+        freeCaptures.push(i);
+        freeEncoded.push(i);
+    }
+
+    encoder = std::thread(&FrameExporter::encodeLoop, this);
+    writer = std::thread(&FrameExporter::writeLoop, this);
+    return true;
+}
+
+unsigned char *FrameExporter::acquireFrame()
+{
+    if (!freeCaptures.tryPop(currentCapture))
+    {
+        stalls++;
+        currentCapture = freeCaptures.pop();
+    }
+    return captures[currentCapture].data();
+}
+
+void FrameExporter::submitFrame()
+{
+    pendingCaptures.push(currentCapture);
+    currentCapture = -1;
+}
+
+bool FrameExporter::finish()
+{
+    if (!encoder.joinable())
+        return !writeFailed;
+
+    // The end marker flows through both stages
+    pendingCaptures.push(-1);
+    encoder.join();
+    writer.join();
+
+    if (videoFile && fclose(videoFile) != 0)
+        writeFailed = true;
+    videoFile = nullptr;
+
+    // Leave the queues empty for the next open()
+    int index;
+    while (freeCaptures.tryPop(index))
+        ;
+    while (freeEncoded.tryPop(index))
+        ;
+    return !writeFailed;
+}
+
+void FrameExporter::encodeLoop()
+{
+    for (int capture = pendingCaptures.pop(); capture >= 0; capture = pendingCaptures.pop())
+    {
+        int output = freeEncoded.pop();
+        auto start = std::chrono::steady_clock::now();
+        if (video)
+            encodeY4m(captures[capture].data(), encoded[output]);
+        else
+            encodePpm(captures[capture].data(), encoded[output]);
+        encodeMs += millisecondsSince(start);
+
+        freeCaptures.push(capture);
+        pendingEncoded.push(output);
+    }
+    pendingEncoded.push(-1);
+}
+
+void FrameExporter::writeLoop()
+{
+    for (int output = pendingEncoded.pop(); output >= 0; output = pendingEncoded.pop())
+    {
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<unsigned char> &data = encoded[output];
+        if (video)
+        {
+            if (fwrite(data.data(), data.size(), 1, videoFile) != 1)
+                writeFailed = true;
+        }
+        else
+        {
+            char framePath[1024];
+            snprintf(framePath, sizeof(framePath), path.c_str(), framesWritten);
+            FILE *file = fopen(framePath, "wb");
+            if (!file || fwrite(data.data(), data.size(), 1, file) != 1)
+                writeFailed = true;
+            if (file && fclose(file) != 0)
+                writeFailed = true;
+        }
+        writeMs += millisecondsSince(start);
+        framesWritten++;
+
+        freeEncoded.push(output);
+    }
+}
+
+// BT.601 full range in 8.8 fixed point; chroma from the average of each 2x2 block
+void FrameExporter::encodeY4m(const unsigned char *rgba, std::vector<unsigned char> &out) const
+{
+    static const char FRAME_HEADER[] = "FRAME\n";
+    const size_t headerSize = sizeof(FRAME_HEADER) - 1;
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    const size_t chromaSize = lumaSize / 4;
+    out.resize(headerSize + lumaSize + 2 * chromaSize);
+    memcpy(out.data(), FRAME_HEADER, headerSize);
+
+    unsigned char *luma = out.data() + headerSize;
+    unsigned char *cb = luma + lumaSize;
+    unsigned char *cr = cb + chromaSize;
+
+    // The capture is bottom-up; Y4M rows go top-down
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *row = rgba + static_cast<size_t>(height - 1 - y) * width * 4;
+        unsigned char *outRow = luma + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned char *p = row + x * 4;
+            outRow[x] = static_cast<unsigned char>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    for (int y = 0; y < height / 2; y++)
+    {
+        const unsigned char *row0 = rgba + static_cast<size_t>(height - 1 - 2 * y) * width * 4;
+        const unsigned char *row1 = row0 - static_cast<size_t>(width) * 4;
+        for (int x = 0; x < width / 2; x++)
+        {
+            const unsigned char *a = row0 + x * 8, *b = row1 + x * 8;
+            int r = a[0] + a[4] + b[0] + b[4];
+            int g = a[1] + a[5] + b[1] + b[5];
+            int bl = a[2] + a[6] + b[2] + b[6];
+            size_t i = static_cast<size_t>(y) * (width / 2) + x;
+            // Sums of four pixels: divide by 4 * 256, rounding, around 128
+            cb[i] = static_cast<unsigned char>(128 + ((-43 * r - 85 * g + 128 * bl + 512) >> 10));
+            cr[i] = static_cast<unsigned char>(128 + ((128 * r - 107 * g - 21 * bl + 512) >> 10));
+        }
+    }
+}
+
+void FrameExporter::encodePpm(const unsigned char *rgba, std::vector<unsigned char> &out) const
+{
+    char header[32];
+    int headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    out.resize(headerSize + static_cast<size_t>(width) * height * 3);
+    memcpy(out.data(), header, headerSize);
+
+    unsigned char *pixel = out.data() + headerSize;
+    for (int y = height - 1; y >= 0; y--)
+    {
+        const unsigned char *row = rgba + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; x++)
+        {
+            *pixel++ = row[x * 4 + 0];
+            *pixel++ = row[x * 4 + 1];
+            *pixel++ = row[x * 4 + 2];
+        }
+    }
+}
+
+ExportStats FrameExporter::stats() const
+{
+    ExportStats result;
+    result.frames = framesWritten;
+    result.encodeMs = encodeMs;
+    result.writeMs = writeMs;
+    result.rendererStalls = stalls;
+    return result;
+}
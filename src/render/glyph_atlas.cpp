@@ -0,0 +1,191 @@
+#include "glyph_atlas.h"
+
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
+
+// Side of the solid white block in the atlas corner
+static const int SOLID_SIZE = 4;
+
+bool GlyphAtlas::layout(const int advances[FONT_COUNT][GLYPH_COUNT], const int lineHeights[FONT_COUNT],
+                        int width, int height)
+{
+    // Shelf packing: fill rows left to right, the first one after the solid block
+    int x = SOLID_SIZE, y = 0, rowHeight = SOLID_SIZE;
+
+    for (int f = 0; f < FONT_COUNT; f++)
+    {
+        FontFace &face = fonts[f];
+        face.lineHeight = lineHeights[f];
+
+        // Room below the baseline for descenders
+        int descent = lineHeights[f] / 4 + 1;
+        int cellHeight = lineHeights[f] + 2 * PADDING;
+
+        for (int i = 0; i < GLYPH_COUNT; i++)
+        {
+            Glyph &glyph = face.glyphs[i];
+            glyph = Glyph();
+            glyph.advance = static_cast<float>(advances[f][i]);
+            if (FIRST_GLYPH + i == ' ')
+                continue;
+
+            int cellWidth = advances[f][i] + 2 * PADDING;
+            if (x + cellWidth > width)
+            {
+                x = 0;
+                y += rowHeight;
+                rowHeight = 0;
+            }
+            if (y + cellHeight > height || cellWidth > width)
+            {
+                atlasWidth = atlasHeight = 0;
+                return false;
+            }
+
+            glyph.originX = x + PADDING;
+            glyph.originY = y + PADDING + descent;
+            glyph.left = -static_cast<float>(PADDING);
+            glyph.bottom = -static_cast<float>(PADDING + descent);
+            glyph.width = static_cast<float>(cellWidth);
+            glyph.height = static_cast<float>(cellHeight);
+            glyph.u0 = static_cast<float>(x) / width;
+            glyph.v0 = static_cast<float>(y) / height;
+            glyph.u1 = static_cast<float>(x + cellWidth) / width;
+            glyph.v1 = static_cast<float>(y + cellHeight) / height;
+
+            x += cellWidth;
+            if (cellHeight > rowHeight)
+                rowHeight = cellHeight;
+        }
+    }
+
+    atlasWidth = width;
+    atlasHeight = height;
+    pixels.assign(static_cast<size_t>(width) * height, 0);
+    fillSolidBlock();
+    layoutGeneration++;
+    return true;
+}
+
+void GlyphAtlas::fillSolidBlock()
+{
+    for (int y = 0; y < SOLID_SIZE; y++)
+        for (int x = 0; x < SOLID_SIZE; x++)
+            pixels[static_cast<size_t>(y) * atlasWidth + x] = 255;
+}
+
+float GlyphAtlas::solidU() const
+{
+    return atlasWidth > 0 ? (SOLID_SIZE / 2.0f) / atlasWidth : 0.0f;
+}
+
+float GlyphAtlas::solidV() const
+{
+    return atlasHeight > 0 ? (SOLID_SIZE / 2.0f) / atlasHeight : 0.0f;
+}
+
+float GlyphAtlas::textWidth(FontId id, const char *text) const
+{
+    float width = 0.0f;
+    for (const char *c = text; *c; c++)
+    {
+        const Glyph *glyph = fonts[id].glyph(*c);
+        if (glyph)
+            width += glyph->advance;
+    }
+    return width;
+}
+
+// Append the two triangles of a glyph with its pen position at (x, y)
+static void appendGlyph(Vertex *out, const Glyph &glyph, float x, float y)
+{
+    float x0 = x + glyph.left, y0 = y + glyph.bottom;
+    float x1 = x0 + glyph.width, y1 = y0 + glyph.height;
+    Vertex corners[4] = {
+        {x0, y0, glyph.u0, glyph.v0, 255, 255, 255, 255},
+        {x1, y0, glyph.u1, glyph.v0, 255, 255, 255, 255},
+        {x1, y1, glyph.u1, glyph.v1, 255, 255, 255, 255},
+        {x0, y1, glyph.u0, glyph.v1, 255, 255, 255, 255}};
+    out[0] = corners[0];
+    out[1] = corners[1];
+    out[2] = corners[2];
+    out[3] = corners[0];
+    out[4] = corners[2];
+    out[5] = corners[3];
+}
+
+void drawText(VertexBatch &batch, const GlyphAtlas &atlas, FontId font, float x, float y, const char *text)
+{
+    const FontFace &face = atlas.font(font);
+    float penX = std::floor(x), penY = std::floor(y);
+    Vertex quad[6];
+    for (const char *c = text; *c; c++)
+    {
+        const Glyph *glyph = face.glyph(*c);
+        if (!glyph)
+            continue;
+        if (glyph->width > 0.0f)
+        {
+            appendGlyph(quad, *glyph, 0.0f, 0.0f);
+            batch.triangles(quad, 6, penX, penY);
+        }
+        penX += glyph->advance;
+    }
+}
+
+CachedText::CachedText(FontId font)
+    : font(font), dirty(true), numberPrefix(nullptr), numberSuffix(nullptr), number(0),
+      atlasGeneration(-1), layouts(0)
+{
+    buffer[0] = '\0';
+}
+
+void CachedText::set(const char *text)
+{
+    if (strncmp(buffer, text, MAX_LENGTH) == 0)
+        return;
+    snprintf(buffer, sizeof(buffer), "%s", text); // Truncates to MAX_LENGTH
+    numberPrefix = nullptr;
+    dirty = true;
+}
+
+void CachedText::setNumber(const char *prefix, int value, const char *suffix)
+{
+    if (prefix == numberPrefix && suffix == numberSuffix && value == number)
+        return;
+
+    char text[MAX_LENGTH + 1];
+    snprintf(text, sizeof(text), "%s%d%s", prefix, value, suffix);
+    set(text);
+    numberPrefix = prefix;
+    numberSuffix = suffix;
+    number = value;
+}
+
+void CachedText::draw(VertexBatch &batch, const GlyphAtlas &atlas, float x, float y)
+{
+    if (dirty || atlasGeneration != atlas.generation())
+    {
+        const FontFace &face = atlas.font(font);
+        quads.clear();
+        float penX = 0.0f;
+        for (const char *c = buffer; *c; c++)
+        {
+            const Glyph *glyph = face.glyph(*c);
+            if (!glyph)
+                continue;
+            if (glyph->width > 0.0f)
+            {
+                quads.resize(quads.size() + 6);
+                appendGlyph(&quads[quads.size() - 6], *glyph, penX, 0.0f);
+            }
+            penX += glyph->advance;
+        }
+        dirty = false;
+        atlasGeneration = atlas.generation();
+        layouts++;
+    }
+
+    batch.triangles(quads.data(), static_cast<int>(quads.size()), std::floor(x), std::floor(y));
+}
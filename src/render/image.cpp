@@ -0,0 +1,46 @@
+#include "image.h"
+
+#include <stdio.h>
+
+bool loadTga(Image &image, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    // 18-byte header: id length, color map type, image type, color map
+    // spec, origin, width, height, bits per pixel, descriptor
+    unsigned char header[18] = {};
+    bool ok = fread(header, sizeof(header), 1, file) == 1;
+    int width = header[12] | (header[13] << 8);
+    int height = header[14] | (header[15] << 8);
+    int bytesPerPixel = header[16] / 8;
+    bool topDown = (header[17] & 0x20) != 0;
+
+    ok = ok && header[1] == 0 && header[2] == 2 && (bytesPerPixel == 3 || bytesPerPixel == 4) &&
+         width > 0 && height > 0 && fseek(file, header[0], SEEK_CUR) == 0;
+
+    std::vector<unsigned char> row(static_cast<size_t>(width) * bytesPerPixel);
+    if (ok)
+    {
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    }
+    for (int y = 0; ok && y < height; y++)
+    {
+        ok = fread(row.data(), row.size(), 1, file) == 1;
+        unsigned char *out = &image.pixels[static_cast<size_t>(topDown ? height - 1 - y : y) * width * 4];
+        for (int x = 0; ok && x < width; x++)
+        {
+            const unsigned char *in = &row[static_cast<size_t>(x) * bytesPerPixel];
+            out[x * 4 + 0] = in[2]; // Stored as BGR(A)
+            out[x * 4 + 1] = in[1];
+            out[x * 4 + 2] = in[0];
+            out[x * 4 + 3] = bytesPerPixel == 4 ? in[3] : 255;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,190 @@
+#include "vertex_batch.h"
+#include "circle_geometry.h"
+
+static unsigned char toByte(float c)
+{
+    if (c <= 0.0f)
+        return 0;
+    if (c >= 1.0f)
+        return 255;
+    return static_cast<unsigned char>(c * 255.0f + 0.5f);
+}
+
+void VertexBatch::clear()
+{
+    verts.clear();
+    cmds.clear();
+}
+
+void VertexBatch::color(float r, float g, float b, float a)
+{
+    current.r = toByte(r);
+    current.g = toByte(g);
+    current.b = toByte(b);
+    current.a = toByte(a);
+}
+
+void VertexBatch::begin(ShapeMode shapeMode)
+{
+    mode = shapeMode;
+    shapeVertexCount = 0;
+    emitPrimitive(mode == SHAPE_LINE_STRIP ? BATCH_LINES : BATCH_TRIANGLES);
+}
+
+void VertexBatch::vertex(float x, float y)
+{
+    Vertex v = current;
+    v.x = x;
+    v.y = y;
+
+    switch (mode)
+    {
+    case SHAPE_POLYGON:
+        // Fan around the first vertex
+        if (shapeVertexCount == 0)
+        {
+            first = v;
+        }
+        else if (shapeVertexCount >= 2)
+        {
+            emit(first);
+            emit(previous);
+            emit(v);
+        }
+        break;
+
+    case SHAPE_TRIANGLE_STRIP:
+        if (shapeVertexCount >= 2)
+        {
+            emit(beforePrevious);
+            emit(previous);
+            emit(v);
+        }
+        break;
+
+    case SHAPE_QUADS:
+        // Split every 4 vertices into two triangles
+        if (shapeVertexCount % 4 == 0)
+        {
+            first = v;
+        }
+        else if (shapeVertexCount % 4 >= 2)
+        {
+            emit(first);
+            emit(previous);
+            emit(v);
+        }
+        break;
+
+    case SHAPE_LINE_STRIP:
+        if (shapeVertexCount >= 1)
+        {
+            emit(previous);
+            emit(v);
+        }
+        break;
+    }
+
+    beforePrevious = previous;
+    previous = v;
+    shapeVertexCount++;
+}
+
+void VertexBatch::end()
+{
+    // Drop the command again if the shape produced no geometry
+    if (!cmds.empty() && cmds.back().count == 0)
+        cmds.pop_back();
+}
+
+void VertexBatch::setSolidTexCoord(float u, float v)
+{
+    current.u = u;
+    current.v = v;
+}
+
+void VertexBatch::triangles(const Vertex *source, int count, float dx, float dy)
+{
+    if (count <= 0)
+        return;
+
+    emitPrimitive(BATCH_TRIANGLES);
+    for (int i = 0; i < count; i++)
+    {
+        Vertex v = current;
+        v.x = source[i].x + dx;
+        v.y = source[i].y + dy;
+        v.u = source[i].u;
+        v.v = source[i].v;
+        emit(v);
+    }
+}
+
+void VertexBatch::rect(float x, float y, float w, float h)
+{
+    begin(SHAPE_QUADS);
+    vertex(x, y);
+    vertex(x + w, y);
+    vertex(x + w, y + h);
+    vertex(x, y + h);
+    end();
+}
+
+void VertexBatch::circle(float x, float y, float radius)
+{
+    CircleLod lod(circleSegmentsForRadius(radius));
+    begin(SHAPE_POLYGON);
+    for (int i = 0; i < lod.segments(); i++)
+    {
+        vertex(x + lod.cos(i) * radius, y + lod.sin(i) * radius);
+    }
+    end();
+}
+
+void VertexBatch::ringArc(float x, float y, float innerRadius, float outerRadius, float fraction)
+{
+    if (fraction <= 0.0f)
+        return;
+    if (fraction > 1.0f)
+        fraction = 1.0f;
+
+    CircleLod lod(circleSegmentsForRadius(outerRadius));
+    float steps = fraction * lod.segments();
+    int whole = static_cast<int>(steps);
+
+    begin(SHAPE_TRIANGLE_STRIP);
+    for (int i = 0; i <= whole; i++)
+    {
+        vertex(x + lod.cos(i) * innerRadius, y + lod.sin(i) * innerRadius);
+        vertex(x + lod.cos(i) * outerRadius, y + lod.sin(i) * outerRadius);
+    }
+    if (steps > whole)
+    {
+        // Finish a partial arc on the polygon edge where it ends
+        float t = steps - whole;
+        float c = lod.cos(whole) + (lod.cos(whole + 1) - lod.cos(whole)) * t;
+        float s = lod.sin(whole) + (lod.sin(whole + 1) - lod.sin(whole)) * t;
+        vertex(x + c * innerRadius, y + s * innerRadius);
+        vertex(x + c * outerRadius, y + s * outerRadius);
+    }
+    end();
+}
+
+void VertexBatch::emit(const Vertex &v)
+{
+    verts.push_back(v);
+    cmds.back().count++;
+}
+
+void VertexBatch::emitPrimitive(BatchPrimitive primitive)
+{
+    // Keep appending to the previous command when the primitive type matches
+    if (!cmds.empty() && cmds.back().primitive == primitive)
+        return;
+
+    DrawCommand cmd;
+    cmd.primitive = primitive;
+    cmd.first = static_cast<int>(verts.size());
+    cmd.count = 0;
+    cmds.push_back(cmd);
+}
@@ -0,0 +1,310 @@
+#include "world_scene.h"
+#include "circle_geometry.h"
+
+#include <cmath>
+
+// Icon outlines: 12 clock marks, and a 5-pointed star alternating outer and
+// inner points (starting straight down for power-ups, at 0 for timers)
+constexpr CircleTable<12> clockMarks = makeCircleTable<12>();
+constexpr CircleTable<10> starPoints = makeCircleTable<10>(-CIRCLE_PI / 2);
+constexpr CircleTable<10> timerStarPoints = makeCircleTable<10>();
+
+void drawBackground(VertexBatch &batch)
+{
+    // Gradient (opaque, so blending can stay enabled)
+    batch.begin(SHAPE_QUADS);
+    batch.color(0.6f, 0.8f, 1.0f); // Top color (lighter blue)
+    batch.vertex(0, WINDOW_HEIGHT);
+    batch.vertex(WINDOW_WIDTH, WINDOW_HEIGHT);
+    batch.color(0.4f, 0.6f, 0.9f); // Bottom color (darker blue)
+    batch.vertex(WINDOW_WIDTH, 0);
+    batch.vertex(0, 0);
+    batch.end();
+}
+
+void drawCloud(VertexBatch &batch, float x, float y, float scale)
+{
+    batch.color(1.0f, 1.0f, 1.0f, 0.7f);
+    float size = 30.0f * scale;
+
+    // Draw multiple circles to create cloud shape
+    for (int i = 0; i < 3; i++)
+    {
+        float offsetX = i * size * 0.7f;
+        float offsetY = (i % 2) * size * 0.2f;
+        batch.circle(x + offsetX, y + offsetY, size);
+    }
+}
+
+void drawParticles(VertexBatch &batch, const ParticlePool &particles, float alpha)
+{
+    for (int i = 0; i < particles.size(); i++)
+    {
+        float r, g, b;
+        particles.color(i, r, g, b);
+        batch.color(r, g, b, particles.alpha(i));
+        batch.circle(interpolate(particles.prevX(i), particles.x(i), alpha),
+                     interpolate(particles.prevY(i), particles.y(i), alpha), 3.0f);
+    }
+}
+
+void drawBall(VertexBatch &batch, float x, float y, float radius, float invincibilityTimer)
+{
+    CircleLod lod(circleSegmentsForRadius(radius));
+    batch.begin(SHAPE_POLYGON);
+    for (int i = 0; i < lod.segments(); i++)
+    {
+        float dx = lod.cos(i) * radius;
+        float dy = lod.sin(i) * radius;
+        float shadeFactor = 0.5f * (1.0f - (dy + radius) / (2 * radius));
+        float r = 1.0f * (1.0f - shadeFactor);
+        float g = 0.0f;
+        float b = 0.0f;
+
+        // Add flickering effect during invincibility
+        if (invincibilityTimer > 0)
+        {
+            if ((static_cast<int>(invincibilityTimer) / 5) % 2)
+            { // Flicker every 5 frames
+                r = 1.0f;
+                g = 1.0f;
+                b = 1.0f;
+            }
+        }
+
+        batch.color(r, g, b);
+        batch.vertex(x + dx, y + dy);
+    }
+    batch.end();
+}
+
+SceneAnimation sceneAnimationAt(double seconds)
+{
+    // The rates the effects had when they advanced once per 60 Hz frame
+    SceneAnimation animation;
+    animation.shieldTime = static_cast<float>(seconds * 0.03 * BASE_TICK_RATE);
+    animation.powerUpTime = static_cast<float>(seconds * 0.05 * BASE_TICK_RATE);
+    return animation;
+}
+
+void drawShield(VertexBatch &batch, float x, float y, const SceneAnimation &animation)
+{
+    float pulseScale = 1.0f + 0.1f * sin(animation.shieldTime);
+
+    // Outer glow
+    batch.color(0.2f, 0.2f, 1.0f, 0.2f);
+    batch.circle(x, y, (ballRadius + 8) * pulseScale);
+
+    // Shield ring. The wave and shimmer phases are rotated with the
+    // angle-sum identities so the table covers every vertex.
+    float waveCos = cos(animation.shieldTime * 2), waveSin = sin(animation.shieldTime * 2);
+    float shimmerCos = cos(animation.shieldTime), shimmerSin = sin(animation.shieldTime);
+    CircleLod lod(circleSegmentsForRadius(ballRadius + 5));
+    batch.begin(SHAPE_LINE_STRIP);
+    for (int i = 0; i <= lod.segments(); i++)
+    {
+        float wave = (lod.sin(i * 6) * waveCos + lod.cos(i * 6) * waveSin) * 2; // Wavy effect
+        float radius = (ballRadius + 5) * pulseScale + wave;
+        float dx = lod.cos(i) * radius;
+        float dy = lod.sin(i) * radius;
+        float shimmer = 0.8f + 0.2f * (lod.sin(i * 3) * shimmerCos + lod.cos(i * 3) * shimmerSin); // Shimmer effect
+        batch.color(0.0f, 0.0f, 1.0f, shimmer);
+        batch.vertex(x + dx, y + dy);
+    }
+    batch.end();
+}
+
+void drawPowerUp(VertexBatch &batch, float x, float y, int type, const SceneAnimation &animation)
+{
+    float pulseScale = 1.0f + 0.1f * sin(animation.powerUpTime); // Pulsing effect
+    float outerGlow = POWER_UP_RADIUS * 1.3f;
+    float innerRadius = POWER_UP_RADIUS * 0.7f;
+
+    // Draw outer glow
+    switch (type)
+    {
+    case SHIELD:
+        batch.color(0.3f, 0.3f, 1.0f, 0.2f); // Blue glow
+        break;
+    case SLOW_MOTION:
+        batch.color(0.3f, 1.0f, 0.3f, 0.2f); // Green glow
+        break;
+    case DOUBLE_POINTS:
+        batch.color(1.0f, 1.0f, 0.3f, 0.2f); // Yellow glow
+        break;
+    }
+    batch.circle(x, y, outerGlow * pulseScale);
+
+    // Draw main power-up circle
+    switch (type)
+    {
+    case SHIELD:
+        batch.color(0.0f, 0.0f, 1.0f, 0.8f); // Blue
+        break;
+    case SLOW_MOTION:
+        batch.color(0.0f, 1.0f, 0.0f, 0.8f); // Green
+        break;
+    case DOUBLE_POINTS:
+        batch.color(1.0f, 1.0f, 0.0f, 0.8f); // Yellow
+        break;
+    }
+    batch.circle(x, y, POWER_UP_RADIUS * pulseScale);
+
+    // Draw inner symbol based on power-up type
+    batch.color(1.0f, 1.0f, 1.0f, 0.9f);
+    batch.begin(SHAPE_POLYGON);
+    switch (type)
+    {
+    case SHIELD: // Shield symbol
+    {
+        CircleLod lod(circleSegmentsForRadius(innerRadius));
+        for (int i = 0; i < lod.segments(); i++)
+        {
+            float dx = lod.cos(i) * innerRadius;
+            float dy = lod.sin(i) * innerRadius;
+            if (dy > -innerRadius * 0.3f) // Create shield shape
+            {
+                batch.vertex(x + dx, y + dy);
+            }
+        }
+        break;
+    }
+
+    case SLOW_MOTION: // Clock symbol
+        for (int i = 0; i < 12; i++) // Clock marks
+        {
+            float dx1 = clockMarks.cosv[i] * innerRadius;
+            float dy1 = clockMarks.sinv[i] * innerRadius;
+            float dx2 = clockMarks.cosv[i] * (innerRadius * 0.8f);
+            float dy2 = clockMarks.sinv[i] * (innerRadius * 0.8f);
+            batch.vertex(x + dx1, y + dy1);
+            batch.vertex(x + dx2, y + dy2);
+        }
+        break;
+
+    case DOUBLE_POINTS: // Star symbol
+        for (int i = 0; i < 10; i += 2)
+        {
+            batch.vertex(x + starPoints.cosv[i] * innerRadius, y + starPoints.sinv[i] * innerRadius);
+
+            // Inner points of the star
+            batch.vertex(x + starPoints.cosv[i + 1] * (innerRadius * 0.4f),
+                         y + starPoints.sinv[i + 1] * (innerRadius * 0.4f));
+        }
+        break;
+    }
+    batch.end();
+}
+
+void drawPowerUpTimerRing(VertexBatch &batch, float x, float y, float progress, int type)
+{
+    const float outerRadius = POWER_UP_TIMER_OUTER_RADIUS;
+    const float innerRadius = POWER_UP_TIMER_INNER_RADIUS;
+
+    // Draw outer circle (background)
+    batch.color(0.2f, 0.2f, 0.2f, 0.5f);
+    batch.ringArc(x, y, innerRadius, outerRadius, 1.0f);
+
+    // Draw progress arc
+    switch (type)
+    {
+    case SHIELD:
+        batch.color(0.0f, 0.0f, 1.0f, 0.8f);
+        break;
+    case SLOW_MOTION:
+        batch.color(0.0f, 1.0f, 0.0f, 0.8f);
+        break;
+    case DOUBLE_POINTS:
+        batch.color(1.0f, 1.0f, 0.0f, 0.8f);
+        break;
+    }
+    batch.ringArc(x, y, innerRadius, outerRadius, progress);
+
+    // Draw icon in the middle based on power-up type
+    batch.color(1.0f, 1.0f, 1.0f, 0.9f);
+    batch.begin(SHAPE_POLYGON);
+    switch (type)
+    {
+    case SHIELD:
+    {
+        // Draw shield icon: the circle with a wedge above angle 0 cut out
+        float iconRadius = innerRadius * 0.6f;
+        CircleLod lod(circleSegmentsForRadius(iconRadius));
+        for (int i = lod.segments() / 10 + 1; i < lod.segments(); i++)
+        {
+            batch.vertex(x + lod.cos(i) * iconRadius, y + lod.sin(i) * iconRadius);
+        }
+        break;
+    }
+
+    case SLOW_MOTION:
+        // Draw clock icon
+        for (int i = 0; i < 12; i++)
+        {
+            batch.vertex(x + clockMarks.cosv[i] * (innerRadius * 0.6f),
+                         y + clockMarks.sinv[i] * (innerRadius * 0.6f));
+        }
+        // Draw clock hands
+        batch.vertex(x, y);
+        batch.vertex(x + innerRadius * 0.4f, y);
+        batch.vertex(x, y + innerRadius * 0.3f);
+        break;
+
+    case DOUBLE_POINTS:
+        // Draw star icon
+        for (int i = 0; i < 10; i += 2)
+        {
+            batch.vertex(x + timerStarPoints.cosv[i] * (innerRadius * 0.6f),
+                         y + timerStarPoints.sinv[i] * (innerRadius * 0.6f));
+            batch.vertex(x + timerStarPoints.cosv[i + 1] * (innerRadius * 0.3f),
+                         y + timerStarPoints.sinv[i + 1] * (innerRadius * 0.3f));
+        }
+        break;
+    }
+    batch.end();
+}
+
+void drawWorldScene(VertexBatch &batch, const World &world, float alpha, bool background)
+{
+    if (background)
+        drawBackground(batch);
+
+    const Scroll *cloudScroll = world.clouds.column<Scroll>();
+    const CloudBody *cloudBody = world.clouds.column<CloudBody>();
+    for (int i = 0; i < world.clouds.size(); i++)
+    {
+        drawCloud(batch, interpolate(cloudScroll[i].prevX, cloudScroll[i].x, alpha), cloudBody[i].y, cloudBody[i].scale);
+    }
+
+    drawParticles(batch, world.particles, alpha);
+
+    if (world.state != PLAYING && world.state != PAUSED)
+        return;
+
+    float ballY = interpolate(world.prevBallY, world.ballY, alpha);
+    SceneAnimation animation = sceneAnimationAt((world.tickCount - 1 + alpha) / world.tickRate);
+
+    // Draw power-up effect on ball if shield is active
+    if (world.hasShield)
+    {
+        drawShield(batch, BALL_X, ballY, animation);
+    }
+
+    drawBall(batch, BALL_X, ballY, ballRadius, world.invincibilityTimer);
+
+    batch.color(0.0f, 0.8f, 0.0f);
+    for (const auto &pipe : world.pipes)
+    {
+        float pipeX = interpolate(pipe.prevX, pipe.x, alpha);
+        batch.rect(pipeX, pipe.gapY + world.currentGapHeight, PIPE_WIDTH, WINDOW_HEIGHT);
+        batch.rect(pipeX, 0, PIPE_WIDTH, pipe.gapY);
+    }
+
+    const Scroll *powerUpScroll = world.powerUps.column<Scroll>();
+    const PowerUpBody *powerUpBody = world.powerUps.column<PowerUpBody>();
+    for (int i = 0; i < world.powerUps.size(); i++)
+    {
+        drawPowerUp(batch, interpolate(powerUpScroll[i].prevX, powerUpScroll[i].x, alpha), powerUpBody[i].y,
+                    powerUpBody[i].type, animation);
+    }
+}
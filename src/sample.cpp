@@ -3,1083 +3,1090 @@
 #include <vector>
 #include <cmath>
 #include <ctime>
-#include <string>
-#include <AL/al.h>
-#include <AL/alc.h>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
 #include <stdio.h>
+#include <thread>
+#include "world.h"
+#include "level_generator.h"
+#include "planner.h"
+#include "audio_engine.h"
+#include "asset_loader.h"
+#include "file_watcher.h"
+#include "frame_exporter.h"
+#include "offscreen_context.h"
+#include "replay.h"
+#include "tuning.h"
+#include "fixed_timestep.h"
+#include "frame_pacer.h"
+#include "batch_renderer.h"
+#include "glyph_atlas.h"
+#include "glut_fonts.h"
+#include "static_layer.h"
+#include "world_scene.h"
+#include "latency_stats.h"
+#include "profiler.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+// Sound effects, played through a pool of OpenAL voices
+AudioEngine audio;
+bool showAudioStats = false; // --audio-stats: print voice usage at exit
+
+// Sound and texture files are decoded on worker threads while the menu is up
+// and uploaded from idle(); sounds without a file use the built-in beeps
+AssetLoader assetLoader;
+bool assetsLoaded = false;
+unsigned int textures[TEXTURE_COUNT] = {};
+
+// Startup timing, logged once every asset is loaded
+std::chrono::steady_clock::time_point startupTime;
+double firstFrameMs = -1.0;
 
-// Constants
-const float PI = 22.0f / 7.0f;
+// Forward declarations
+void drawPowerUpTimer(float x, float y, float progress, int type);
+void requestRedraw();
 
-// WAV file header structure
-struct WAVHeader
+void cleanupAudio()
 {
-    char riff[4];
-    unsigned int overallSize;
-    char wave[4];
-    char fmt[4];
-    unsigned int fmtSize;
-    unsigned short format;
-    unsigned short channels;
-    unsigned int sampleRate;
-    unsigned int byteRate;
-    unsigned short blockAlign;
-    unsigned short bitsPerSample;
-};
-
-// Sound effect IDs
-ALuint jumpSound;
-ALuint scoreSound;
-ALuint powerupSound;
-ALuint gameoverSound;
-ALCdevice *device;
-ALCcontext *context;
+    if (showAudioStats && audio.active())
+    {
+        AudioStats stats = audio.stats();
+        printf("Audio: %lld sounds played, %lld cut off by other sounds, %lld dropped\n",
+               stats.played, stats.stolen, stats.dropped);
+    }
+    audio.shutdown();
+}
 
-// Structs
-struct Pipe
-{
-    float x;
-    float gapY;
-};
+// Simulation state, stepped by tick()
+World world;
+Input pendingInput = {false}; // Input gathered since the last tick
+double pendingJumpTime = 0.0; // When the key behind pendingInput.jump was pressed
 
-struct PowerUp
+// A key press, stamped when GLUT delivered it. keyboard() only queues keys;
+// they are applied to the world between ticks (see advanceSimulation()).
+struct KeyEvent
 {
-    float x;
-    float y;
-    int type; // 0: Shield, 1: Slow Motion, 2: Double Points
-    bool active;
+    unsigned char key;
+    double time; // Seconds since startup
 };
+SpscQueue<KeyEvent, 64> keyQueue;
+unsigned keysSent = 0;    // Queued by keyboard()
+unsigned keysHandled = 0; // Applied to the world
 
-struct Cloud
+// Key-down times of the last player jumps that reached the world, so the
+// first frame presented with one can measure its latency
+struct AppliedJumps
 {
-    float x, y;
-    float scale;
-    float speed;
+    static const int HISTORY = 8;
+    unsigned count = 0;
+    double keyTimes[HISTORY] = {};
 };
-
-struct Particle
+AppliedJumps appliedJumps;
+
+// Key-down to present of the first frame drawn after the jump's tick (shown
+// by --latency-stats at exit)
+LatencyStats jumpLatency;
+unsigned jumpsPresented = 0;
+bool showLatencyStats = false;
+
+// --generated-levels: pipes and power-ups come from a generator thread that
+// works ahead and only hands out reachable gaps
+LevelFeed levelFeed;
+
+// 'A' hands the ball to the planner (demo mode); its inputs are recorded
+// like the player's
+Autopilot autopilot;
+bool autopilotEnabled = false;
+
+// Gameplay tuning (--tuning, default assets/tuning.cfg), read again between
+// ticks whenever the file changes. Replays don't store it, so recording and
+// playback always use the built-in values.
+const char *tuningPath = "assets/tuning.cfg";
+FileWatcher tuningWatcher;
+
+// Drives the simulation at a fixed rate independent of the render rate
+FixedTimestep simClock(BASE_TICK_RATE);
+
+// --sim-thread: the simulation runs on its own thread, which then owns the
+// world (and everything tick() and the keys touch). keyboard() queues keys to
+// it; they are applied between ticks. After every change it publishes a copy
+// of the world, and display() draws the newest copy: a slow frame no longer
+// holds up the ticks, nor a slow tick the frame.
+struct FrameSnapshot
 {
-    float x, y;
-    float vx, vy;
-    float life;
-    float r, g, b, a;
+    World world;
+    double tickStart = 0.0;   // Seconds since startup at which world's last tick was due
+    bool autopilot = false;   // autopilotEnabled
+    unsigned keysHandled = 0; // Keys applied to world so far
+    AppliedJumps jumps;
 };
-
-// Forward declarations
-void drawCircle(float x, float y, float radius);
-void initClouds();
-void drawCloud(float x, float y, float scale);
-void drawParticle(const Particle &p);
-void updateClouds();
-void updateParticles();
-void addParticles(float x, float y, float r, float g, float b);
-void createExplosionEffect(float x, float y, float r, float g, float b);
-void createScoreEffect(float x, float y);
-void drawPowerUpTimer(float x, float y, float progress, int type);
-
-// Sound functions
-bool generateBeepSound(ALuint *buffer, float frequency, float duration)
+bool simThreadEnabled = false;
+std::thread simThread;
+std::atomic<bool> simRunning{false};
+std::mutex simWakeMutex;
+std::condition_variable simWake;
+std::atomic<bool> quitRequested{false};
+TripleBuffer<FrameSnapshot> snapshots;
+
+// The world display() draws: `world` itself, or the newest snapshot
+const World *drawnWorld = &world;
+
+// --record writes each game's inputs to recordPath when it ends; --replay
+// plays loadedReplay back instead of reading the keyboard
+const char *recordPath = nullptr;
+const char *replayPath = nullptr;
+Replay recording;
+bool recordingActive = false;
+Replay loadedReplay;
+ReplayPlayer replayPlayer;
+
+// Fresh seed for every game that is not a replay
+uint64_t newSeed()
 {
-    const int sampleRate = 44100;
-    const int samples = duration * sampleRate;
-
-    // Generate sine wave
-    short *data = new short[samples];
-    for (int i = 0; i < samples; i++)
-    {
-        float t = (float)i / sampleRate;
-        data[i] = 32767 * sin(2.0f * PI * frequency * t);
-    }
-
-    // Create buffer
-    alGenBuffers(1, buffer);
-    alBufferData(*buffer, AL_FORMAT_MONO16, data, samples * sizeof(short), sampleRate);
-
-    delete[] data;
-    return true;
+    static std::random_device entropy;
+    return (static_cast<uint64_t>(entropy()) << 32) | entropy();
 }
 
-void playSound(ALuint source)
+// All shapes are recorded into one vertex batch and drawn a few calls per frame
+BatchRenderer renderer;
+VertexBatch &batch = renderer.batch();
+bool showRenderStats = false; // --render-stats: print vertices/draw calls per frame
+
+// GLUT bitmap fonts baked into a texture on the first frame; text is drawn
+// as textured quads in the same batch as the shapes
+GlyphAtlas fontAtlas;
+unsigned int fontTexture = 0;
+
+// HUD strings, laid out again only when their value changes
+CachedText scoreText;
+CachedText livesText;
+CachedText powerUpSecondsText;
+CachedText finalScoreText;
+
+// Screen overlays recorded once into display lists (the game over screen is
+// keyed by mode, whose name it shows)
+StaticLayer menuLayer;
+StaticLayer pauseLayer;
+StaticLayer gameOverLayer;
+
+// Only the game (and the profiler overlay) animates. The menu, pause and game
+// over screens are redrawn once when something changes; in between the idle
+// callback is unregistered so the process sleeps in the GLUT event loop.
+bool redrawPending = true;
+
+// Frames are paced to --fps (default 60), or by the display when its swap
+// waits for vsync. --uncapped draws every screen as fast as possible and
+// prints frame time percentiles at exit.
+FramePacer framePacer(60);
+
+// --export writes the --replay as a video (or image sequence) rendered
+// offscreen, each frame at an exact time instead of the wall clock
+const char *exportPath = nullptr;
+int exportFps = 60;
+FrameExporter *frameExporter = nullptr; // Set while exporting
+float exportAlpha = 0.0f;               // Interpolation of the frame being exported
+
+// GLUT needs a display server; an export without one skips it (and text)
+bool glutInitialized = false;
+
+// Profiler overlay (F3) and Chrome trace export (F4, or --trace on exit)
+bool showProfiler = false;
+const char *tracePath = "flappy-trace.json";
+double traceSeconds = 10.0;
+bool traceOnExit = false;
+
+double millisecondsSinceStartup()
 {
-    alSourcePlay(source);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupTime).count();
 }
 
-void initAudio()
+double secondsSinceStartup()
 {
-    device = alcOpenDevice(NULL);
-    if (!device)
-        return;
-
-    context = alcCreateContext(device, NULL);
-    alcMakeContextCurrent(context);
-
-    // Create sources for each sound
-    alGenSources(1, &jumpSound);
-    alGenSources(1, &scoreSound);
-    alGenSources(1, &powerupSound);
-    alGenSources(1, &gameoverSound);
-
-    // Generate sound effects
-    ALuint buffer;
-    generateBeepSound(&buffer, 880.0f, 0.1f); // High pitch for jump
-    alSourcei(jumpSound, AL_BUFFER, buffer);
-
-    generateBeepSound(&buffer, 1000.0f, 0.1f); // Higher pitch for score
-    alSourcei(scoreSound, AL_BUFFER, buffer);
-
-    generateBeepSound(&buffer, 660.0f, 0.2f); // Medium pitch for power-up
-    alSourcei(powerupSound, AL_BUFFER, buffer);
-
-    generateBeepSound(&buffer, 440.0f, 0.5f); // Low pitch for game over
-    alSourcei(gameoverSound, AL_BUFFER, buffer);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startupTime).count();
 }
 
-void cleanupAudio()
+unsigned int uploadTexture(const Image &image)
 {
-    alDeleteSources(1, &jumpSound);
-    alDeleteSources(1, &scoreSound);
-    alDeleteSources(1, &powerupSound);
-    alDeleteSources(1, &gameoverSound);
-    alcMakeContextCurrent(NULL);
-    alcDestroyContext(context);
-    alcCloseDevice(device);
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 image.pixels.data());
+    return texture;
 }
 
-enum GameState
+// Hand the assets the workers finished to GL and AL (main thread only)
+void uploadLoadedAssets()
 {
-    MENU,
-    PLAYING,
-    PAUSED,
-    GAME_OVER
-};
+    PROFILE_ZONE("uploadAssets");
 
-// Game mode enum
-enum GameMode
-{
-    MODE_MENU,
-    MODE_EASY,
-    MODE_MEDIUM,
-    MODE_HARD,
-    MODE_TIME_TRIAL
-};
-
-// Difficulty settings for each mode
-struct DifficultySettings
-{
-    float pipeSpeed;
-    float gapHeight;
-    float gravity;
-    int spawnInterval;
-    float speedIncrease;
-    float gapDecrease;
-    float gravityIncrease;
-} modes[] = {
-    {2.0f, 250.0f, 0.3f, 120, 0.1f, 3.0f, 0.01f}, // Easy
-    {3.0f, 200.0f, 0.4f, 100, 0.2f, 5.0f, 0.02f}, // Medium
-    {4.0f, 150.0f, 0.5f, 80, 0.3f, 7.0f, 0.03f},  // Hard
-    {3.0f, 200.0f, 0.4f, 100, 0.2f, 5.0f, 0.02f}  // Time Trial (starts at medium)
-};
+    static int fromFiles = 0;
+    static double decodeMs = 0.0;
 
-GameState gameState = MENU;
-GameMode currentMode = MODE_MENU;
-float timeTrialTimer = 0.0f; // For Time Trial mode
-int currentSpawnInterval = 100;
-
-const int WINDOW_WIDTH = 800, WINDOW_HEIGHT = 600;
-const int PIPE_WIDTH = 80;
-const int GAP_HEIGHT = 200;
-const float GRAVITY = 0.4f;
-const float POWER = -8.0f;
-const float PIPE_SPEED = 3.0f;
-const float ballRadius = 20.0f;
-
-// Difficulty scaling variables
-float currentPipeSpeed = PIPE_SPEED;
-float currentGapHeight = GAP_HEIGHT;
-float currentGravity = GRAVITY;
-const float SPEED_INCREASE = 0.2f;    // Speed increase per 5 points
-const float GAP_DECREASE = 5.0f;      // Gap decrease per 5 points
-const float GRAVITY_INCREASE = 0.02f; // Gravity increase per 5 points
-const int DIFFICULTY_INTERVAL = 5;    // Points needed for difficulty increase
-const float MIN_GAP_HEIGHT = 100.0f;  // Minimum gap height
-
-// Power-up constants
-const int SHIELD = 0;
-const int SLOW_MOTION = 1;
-const int DOUBLE_POINTS = 2;
-const float POWER_UP_RADIUS = 15.0f;
-const int POWER_UP_DURATION = 300; // Duration in frames (5 seconds at 60 FPS)
-const float POWER_UP_SPEED = 2.0f;
-const int INVINCIBILITY_DURATION = 120; // 2 seconds of invincibility after losing a life
-
-// Visual enhancement constants
-const int MAX_CLOUDS = 5;
-const int MAX_PARTICLES = 200; // Increased for more particles
-const float CLOUD_MIN_SPEED = 0.5f;
-const float CLOUD_MAX_SPEED = 1.5f;
-const float PARTICLE_LIFE = 60.0f; // frames
-const float PARTICLE_SPEED = 5.0f;
-const float EXPLOSION_SPEED = 8.0f;      // Speed for explosion particles
-const int EXPLOSION_PARTICLE_COUNT = 20; // Number of particles in explosion
-const int SCORE_PARTICLE_COUNT = 10;     // Number of particles for scoring
-
-// State variables for game objects
-const int INITIAL_LIVES = 3; // Number of lives at game start
-int lives = INITIAL_LIVES;   // Current number of lives
-int invincibilityTimer = 0;  // Timer for invincibility after losing a life
-
-std::vector<PowerUp> powerUps;
-std::vector<Cloud> clouds;
-std::vector<Particle> particles;
-
-// Power-up state variables
-bool hasShield = false;
-bool hasSlowMotion = false;
-bool hasDoublePoints = false;
-int powerUpTimer = 0;
-int activePowerUp = -1;
-
-float ballY = WINDOW_HEIGHT / 2;
-float ballSpeed = 0.0f;
-
-std::vector<Pipe> pipes;
-int score = 0;
-int frameCount = 0;
-
-// Function to handle losing a life
-void loseLife()
-{
-    lives--;
-    if (lives <= 0)
-    {
-        gameState = GAME_OVER;
-        playSound(gameoverSound);
-    }
-    else
+    LoadedAsset asset;
+    while (assetLoader.poll(asset))
     {
-        // Reset ball position and give temporary invincibility
-        ballY = WINDOW_HEIGHT / 2;
-        ballSpeed = 0;
-        invincibilityTimer = INVINCIBILITY_DURATION;
-        playSound(gameoverSound);
-
-        // Clear nearby obstacles
-        auto it = pipes.begin();
-        while (it != pipes.end())
+        if (asset.kind == ASSET_SOUND && audio.active())
         {
-            if (it->x < WINDOW_WIDTH / 2)
+            const WavData &sound = asset.sound;
+            SoundId id = static_cast<SoundId>(asset.id);
+            if (!audio.setSound(id, sound.samples.data(), sound.samples.size() / sound.channels,
+                                sound.channels, sound.sampleRate))
             {
-                it = pipes.erase(it);
-            }
-            else
-            {
-                ++it;
+                printf("Unsupported sound format in %s, using the built-in sound\n", asset.path.c_str());
+                std::vector<short> samples;
+                AudioEngine::generateSound(id, samples);
+                audio.setSound(id, samples.data(), samples.size(), 1, AudioEngine::SAMPLE_RATE);
             }
         }
+        else if (asset.kind == ASSET_TEXTURE && asset.fromFile)
+        {
+            textures[asset.id] = uploadTexture(asset.image);
+            redrawPending = true;
+        }
+        fromFiles += asset.fromFile;
+        decodeMs += asset.decodeMs;
+    }
+
+    if (assetLoader.finished())
+    {
+        assetsLoaded = true;
+        if (firstFrameMs >= 0.0)
+            printf("Startup: first frame after %.1f ms, ", firstFrameMs);
+        else
+            printf("Startup: ");
+        printf("fully loaded after %.1f ms (%d of %d assets from files, %.1f ms decoding on worker threads)\n",
+               millisecondsSinceStartup(), fromFiles, AssetLoader::jobCount(), decodeMs);
     }
 }
 
-void resetGame()
+void drawRectangle(float x, float y, float w, float h, float r, float g, float b)
+{
+    batch.color(r, g, b);
+    batch.rect(x, y, w, h);
+}
+
+void drawText(float x, float y, const char *text, FontId font = FONT_HELVETICA_18)
 {
-    // Reset ball state
-    ballY = WINDOW_HEIGHT / 2;
-    ballSpeed = 0;
-
-    // Reset game progress
-    score = 0;
-    lives = INITIAL_LIVES;
-    invincibilityTimer = 0;
-    timeTrialTimer = 0.0f;
-
-    // Clear game objects
-    pipes.clear();
-    powerUps.clear();
-    particles.clear();
-
-    // Reset power-up states
-    hasShield = false;
-    hasSlowMotion = false;
-    hasDoublePoints = false;
-    powerUpTimer = 0;
-    activePowerUp = -1;
-
-    // Reset counters
-    frameCount = 0;
-
-    // Set initial difficulty based on mode
-    if (currentMode != MODE_MENU)
+    drawText(batch, fontAtlas, font, x, y, text);
+}
+
+// Frame-time graph (last 150 frames; the line marks 60 Hz) and per-zone
+// averages over the last second, in the top-right corner
+void drawProfilerOverlay()
+{
+    PROFILE_ZONE("drawProfilerOverlay");
+
+    const int GRAPH_FRAMES = 150;
+    const int MAX_ZONES = 20;
+    const float MS_SCALE = 2.0f; // Pixels per millisecond
+    const float GRAPH_HEIGHT = 100.0f;
+    const float LINE_HEIGHT = 14.0f;
+
+    float times[GRAPH_FRAMES];
+    int frameCount = profiler.frameTimes(times, GRAPH_FRAMES);
+    ZoneStats zones[MAX_ZONES];
+    int zoneCount = profiler.zoneStats(60, zones, MAX_ZONES);
+
+    float width = GRAPH_FRAMES * 2 + 20;
+    float height = GRAPH_HEIGHT + LINE_HEIGHT * (zoneCount + 2) + 20;
+    float left = WINDOW_WIDTH - width - 10;
+    float top = WINDOW_HEIGHT - 10;
+    float graphBottom = top - 10 - GRAPH_HEIGHT;
+
+    batch.color(0.0f, 0.0f, 0.0f, 0.7f);
+    batch.rect(left, top - height, width, height);
+
+    float total = 0.0f, worst = 0.0f;
+    for (int i = 0; i < frameCount; i++)
     {
-        int modeIndex = currentMode - 1; // -1 because MODE_MENU is 0
-        currentPipeSpeed = modes[modeIndex].pipeSpeed;
-        currentGapHeight = modes[modeIndex].gapHeight;
-        currentGravity = modes[modeIndex].gravity;
-        currentSpawnInterval = modes[modeIndex].spawnInterval;
+        float ms = times[i];
+        total += ms;
+        worst = std::max(worst, ms);
+        if (ms < 1000.0f / 60.0f + 0.5f)
+            batch.color(0.2f, 0.9f, 0.2f);
+        else if (ms < 2000.0f / 60.0f + 0.5f)
+            batch.color(1.0f, 0.8f, 0.0f);
+        else
+            batch.color(1.0f, 0.2f, 0.2f);
+        batch.rect(left + 10 + (GRAPH_FRAMES - frameCount + i) * 2, graphBottom, 2,
+                   std::min(GRAPH_HEIGHT, ms * MS_SCALE));
     }
-    else
+    batch.color(1.0f, 1.0f, 1.0f, 0.5f);
+    batch.rect(left + 10, graphBottom + 1000.0f / 60.0f * MS_SCALE, GRAPH_FRAMES * 2, 1);
+
+    char line[96];
+    float y = graphBottom - LINE_HEIGHT - 2;
+    snprintf(line, sizeof(line), "frame avg %.2f ms  max %.2f ms",
+             frameCount ? total / frameCount : 0.0f, worst);
+    batch.color(1.0f, 1.0f, 1.0f);
+    drawText(left + 10, y, line, FONT_HELVETICA_12);
+
+    y -= LINE_HEIGHT;
+    drawText(left + 10, y, "zone                 avg ms   max ms  calls", FONT_HELVETICA_12);
+    for (int z = 0; z < zoneCount; z++)
     {
-        currentPipeSpeed = PIPE_SPEED;
-        currentGapHeight = GAP_HEIGHT;
-        currentGravity = GRAVITY;
-        currentSpawnInterval = 100;
+        y -= LINE_HEIGHT;
+        snprintf(line, sizeof(line), "%*s%-*.*s %7.3f  %7.3f  %5.1f", zones[z].depth * 2, "",
+                 20 - zones[z].depth * 2, 20 - zones[z].depth * 2, zones[z].name,
+                 zones[z].avgMs, zones[z].maxMs, zones[z].callsPerFrame);
+        drawText(left + 10, y, line, FONT_HELVETICA_12);
     }
-
-    // Reset power-ups
-    powerUps.clear();
-    particles.clear();
-    hasShield = false;
-    hasSlowMotion = false;
-    hasDoublePoints = false;
-    powerUpTimer = 0;
-    activePowerUp = -1;
-
-    // Initialize visual effects
-    initClouds();
 }
 
-void drawCircle(float x, float y, float radius)
+// --latency-stats: jump latency percentiles at exit
+void reportLatency()
 {
-    glBegin(GL_POLYGON);
-    for (int i = 0; i < 360; i++)
+    LatencySummary jumps = jumpLatency.summary();
+    if (jumps.count == 0)
     {
-        float angle = i * PI / 180;
-        glVertex2f(x + cos(angle) * radius, y + sin(angle) * radius);
+        printf("Input latency: no jumps presented\n");
+        return;
     }
-    glEnd();
+    printf("Input latency: %lld jumps, key to present mean %.1f ms, p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           jumps.count, jumps.mean, jumps.p50, jumps.p90, jumps.p99, jumps.max);
 }
 
-void drawRectangle(float x, float y, float w, float h, float r, float g, float b)
+// --uncapped: frame time percentiles at exit
+void reportFrameTimes()
 {
-    glColor3f(r, g, b);
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x + w, y);
-    glVertex2f(x + w, y + h);
-    glVertex2f(x, y + h);
-    glEnd();
+    LatencySummary frames = framePacer.frameTimes().summary();
+    if (frames.count == 0)
+        return;
+    printf("Frames: %lld presented, mean %.2f ms (%.0f fps), p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           frames.count + 1, frames.mean, 1000.0 / frames.mean, frames.p50, frames.p90, frames.p99, frames.max);
 }
 
-void drawBall(float x, float y, float radius)
+void writeTrace()
 {
-    glBegin(GL_POLYGON);
-    for (int i = 0; i < 360; i++)
+    if (profiler.writeChromeTrace(tracePath, traceSeconds))
+        printf("Wrote the last %.0f s of profiler zones to %s\n", traceSeconds, tracePath);
+    else
+        printf("Failed to write trace %s\n", tracePath);
+}
+
+// F3 toggles the profiler overlay, F4 dumps a Chrome trace
+void specialKey(int key, [[maybe_unused]] int x, [[maybe_unused]] int y)
+{
+    requestRedraw();
+
+    if (key == GLUT_KEY_F3)
+    {
+        showProfiler = !showProfiler;
+        profiler.setEnabled(showProfiler || traceOnExit);
+    }
+    else if (key == GLUT_KEY_F4)
     {
-        float angle = i * (PI / 180);
-        float dx = cos(angle) * radius;
-        float dy = sin(angle) * radius;
-        float shadeFactor = 0.5f * (1.0f - (dy + radius) / (2 * radius));
-        float r = 1.0f * (1.0f - shadeFactor);
-        float g = 0.0f;
-        float b = 0.0f;
-
-        // Add flickering effect during invincibility
-        if (invincibilityTimer > 0)
+        if (!profiler.enabled())
         {
-            if ((invincibilityTimer / 5) % 2)
-            { // Flicker every 5 frames
-                r = 1.0f;
-                g = 1.0f;
-                b = 1.0f;
-            }
+            // Start recording now; the next F4 has something to write
+            profiler.setEnabled(true);
+            printf("Profiler enabled, press F4 again to write %s\n", tracePath);
+            return;
         }
-
-        glColor3f(r, g, b);
-        glVertex2f(x + dx, y + dy);
+        writeTrace();
     }
-    glEnd();
 }
 
-void drawPowerUp(float x, float y, int type)
+// Title, mode list, controls and power-up help over the menu background
+void drawMenuOverlay()
 {
-    static float animationTime = 0.0f;
-    animationTime += 0.05f;
-    float pulseScale = 1.0f + 0.1f * sin(animationTime); // Pulsing effect
-    float outerGlow = POWER_UP_RADIUS * 1.3f;
-    float innerRadius = POWER_UP_RADIUS * 0.7f;
-
-    // Draw outer glow
-    glBegin(GL_POLYGON);
-    for (int i = 0; i < 360; i++)
-    {
-        float angle = i * (PI / 180);
-        float dx = cos(angle) * outerGlow * pulseScale;
-        float dy = sin(angle) * outerGlow * pulseScale;
+    // Draw semi-transparent overlay
+    batch.color(0.0f, 0.0f, 0.0f, 0.3f);
+    batch.begin(SHAPE_QUADS);
+    batch.vertex(0, 0);
+    batch.vertex(WINDOW_WIDTH, 0);
+    batch.vertex(WINDOW_WIDTH, WINDOW_HEIGHT);
+    batch.vertex(0, WINDOW_HEIGHT);
+    batch.end();
+
+    // Draw title with shadow effect
+    batch.color(0.8f, 0.0f, 0.0f);
+    drawText(WINDOW_WIDTH / 2 - 98, WINDOW_HEIGHT - 50, "FLAPPY BALL", FONT_TIMES_ROMAN_24);
+    batch.color(1.0f, 0.0f, 0.0f);
+    drawText(WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT - 52, "FLAPPY BALL", FONT_TIMES_ROMAN_24);
+
+    // Start from a higher position and use consistent spacing
+    float startY = WINDOW_HEIGHT - 120; // Start lower than the title
+    float spacing = 25;                 // Reduced spacing
+
+    // Game Modes Section
+    batch.color(1.0f, 1.0f, 1.0f);
+    drawText(WINDOW_WIDTH / 2 - 150, startY, "Game Modes:", FONT_HELVETICA_18);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "1: Easy Mode - Wider gaps, slower speed", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "2: Medium Mode - Balanced difficulty", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "3: Hard Mode - Narrow gaps, faster speed", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 4, "4: Time Trial - Progressive difficulty", FONT_HELVETICA_12);
+
+    // Controls Section
+    startY = startY - spacing * 5.5; // Reduced gap between sections
+    drawText(WINDOW_WIDTH / 2 - 150, startY, "Controls:", FONT_HELVETICA_18);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "SPACE - Jump/Flap & Start Game", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "P - Pause/Resume", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "ESC - Return to Menu/Quit", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 4, "R - Restart (after game over)", FONT_HELVETICA_12);
+
+    // Power-ups Section
+    startY = startY - spacing * 5.5; // Reduced gap between sections
+    drawText(WINDOW_WIDTH / 2 - 150, startY, "Power-ups:", FONT_HELVETICA_18);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "Blue Shield - Temporary invincibility", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "Green Clock - Slows down obstacles", FONT_HELVETICA_12);
+    drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "Yellow Star - Double points", FONT_HELVETICA_12);
+
+    // Add "Press SPACE to Start" message at the bottom
+    batch.color(1.0f, 1.0f, 0.0f); // Yellow color
+    drawText(WINDOW_WIDTH / 2 - 100, 100, "Press SPACE to Start Easy Mode", FONT_HELVETICA_18);
+}
 
-        switch (type)
-        {
-        case SHIELD:
-            glColor4f(0.3f, 0.3f, 1.0f, 0.2f); // Blue glow
-            break;
-        case SLOW_MOTION:
-            glColor4f(0.3f, 1.0f, 0.3f, 0.2f); // Green glow
-            break;
-        case DOUBLE_POINTS:
-            glColor4f(1.0f, 1.0f, 0.3f, 0.2f); // Yellow glow
-            break;
-        }
-        glVertex2f(x + dx, y + dy);
-    }
-    glEnd();
+// Dimmed playfield with the pause message
+void drawPauseOverlay()
+{
+    // Draw semi-transparent dark overlay
+    batch.color(0.0f, 0.0f, 0.0f, 0.5f);
+    batch.begin(SHAPE_QUADS);
+    batch.vertex(0, 0);
+    batch.vertex(WINDOW_WIDTH, 0);
+    batch.vertex(WINDOW_WIDTH, WINDOW_HEIGHT);
+    batch.vertex(0, WINDOW_HEIGHT);
+    batch.end();
+
+    // Draw pause text
+    batch.color(1.0f, 1.0f, 1.0f); // White text
+    drawText(WINDOW_WIDTH / 2 - 60, WINDOW_HEIGHT / 2 + 20, "PAUSED", FONT_TIMES_ROMAN_24);
+    drawText(WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT / 2 - 20, "Press 'P' to Resume", FONT_HELVETICA_18);
+}
 
-    // Draw main power-up circle
-    glBegin(GL_POLYGON);
-    for (int i = 0; i < 360; i++)
-    {
-        float angle = i * (PI / 180);
-        float dx = cos(angle) * POWER_UP_RADIUS * pulseScale;
-        float dy = sin(angle) * POWER_UP_RADIUS * pulseScale;
+// Game over screen except the final score, which changes every game
+void drawGameOverOverlay()
+{
+    // Draw semi-transparent dark overlay
+    batch.color(0.0f, 0.0f, 0.0f, 0.7f);
+    drawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0.0f, 0.0f, 0.0f);
 
-        switch (type)
-        {
-        case SHIELD:
-            glColor4f(0.0f, 0.0f, 1.0f, 0.8f); // Blue
-            break;
-        case SLOW_MOTION:
-            glColor4f(0.0f, 1.0f, 0.0f, 0.8f); // Green
-            break;
-        case DOUBLE_POINTS:
-            glColor4f(1.0f, 1.0f, 0.0f, 0.8f); // Yellow
-            break;
-        }
-        glVertex2f(x + dx, y + dy);
-    }
-    glEnd();
+    float centerY = WINDOW_HEIGHT / 2;
+
+    // Draw Game Over text with shadow effect
+    batch.color(0.8f, 0.0f, 0.0f);
+    drawText(WINDOW_WIDTH / 2 - 58, centerY + 22, "Game Over!", FONT_TIMES_ROMAN_24);
+    batch.color(1.0f, 0.0f, 0.0f);
+    drawText(WINDOW_WIDTH / 2 - 60, centerY + 20, "Game Over!", FONT_TIMES_ROMAN_24);
 
-    // Draw inner symbol based on power-up type
-    glBegin(GL_POLYGON);
-    switch (type)
+    // Draw game mode info
+    const char *modeText;
+    switch (drawnWorld->mode)
     {
-    case SHIELD: // Shield symbol
-        for (int i = 0; i < 360; i++)
-        {
-            float angle = i * (PI / 180);
-            float dx = cos(angle) * innerRadius;
-            float dy = sin(angle) * innerRadius;
-            if (dy > -innerRadius * 0.3f) // Create shield shape
-            {
-                glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-                glVertex2f(x + dx, y + dy);
-            }
-        }
+    case MODE_EASY:
+        modeText = "Easy Mode";
         break;
-
-    case SLOW_MOTION: // Clock symbol
-        glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-        for (int i = 0; i < 12; i++) // Clock marks
-        {
-            float angle = i * (PI / 6);
-            float dx1 = cos(angle) * innerRadius;
-            float dy1 = sin(angle) * innerRadius;
-            float dx2 = cos(angle) * (innerRadius * 0.8f);
-            float dy2 = sin(angle) * (innerRadius * 0.8f);
-            glVertex2f(x + dx1, y + dy1);
-            glVertex2f(x + dx2, y + dy2);
-        }
+    case MODE_MEDIUM:
+        modeText = "Medium Mode";
         break;
-
-    case DOUBLE_POINTS: // Star symbol
-        glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-        for (int i = 0; i < 5; i++)
-        {
-            float angle = i * (2 * PI / 5) - PI / 2;
-            float dx = cos(angle) * innerRadius;
-            float dy = sin(angle) * innerRadius;
-            glVertex2f(x + dx, y + dy);
-
-            // Inner points of the star
-            angle += PI / 5;
-            dx = cos(angle) * (innerRadius * 0.4f);
-            dy = sin(angle) * (innerRadius * 0.4f);
-            glVertex2f(x + dx, y + dy);
-        }
+    case MODE_HARD:
+        modeText = "Hard Mode";
+        break;
+    case MODE_TIME_TRIAL:
+        modeText = "Time Trial Mode";
         break;
+    default:
+        modeText = "Unknown Mode";
     }
-    glEnd();
+    batch.color(1.0f, 1.0f, 1.0f);
+    drawText(WINDOW_WIDTH / 2 - 60, centerY - 40, modeText);
+
+    // Draw options with better visibility
+    batch.color(1.0f, 1.0f, 0.0f); // Yellow color for better visibility
+    drawText(WINDOW_WIDTH / 2 - 100, centerY - 80, "Press 'R' to Restart");
+    drawText(WINDOW_WIDTH / 2 - 100, centerY - 100, "Press 'M' for Main Menu");
+    drawText(WINDOW_WIDTH / 2 - 100, centerY - 120, "Press 'ESC' to Quit");
 }
 
-void drawText(float x, float y, const std::string &text, void *font = GLUT_BITMAP_HELVETICA_18)
+// Record the latency of the jumps the frame just presented shows first
+void measureJumpLatency(const AppliedJumps &jumps)
 {
-    glRasterPos2f(x, y);
-    for (char c : text)
+    double now = secondsSinceStartup();
+    for (; jumpsPresented != jumps.count; jumpsPresented++)
     {
-        glutBitmapCharacter(font, c);
+        // More jumps than the history holds went by since the last frame
+        if (jumps.count - jumpsPresented > AppliedJumps::HISTORY)
+            continue;
+        double keyTime = jumps.keyTimes[jumpsPresented % AppliedJumps::HISTORY];
+        jumpLatency.add((now - keyTime) * 1000.0);
     }
 }
 
 void display()
 {
+    PROFILE_ZONE("display");
+
     glClear(GL_COLOR_BUFFER_BIT);
     glLoadIdentity();
 
-    // Draw gradient background
-    glDisable(GL_BLEND);
-    glBegin(GL_QUADS);
-    glColor3f(0.6f, 0.8f, 1.0f); // Top color (lighter blue)
-    glVertex2f(0, WINDOW_HEIGHT);
-    glVertex2f(WINDOW_WIDTH, WINDOW_HEIGHT);
-    glColor3f(0.4f, 0.6f, 0.9f); // Bottom color (darker blue)
-    glVertex2f(WINDOW_WIDTH, 0);
-    glVertex2f(0, 0);
-    glEnd();
+    static bool fontsBaked = false;
+    if (!fontsBaked)
+    {
+        fontsBaked = true;
+        fontTexture = glutInitialized ? bakeGlutFontAtlas(fontAtlas) : 0;
+        if (!glutInitialized)
+            printf("No display for the GLUT fonts, text is disabled\n");
+        else if (!fontTexture)
+            printf("Failed to bake the font atlas, text is disabled\n");
+        renderer.setTexture(fontTexture);
+        batch.setSolidTexCoord(fontAtlas.solidU(), fontAtlas.solidV());
+    }
 
-    // Enable alpha blending for overlays and sprites
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    renderer.beginFrame();
 
-    // Draw clouds
-    for (const auto &cloud : clouds)
+    // The world to draw, and how far we are between its last two ticks
+    float alpha;
+    bool autopilotShown;
+    const AppliedJumps *jumpsShown;
+    if (simThreadEnabled)
     {
-        drawCloud(cloud.x, cloud.y, cloud.scale);
+        const FrameSnapshot &snapshot = snapshots.readBuffer();
+        drawnWorld = &snapshot.world;
+        autopilotShown = snapshot.autopilot;
+        jumpsShown = &snapshot.jumps;
+        double sinceTick = secondsSinceStartup() - snapshot.tickStart;
+        alpha = static_cast<float>(std::min(1.0, std::max(0.0, sinceTick * snapshot.world.tickRate)));
     }
+    else
+    {
+        drawnWorld = &world;
+        autopilotShown = autopilotEnabled;
+        jumpsShown = &appliedJumps;
+        alpha = frameExporter ? exportAlpha : simClock.alpha();
+    }
+    const World &shown = *drawnWorld;
+    if (shown.state != PLAYING)
+        alpha = 1.0f;
 
-    // Draw particles
-    for (const auto &particle : particles)
+    // Playfield: background, clouds, particles and, in game, ball, pipes and power-ups
     {
-        drawParticle(particle);
+        PROFILE_ZONE("drawWorldScene");
+        unsigned int background = textures[TEXTURE_BACKGROUND];
+        if (background)
+            renderer.drawImage(background, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        drawWorldScene(batch, shown, alpha, background == 0);
     }
 
-    if (gameState == MENU)
+    if (shown.state == MENU)
     {
-        // Draw semi-transparent overlay
-        glColor4f(0.0f, 0.0f, 0.0f, 0.3f);
-        glBegin(GL_QUADS);
-        glVertex2f(0, 0);
-        glVertex2f(WINDOW_WIDTH, 0);
-        glVertex2f(WINDOW_WIDTH, WINDOW_HEIGHT);
-        glVertex2f(0, WINDOW_HEIGHT);
-        glEnd();
-
-        // Draw title with shadow effect
-        glColor3f(0.8f, 0.0f, 0.0f);
-        drawText(WINDOW_WIDTH / 2 - 98, WINDOW_HEIGHT - 50, "FLAPPY BALL", GLUT_BITMAP_TIMES_ROMAN_24);
-        glColor3f(1.0f, 0.0f, 0.0f);
-        drawText(WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT - 52, "FLAPPY BALL", GLUT_BITMAP_TIMES_ROMAN_24);
-
-        // Start from a higher position and use consistent spacing
-        float startY = WINDOW_HEIGHT - 120; // Start lower than the title
-        float spacing = 25;                 // Reduced spacing
-
-        // Game Modes Section
-        glColor3f(1.0f, 1.0f, 1.0f);
-        drawText(WINDOW_WIDTH / 2 - 150, startY, "Game Modes:", GLUT_BITMAP_HELVETICA_18);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "1: Easy Mode - Wider gaps, slower speed", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "2: Medium Mode - Balanced difficulty", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "3: Hard Mode - Narrow gaps, faster speed", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 4, "4: Time Trial - Progressive difficulty", GLUT_BITMAP_HELVETICA_12);
-
-        // Controls Section
-        startY = startY - spacing * 5.5; // Reduced gap between sections
-        drawText(WINDOW_WIDTH / 2 - 150, startY, "Controls:", GLUT_BITMAP_HELVETICA_18);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "SPACE - Jump/Flap & Start Game", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "P - Pause/Resume", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "ESC - Return to Menu/Quit", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 4, "R - Restart (after game over)", GLUT_BITMAP_HELVETICA_12);
-
-        // Power-ups Section
-        startY = startY - spacing * 5.5; // Reduced gap between sections
-        drawText(WINDOW_WIDTH / 2 - 150, startY, "Power-ups:", GLUT_BITMAP_HELVETICA_18);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing, "Blue Shield - Temporary invincibility", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 2, "Green Clock - Slows down obstacles", GLUT_BITMAP_HELVETICA_12);
-        drawText(WINDOW_WIDTH / 2 - 150, startY - spacing * 3, "Yellow Star - Double points", GLUT_BITMAP_HELVETICA_12);
-
-        // Add "Press SPACE to Start" message at the bottom
-        glColor3f(1.0f, 1.0f, 0.0f); // Yellow color
-        drawText(WINDOW_WIDTH / 2 - 100, 100, "Press SPACE to Start Easy Mode", GLUT_BITMAP_HELVETICA_18);
+        menuLayer.draw(renderer, 0, drawMenuOverlay);
     }
-    else if (gameState == PLAYING || gameState == PAUSED)
+    else if (shown.state == PLAYING || shown.state == PAUSED)
     {
-        float ballX = 100.0f;
-
-        // Draw power-up effect on ball if shield is active
-        if (hasShield)
-        {
-            static float shieldAnimTime = 0.0f;
-            shieldAnimTime += 0.03f;
-            float pulseScale = 1.0f + 0.1f * sin(shieldAnimTime);
-
-            // Outer glow
-            glBegin(GL_POLYGON);
-            glColor4f(0.2f, 0.2f, 1.0f, 0.2f);
-            for (int i = 0; i < 360; i++)
-            {
-                float angle = i * (PI / 180);
-                float dx = cos(angle) * (ballRadius + 8) * pulseScale;
-                float dy = sin(angle) * (ballRadius + 8) * pulseScale;
-                glVertex2f(ballX + dx, ballY + dy);
-            }
-            glEnd();
-
-            // Shield ring
-            glBegin(GL_LINE_STRIP);
-            for (int i = 0; i <= 360; i += 5)
-            {
-                float angle = i * (PI / 180);
-                float wave = sin(angle * 6 + shieldAnimTime * 2) * 2; // Wavy effect
-                float radius = (ballRadius + 5) * pulseScale + wave;
-                float dx = cos(angle) * radius;
-                float dy = sin(angle) * radius;
-                float alpha = 0.8f + 0.2f * sin(angle * 3 + shieldAnimTime); // Shimmer effect
-                glColor4f(0.0f, 0.0f, 1.0f, alpha);
-                glVertex2f(ballX + dx, ballY + dy);
-            }
-            glEnd();
-        }
-
-        drawBall(ballX, ballY, ballRadius);
-
-        for (auto &pipe : pipes)
-        {
-            drawRectangle(pipe.x, pipe.gapY + currentGapHeight, PIPE_WIDTH, WINDOW_HEIGHT, 0.0f, 0.8f, 0.0f);
-            drawRectangle(pipe.x, 0, PIPE_WIDTH, pipe.gapY, 0.0f, 0.8f, 0.0f);
-        }
-
-        // Draw power-ups
-        for (const auto &powerUp : powerUps)
-        {
-            if (powerUp.active)
-            {
-                drawPowerUp(powerUp.x, powerUp.y, powerUp.type);
-            }
-        }
-
         // Draw score/time and active power-ups
-        if (currentMode == MODE_TIME_TRIAL)
+        if (shown.mode == MODE_TIME_TRIAL)
         {
-            drawText(10, WINDOW_HEIGHT - 30, "Time: " + std::to_string(static_cast<int>(timeTrialTimer)) + "s");
+            scoreText.setNumber("Time: ", static_cast<int>(shown.timeTrialTimer), "s");
         }
         else
         {
-            drawText(10, WINDOW_HEIGHT - 30, "Score: " + std::to_string(score));
+            scoreText.setNumber("Score: ", shown.score);
         }
-        drawText(10, WINDOW_HEIGHT - 50, "Lives: " + std::to_string(lives));
+        scoreText.draw(batch, fontAtlas, 10, WINDOW_HEIGHT - 30);
+        livesText.setNumber("Lives: ", shown.lives);
+        livesText.draw(batch, fontAtlas, 10, WINDOW_HEIGHT - 50);
 
         // Draw power-up timers
         float timerY = WINDOW_HEIGHT - 80;
         float timerSpacing = 60.0f;
 
-        if (hasShield)
+        if (shown.hasShield)
         {
-            drawPowerUpTimer(40, timerY, (float)powerUpTimer / POWER_UP_DURATION, SHIELD);
+            drawPowerUpTimer(40, timerY, shown.powerUpTimer / shown.tuning.powerUpDuration, SHIELD);
         }
-        if (hasSlowMotion)
+        if (shown.hasSlowMotion)
         {
-            drawPowerUpTimer(40 + timerSpacing, timerY, (float)powerUpTimer / POWER_UP_DURATION, SLOW_MOTION);
+            drawPowerUpTimer(40 + timerSpacing, timerY, shown.powerUpTimer / shown.tuning.powerUpDuration, SLOW_MOTION);
         }
-        if (hasDoublePoints)
+        if (shown.hasDoublePoints)
         {
-            drawPowerUpTimer(40 + timerSpacing * 2, timerY, (float)powerUpTimer / POWER_UP_DURATION, DOUBLE_POINTS);
+            drawPowerUpTimer(40 + timerSpacing * 2, timerY, shown.powerUpTimer / shown.tuning.powerUpDuration, DOUBLE_POINTS);
+        }
+
+        if (autopilotShown && !replayPath)
+        {
+            batch.color(1.0f, 1.0f, 0.0f);
+            drawText(WINDOW_WIDTH - 110, WINDOW_HEIGHT - 30, "AUTOPILOT");
         }
 
         // Show pause message
-        if (gameState == PAUSED)
+        if (shown.state == PAUSED)
         {
-            // Draw semi-transparent dark overlay
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
-            glBegin(GL_QUADS);
-            glVertex2f(0, 0);
-            glVertex2f(WINDOW_WIDTH, 0);
-            glVertex2f(WINDOW_WIDTH, WINDOW_HEIGHT);
-            glVertex2f(0, WINDOW_HEIGHT);
-            glEnd();
-
-            // Draw pause text
-            glColor3f(1.0f, 1.0f, 1.0f); // White text
-            drawText(WINDOW_WIDTH / 2 - 60, WINDOW_HEIGHT / 2 + 20, "PAUSED", GLUT_BITMAP_TIMES_ROMAN_24);
-            drawText(WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT / 2 - 20, "Press 'P' to Resume", GLUT_BITMAP_HELVETICA_18);
+            pauseLayer.draw(renderer, 0, drawPauseOverlay);
         }
     }
-    else if (gameState == GAME_OVER)
+    else if (shown.state == GAME_OVER)
     {
-        // Draw semi-transparent dark overlay
-        glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
-        drawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0.0f, 0.0f, 0.0f);
+        gameOverLayer.draw(renderer, shown.mode, drawGameOverOverlay);
 
+        // Draw score/time based on game mode
         float centerY = WINDOW_HEIGHT / 2;
+        batch.color(1.0f, 0.0f, 0.0f);
+        if (shown.mode == MODE_TIME_TRIAL)
+        {
+            finalScoreText.setNumber("Time Survived: ", static_cast<int>(shown.timeTrialTimer), "s");
+            finalScoreText.draw(batch, fontAtlas, WINDOW_WIDTH / 2 - 100, centerY - 20);
+        }
+        else
+        {
+            finalScoreText.setNumber("Score: ", shown.score);
+            finalScoreText.draw(batch, fontAtlas, WINDOW_WIDTH / 2 - 60, centerY - 20);
+        }
+    }
 
-        // Draw Game Over text with shadow effect
-        glColor3f(0.8f, 0.0f, 0.0f);
-        drawText(WINDOW_WIDTH / 2 - 58, centerY + 22, "Game Over!", GLUT_BITMAP_TIMES_ROMAN_24);
-        glColor3f(1.0f, 0.0f, 0.0f);
-        drawText(WINDOW_WIDTH / 2 - 60, centerY + 20, "Game Over!", GLUT_BITMAP_TIMES_ROMAN_24);
+    if (showProfiler)
+    {
+        drawProfilerOverlay();
+    }
 
-        // Draw score/time based on game mode
-        if (currentMode == MODE_TIME_TRIAL)
+    renderer.flush();
+    {
+        PROFILE_ZONE("present");
+        if (frameExporter)
         {
-            drawText(WINDOW_WIDTH / 2 - 100, centerY - 20, "Time Survived: " + std::to_string(static_cast<int>(timeTrialTimer)) + "s");
+            glReadPixels(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, frameExporter->acquireFrame());
+            frameExporter->submitFrame();
         }
         else
         {
-            drawText(WINDOW_WIDTH / 2 - 60, centerY - 20, "Score: " + std::to_string(score));
+            auto swapStart = std::chrono::steady_clock::now();
+            glutSwapBuffers();
+            framePacer.framePresented(std::chrono::duration<double>(std::chrono::steady_clock::now() - swapStart).count());
+            measureJumpLatency(*jumpsShown);
         }
+    }
+    redrawPending = false;
+    if (firstFrameMs < 0.0)
+        firstFrameMs = millisecondsSinceStartup();
 
-        // Draw game mode info
-        std::string modeText;
-        switch (currentMode)
+    if (showRenderStats)
+    {
+        // Report once per second
+        static int frames = 0;
+        static long long vertices = 0, drawCalls = 0;
+        static long long skippedBefore = 0;
+        static double lastReport = millisecondsSinceStartup();
+        frames++;
+        vertices += renderer.frameStats().vertices;
+        drawCalls += renderer.frameStats().drawCalls;
+        double now = millisecondsSinceStartup();
+        if (now - lastReport >= 1000)
         {
-        case MODE_EASY:
-            modeText = "Easy Mode";
-            break;
-        case MODE_MEDIUM:
-            modeText = "Medium Mode";
-            break;
-        case MODE_HARD:
-            modeText = "Hard Mode";
-            break;
-        case MODE_TIME_TRIAL:
-            modeText = "Time Trial Mode";
-            break;
-        default:
-            modeText = "Unknown Mode";
+            printf("Render: %d fps (%lld skipped%s), %lld vertices/frame, %lld draw calls/frame\n",
+                   frames, framePacer.skippedFrames() - skippedBefore,
+                   framePacer.displayPaced() ? ", paced by the display" : "", vertices / frames, drawCalls / frames);
+            skippedBefore = framePacer.skippedFrames();
+            frames = 0;
+            vertices = drawCalls = 0;
+            lastReport = now;
         }
-        glColor3f(1.0f, 1.0f, 1.0f);
-        drawText(WINDOW_WIDTH / 2 - 60, centerY - 40, modeText);
-
-        // Draw options with better visibility
-        glColor3f(1.0f, 1.0f, 0.0f); // Yellow color for better visibility
-        drawText(WINDOW_WIDTH / 2 - 100, centerY - 80, "Press 'R' to Restart");
-        drawText(WINDOW_WIDTH / 2 - 100, centerY - 100, "Press 'M' for Main Menu");
-        drawText(WINDOW_WIDTH / 2 - 100, centerY - 120, "Press 'ESC' to Quit");
     }
+}
 
-    glutSwapBuffers();
+// Save the game recorded so far (--record)
+void saveRecording()
+{
+    if (!recordPath || !recordingActive)
+        return;
+    recordingActive = false;
+    finishRecording(recording, world);
+    if (saveReplay(recording, recordPath))
+        printf("Replay saved to %s (%d ticks)\n", recordPath, recording.tickCount);
+    else
+        printf("Failed to save replay to %s\n", recordPath);
 }
 
-void update([[maybe_unused]] int value)
+// Apply the tuning file on top of the built-in values; on any error the
+// current values stay
+void reloadTuning()
 {
-    if (gameState != PLAYING)
+    Tuning tuning = DEFAULT_TUNING;
+    std::string error;
+    if (!loadTuning(tuning, tuningPath, error))
     {
-        if (gameState == PAUSED)
-        {
-            glutPostRedisplay(); // Keep updating display while paused
-        }
+        printf("Tuning not applied: %s\n", error.c_str());
         return;
     }
+    applyTuning(world, tuning);
+    printf("Tuning loaded from %s\n", tuningPath);
+}
 
-    // Update visual effects
-    updateClouds();
-    updateParticles();
-
-    // Update invincibility timer
-    if (invincibilityTimer > 0)
+// Run one fixed simulation step and react to its events
+void tick()
+{
+    PROFILE_ZONE("tick");
+
+    Input input = pendingInput;
+    pendingInput.jump = false;
+    if (replayPath)
+        input = replayPlayer.next();
+    else if (autopilotEnabled)
+        input = autopilot.next(world);
+    else if (input.jump)
+        appliedJumps.keyTimes[appliedJumps.count++ % AppliedJumps::HISTORY] = pendingJumpTime;
+    if (recordingActive)
+        recordInput(recording, input);
+
+    step(world, input);
+
+    if (world.events & EVENT_GAME_OVER)
+        saveRecording();
+    if (replayPath && replayPlayer.finished())
     {
-        invincibilityTimer--;
+        bool match = worldHash(world) == loadedReplay.finalHash;
+        printf("Replay finished after %d ticks, score %d%s\n", replayPlayer.ticksPlayed(), world.score,
+               loadedReplay.finalHash == 0 ? "" : match ? ", matches the recording" : ", DIVERGED from the recording");
+        // A recording that was abandoned mid-game ends while still playing
+        if (world.state == PLAYING)
+            world.state = PAUSED;
     }
 
-    // Update power-up timer
-    if (activePowerUp != -1 && powerUpTimer > 0)
+    // Play sounds for whatever happened during the tick
+    audio.playEvents(world.events);
+
+    if (world.events & EVENT_DIFFICULTY_UP)
     {
-        powerUpTimer--;
-        if (powerUpTimer <= 0)
-        {
-            // Deactivate power-up
-            switch (activePowerUp)
-            {
-            case SHIELD:
-                hasShield = false;
-                break;
-            case SLOW_MOTION:
-                hasSlowMotion = false;
-                break;
-            case DOUBLE_POINTS:
-                hasDoublePoints = false;
-                break;
-            }
-            activePowerUp = -1;
-            powerUpTimer = 0;
-        }
+        printf("Time Trial difficulty increased at %d seconds\n", world.lastDifficultyIncrease);
+        printf("New values - Speed: %.2f, Gravity: %.2f, Gap: %.2f\n",
+               world.currentPipeSpeed, world.currentGravity, world.currentGapHeight);
     }
+}
 
-    // Update Time Trial timer and difficulty
-    if (currentMode == MODE_TIME_TRIAL)
-    {
-        // Track previous time to detect 30 second intervals
-        static int lastDifficultyIncrease = 0;
-        timeTrialTimer += 0.016f; // 16ms per frame
+// Hand the current world to display() (--sim-thread)
+void publishSnapshot(double tickStart)
+{
+    PROFILE_ZONE("publishSnapshot");
+
+    FrameSnapshot &snapshot = snapshots.writeBuffer();
+    snapshot.world = world;
+    snapshot.tickStart = tickStart;
+    snapshot.autopilot = autopilotEnabled;
+    snapshot.keysHandled = keysHandled;
+    snapshot.jumps = appliedJumps;
+    snapshots.publish();
+}
+
+void handleKey(const KeyEvent &event);
 
-        // Increase difficulty every 30 seconds
-        int currentTime = static_cast<int>(timeTrialTimer);
-        if (currentTime >= lastDifficultyIncrease + 30)
+// Apply the queued keys and run `ticks` ticks (as returned by simClock's
+// advance() at `now`), keeping the order in which keys and ticks were due: a
+// key is applied before the first tick due after it was pressed, and keys
+// pressed after the last tick at the end. Returns true if the world changed.
+bool advanceSimulation(double now, int ticks)
+{
+    bool changed = false;
+    KeyEvent event;
+    bool queued = keyQueue.pop(event);
+    double lastTickDue = now - simClock.alpha() * simClock.tickSeconds();
+    for (int i = 0; i < ticks; i++)
+    {
+        double due = lastTickDue - (ticks - 1 - i) * simClock.tickSeconds();
+        for (; queued && event.time <= due; queued = keyQueue.pop(event))
         {
-            lastDifficultyIncrease = currentTime;
-
-            // Use gentler difficulty scaling
-            int modeIndex = MODE_MEDIUM - 1;
-            currentPipeSpeed += modes[modeIndex].speedIncrease * 0.5f;                     // Half speed increase
-            currentGravity += modes[modeIndex].gravityIncrease * 0.3f;                     // 30% gravity increase
-            float newGapHeight = currentGapHeight - (modes[modeIndex].gapDecrease * 0.7f); // 70% gap decrease
-            currentGapHeight = (newGapHeight < MIN_GAP_HEIGHT) ? MIN_GAP_HEIGHT : newGapHeight;
-
-            printf("Time Trial difficulty increased at %d seconds\n", currentTime);
-            printf("New values - Speed: %.2f, Gravity: %.2f, Gap: %.2f\n",
-                   currentPipeSpeed, currentGravity, currentGapHeight);
+            handleKey(event);
+            keysHandled++;
+            changed = true;
         }
+        if (world.state != PLAYING)
+            break;
+        tick();
+        changed = true;
     }
-    // Update difficulty based on score for other modes
-    else if (score > 0 && score % DIFFICULTY_INTERVAL == 0)
+    for (; queued; queued = keyQueue.pop(event))
     {
-        int modeIndex = currentMode - 1;
-        float speedIncrease = (score / DIFFICULTY_INTERVAL) * modes[modeIndex].speedIncrease;
-        currentPipeSpeed = hasSlowMotion ? modes[modeIndex].pipeSpeed + speedIncrease * 0.5f : // Half speed if slow motion is active
-                               modes[modeIndex].pipeSpeed + speedIncrease;
-        currentGravity = modes[modeIndex].gravity + (score / DIFFICULTY_INTERVAL) * modes[modeIndex].gravityIncrease;
-        float newGapHeight = modes[modeIndex].gapHeight - (score / DIFFICULTY_INTERVAL) * modes[modeIndex].gapDecrease;
-        currentGapHeight = (newGapHeight < MIN_GAP_HEIGHT) ? MIN_GAP_HEIGHT : newGapHeight;
+        handleKey(event);
+        keysHandled++;
+        changed = true;
     }
+    return changed;
+}
 
-    ballSpeed += currentGravity;
-    ballY -= ballSpeed;
-
-    // Add new pipe every 100 frames
-    frameCount++;
-    if (frameCount % 100 == 0)
+// --sim-thread: apply the queued keys, run the ticks that are due and publish
+// the result, then sleep until the next tick is due (outside a game, until a
+// key arrives)
+void simulationLoop()
+{
+    while (simRunning)
     {
-        Pipe newPipe;
-        newPipe.x = WINDOW_WIDTH;
-        newPipe.gapY = rand() % (WINDOW_HEIGHT - (int)currentGapHeight - 100) + 50;
-        pipes.push_back(newPipe);
-
-        // 20% chance to spawn a power-up
-        if (rand() % 5 == 0)
+        bool changed = false;
+        if (tuningWatcher.changed())
         {
-            PowerUp powerUp;
-            powerUp.x = WINDOW_WIDTH;
-            powerUp.y = rand() % (WINDOW_HEIGHT - 100) + 50;
-            powerUp.type = rand() % 3; // Random power-up type
-            powerUp.active = true;
-            powerUps.push_back(powerUp);
+            reloadTuning();
+            changed = true;
         }
-    }
 
-    // Move pipes
-    for (auto &pipe : pipes)
-    {
-        pipe.x -= currentPipeSpeed;
+        double now = secondsSinceStartup();
+        int ticks = simClock.advance();
+        if (advanceSimulation(now, ticks))
+            changed = true;
+        if (changed)
+            publishSnapshot(now - simClock.alpha() * simClock.tickSeconds());
+
+        std::chrono::microseconds wait(50000);
+        if (world.state == PLAYING)
+            wait = std::chrono::microseconds(static_cast<long long>(simClock.secondsToNextTick() * 1e6));
+        std::unique_lock<std::mutex> lock(simWakeMutex);
+        simWake.wait_for(lock, wait, [] { return !simRunning || !keyQueue.empty(); });
     }
+}
 
-    // Remove off-screen pipes
-    if (!pipes.empty() && pipes.front().x + PIPE_WIDTH < 0)
-        pipes.erase(pipes.begin());
+void startSimulationThread()
+{
+    publishSnapshot(secondsSinceStartup());
+    snapshots.update();
+    simRunning = true;
+    simThread = std::thread(simulationLoop);
+}
 
-    // Move and check power-ups
-    for (auto it = powerUps.begin(); it != powerUps.end();)
+void stopSimulationThread()
+{
+    if (!simThread.joinable())
+        return;
     {
-        it->x -= POWER_UP_SPEED;
+        std::lock_guard<std::mutex> lock(simWakeMutex);
+        simRunning = false;
+    }
+    simWake.notify_all();
+    simThread.join();
+}
 
-        // Check collision with ball
-        float dx = 100.0f - it->x;
-        float dy = ballY - it->y;
-        float distance = sqrt(dx * dx + dy * dy);
+// Main loop: catch the simulation up to real time (or, with --sim-thread,
+// pick up its newest snapshot), then render once. The display refresh (or the
+// driver's vsync) paces the loop.
+void idle()
+{
+    // A profiler frame runs from one idle call to the next (ticks + display)
+    profiler.frameMark();
+    PROFILE_ZONE("idle");
 
-        if (distance < ballRadius + POWER_UP_RADIUS && it->active)
-        {
-            // Deactivate any existing power-up
-            if (activePowerUp != -1)
-            {
-                switch (activePowerUp)
-                {
-                case SHIELD:
-                    hasShield = false;
-                    break;
-                case SLOW_MOTION:
-                    hasSlowMotion = false;
-                    break;
-                case DOUBLE_POINTS:
-                    hasDoublePoints = false;
-                    break;
-                }
-            }
+    // Wait for this frame's slot first, so it draws the newest state
+    framePacer.waitForFrame();
 
-            // Activate new power-up
-            it->active = false;
-            powerUpTimer = POWER_UP_DURATION;
-            activePowerUp = it->type;
+    if (!assetsLoaded)
+        uploadLoadedAssets();
 
-            switch (it->type)
-            {
-            case SHIELD:
-                hasShield = true;
-                addParticles(100, ballY, 0.0f, 0.0f, 1.0f); // Blue particles for shield
-                playSound(powerupSound);
-                break;
-            case SLOW_MOTION:
-                hasSlowMotion = true;
-                addParticles(100, ballY, 0.0f, 1.0f, 0.0f); // Green particles for slow motion
-                playSound(powerupSound);
-                break;
-            case DOUBLE_POINTS:
-                hasDoublePoints = true;
-                addParticles(100, ballY, 1.0f, 1.0f, 0.0f); // Yellow particles for double points
-                playSound(powerupSound);
-                break;
-            }
-            it = powerUps.erase(it);
-        }
-        else if (it->x + POWER_UP_RADIUS < 0)
-        {
-            it = powerUps.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+    GameState state;
+    bool keysApplied = true; // The world on screen has seen every key
+    if (simThreadEnabled)
+    {
+        if (quitRequested)
+            exit(0);
+        if (snapshots.update())
+            redrawPending = true;
+        state = snapshots.readBuffer().world.state;
+        keysApplied = snapshots.readBuffer().keysHandled == keysSent;
     }
-
-    // Check collisions and score
-    float ballLeft = 100 - ballRadius;
-    float ballRight = 100 + ballRadius;
-    float ballTop = ballY + ballRadius;
-    float ballBottom = ballY - ballRadius;
-
-    for (auto &pipe : pipes)
+    else
     {
-        float pipeLeft = pipe.x;
-        float pipeRight = pipe.x + PIPE_WIDTH;
+        if (tuningWatcher.changed())
+            reloadTuning();
+
+        GameState stateBefore = world.state;
+        double now = secondsSinceStartup();
+        int ticks = simClock.advance();
+        advanceSimulation(now, ticks);
+        if (world.state != stateBefore)
+            redrawPending = true;
+        state = world.state;
+    }
 
-        // Horizontal overlap
-        if (ballRight > pipeLeft && ballLeft < pipeRight)
+    if (state != PLAYING && !showProfiler && !redrawPending && !framePacer.uncapped())
+    {
+        if (!assetsLoaded || !keysApplied)
         {
-            if (ballBottom < pipe.gapY || ballTop > pipe.gapY + currentGapHeight)
-            {
-                if (!hasShield)
-                {
-                    // Create red explosion effect on impact
-                    createExplosionEffect(100, ballY, 1.0f, 0.2f, 0.2f);
-                    loseLife(); // Use loseLife function
-                }
-            }
+            // Keep polling the loader (or waiting for the simulation thread)
+            // without redrawing
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return;
         }
 
-        // Score update
-        if (pipe.x + PIPE_WIDTH < 100 && pipe.x + PIPE_WIDTH + currentPipeSpeed >= 100)
-        {
-            score += hasDoublePoints ? 2 : 1;
-            // Create golden score effect
-            createScoreEffect(100, ballY);
-            playSound(scoreSound); // Play score sound
-        }
+        // Nothing moves; wait for input (requestRedraw) instead of spinning
+        glutIdleFunc(nullptr);
+        framePacer.reset();
+        return;
     }
+    glutPostRedisplay();
+}
+
+// Something visible changed outside the simulation (input, window size):
+// draw it and resume the main loop if it was asleep
+void requestRedraw()
+{
+    redrawPending = true;
+    glutIdleFunc(idle);
+    glutPostRedisplay();
+}
+
+void reshape(int width, int height)
+{
+    glViewport(0, 0, width, height);
+    requestRedraw();
+}
 
-    if (ballY < 0 || ballY + 30 > WINDOW_HEIGHT)
+// Start a new game in the given mode (in --replay mode, restart the replay)
+void startGame(GameMode mode)
+{
+    if (replayPath)
     {
-        // Create red explosion effect on boundary collision
-        createExplosionEffect(100, ballY, 1.0f, 0.2f, 0.2f);
-        loseLife(); // Use loseLife function
+        replayPlayer.start(world, loadedReplay);
     }
+    else
+    {
+        world.seed = newSeed();
+        resetWorld(world, mode);
+    }
+    pendingInput.jump = false;
+    autopilot.reset();
+    simClock.reset();
 
-    glutPostRedisplay();
-    glutTimerFunc(16, update, 0); // 60 FPS
+    if (recordPath && !replayPath)
+    {
+        beginRecording(recording, world);
+        recordingActive = true;
+    }
 }
 
-void keyboard(unsigned char key, [[maybe_unused]] int x, [[maybe_unused]] int y)
+// Leave the game. The simulation thread leaves that to the GLUT thread,
+// which stops it first.
+void quit()
 {
+    if (simThreadEnabled)
+        quitRequested = true;
+    else
+        exit(0);
+}
+
+// Apply a key to the world (on the thread that owns it)
+void handleKey(const KeyEvent &event)
+{
+    unsigned char key = event.key;
+
     // Handle game over state first
-    if (gameState == GAME_OVER)
+    if (world.state == GAME_OVER)
     {
         if (key == 'r' || key == 'R')
         {
-            resetGame();
-            gameState = PLAYING;
-            glutTimerFunc(16, update, 0);
-            glutPostRedisplay();
+            startGame(world.mode);
             return;
         }
         else if (key == 'm' || key == 'M')
         {
-            resetGame();
-            gameState = MENU;
-            currentMode = MODE_MENU;
-            glutPostRedisplay();
+            resetWorld(world, MODE_MENU);
             return;
         }
         else if (key == 27) // ESC
         {
-            exit(0);
+            quit();
+            return;
         }
     }
 
     // Handle other states
     if (key == 27) // ESC
     {
-        if (gameState == PLAYING || gameState == PAUSED)
+        if (world.state == PLAYING || world.state == PAUSED)
         {
-            gameState = MENU;
-            currentMode = MODE_MENU;
-            glutPostRedisplay();
+            saveRecording();
+            world.state = MENU;
+            world.mode = MODE_MENU;
             return;
         }
-        else if (gameState == MENU)
+        else if (world.state == MENU)
         {
-            exit(0);
+            quit();
+            return;
         }
     }
 
-    if (gameState == MENU)
+    if (world.state == MENU)
     {
         switch (key)
         {
         case '1':
-            currentMode = MODE_EASY;
-            gameState = PLAYING;
-            resetGame();
-            glutTimerFunc(16, update, 0);
+            startGame(MODE_EASY);
             break;
         case '2':
-            currentMode = MODE_MEDIUM;
-            gameState = PLAYING;
-            resetGame();
-            glutTimerFunc(16, update, 0);
+            startGame(MODE_MEDIUM);
             break;
         case '3':
-            currentMode = MODE_HARD;
-            gameState = PLAYING;
-            resetGame();
-            glutTimerFunc(16, update, 0);
+            startGame(MODE_HARD);
             break;
         case '4':
-            currentMode = MODE_TIME_TRIAL;
-            gameState = PLAYING;
-            resetGame();
-            glutTimerFunc(16, update, 0);
+            startGame(MODE_TIME_TRIAL);
             break;
         }
     }
 
     if (key == 'p' || key == 'P')
     {
-        if (gameState == PLAYING)
+        if (world.state == PLAYING)
         {
-            gameState = PAUSED;
+            world.state = PAUSED;
         }
-        else if (gameState == PAUSED)
+        else if (world.state == PAUSED)
         {
-            gameState = PLAYING;
-            glutTimerFunc(16, update, 0);
+            world.state = PLAYING;
+            simClock.reset();
         }
     }
 
+    if ((key == 'a' || key == 'A') && !replayPath)
+    {
+        autopilotEnabled = !autopilotEnabled;
+        printf("Autopilot %s\n", autopilotEnabled ? "on" : "off");
+    }
+
     if (key == 32) // Spacebar
     {
-        if (gameState == MENU)
+        if (world.state == MENU)
         {
             // Start the game in Easy mode when space is pressed in menu
-            currentMode = MODE_EASY;
-            gameState = PLAYING;
-            resetGame();
-            glutTimerFunc(16, update, 0);
+            startGame(MODE_EASY);
         }
-        else if (gameState == PLAYING)
+        else if (world.state == PLAYING && !replayPath)
         {
-            ballSpeed = POWER;
-            // Add jump particles
-            addParticles(100, ballY, 1.0f, 1.0f, 1.0f); // White particles for jumping
-            playSound(jumpSound);                       // Play jump sound
+            // Applied at the start of the next tick
+            if (!pendingInput.jump)
+                pendingJumpTime = event.time;
+            pendingInput.jump = true;
         }
     }
 
     // Game over handling moved to the top of the function
 }
 
+void keyboard(unsigned char key, [[maybe_unused]] int x, [[maybe_unused]] int y)
+{
+    KeyEvent event = {key, secondsSinceStartup()};
+
+    // Most keys change what is on screen
+    requestRedraw();
+
+    // Applied between ticks by idle() or the simulation thread
+    if (!keyQueue.push(event))
+        return;
+    keysSent++;
+    if (!simThreadEnabled)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(simWakeMutex);
+    }
+    simWake.notify_one();
+}
+
 void init()
 {
     // Set up OpenGL state
@@ -1090,270 +1097,241 @@ void init()
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    // Initialize game state
-    gameState = MENU;
-    currentMode = MODE_MENU;
-
-    // Initialize randomization
-    srand(static_cast<unsigned int>(time(0)));
-
-    // Initialize game systems
-    initClouds();
-    initAudio();
-
-    // Reset game objects
-    resetGame();
-}
+    // Enable alpha blending for overlays and sprites
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-void initClouds()
-{
-    clouds.clear();
-    for (int i = 0; i < MAX_CLOUDS; i++)
-    {
-        Cloud cloud;
-        cloud.x = rand() % WINDOW_WIDTH;
-        cloud.y = rand() % (WINDOW_HEIGHT / 2);
-        cloud.scale = 0.5f + (rand() % 100) / 100.0f;
-        cloud.speed = CLOUD_MIN_SPEED + (rand() % 100) * (CLOUD_MAX_SPEED - CLOUD_MIN_SPEED) / 100.0f;
-        clouds.push_back(cloud);
-    }
-}
+    // Initialize game systems (exports are silent)
+    if (!exportPath && !audio.init())
+        printf("No audio device found, sound is off\n");
+    assetLoader.start("assets");
 
-// Function to create an explosion effect
-void createExplosionEffect(float x, float y, float r, float g, float b)
-{
-    for (int i = 0; i < EXPLOSION_PARTICLE_COUNT; i++)
+    // Reset game objects (starts in the menu, or straight into the replay)
+    world.seed = newSeed();
+    resetWorld(world, MODE_MENU);
+    if (!replayPath && !recordPath)
     {
-        if (particles.size() < MAX_PARTICLES)
+        FILE *file = fopen(tuningPath, "r");
+        if (file)
         {
-            Particle p;
-            p.x = x;
-            p.y = y;
-            // Create a circular explosion pattern
-            float angle = (float)i / EXPLOSION_PARTICLE_COUNT * 2.0f * PI;
-            p.vx = cos(angle) * EXPLOSION_SPEED;
-            p.vy = sin(angle) * EXPLOSION_SPEED;
-            p.life = PARTICLE_LIFE;
-            p.r = r;
-            p.g = g;
-            p.b = b;
-            p.a = 1.0f;
-            particles.push_back(p);
+            fclose(file);
+            reloadTuning();
         }
+        tuningWatcher.watch(tuningPath);
     }
+    if (replayPath)
+        startGame(loadedReplay.mode);
 }
 
-// Function to create score collection effect
-void createScoreEffect(float x, float y)
+// --export: play the replay through display() into an offscreen buffer, one
+// frame every 1/exportFps seconds of game time, as fast as the CPU allows.
+// Ends a second after the game is over (or the replay runs out).
+int exportReplay()
 {
-    for (int i = 0; i < SCORE_PARTICLE_COUNT; i++)
-    {
-        if (particles.size() < MAX_PARTICLES)
-        {
-            Particle p;
-            p.x = x;
-            p.y = y;
-            // Create upward moving particles
-            float angle = (PI / 4.0f) + (PI / 2.0f) * ((float)rand() / RAND_MAX); // Spread between 45 and 135 degrees
-            float speed = PARTICLE_SPEED * (0.5f + ((float)rand() / RAND_MAX));   // Random speed variation
-            p.vx = cos(angle) * speed;
-            p.vy = sin(angle) * speed;
-            p.life = PARTICLE_LIFE;
-            // Gold color with slight variation
-            p.r = 1.0f;
-            p.g = 0.8f + ((float)rand() / RAND_MAX) * 0.2f;
-            p.b = 0.0f;
-            p.a = 1.0f;
-            particles.push_back(p);
-        }
-    }
-}
+    OffscreenContext context;
+    if (!context.create(WINDOW_WIDTH, WINDOW_HEIGHT))
+        return 1;
 
-void addParticles(float x, float y, float r, float g, float b)
-{
-    for (int i = 0; i < 5; i++)
+    FrameExporter exporter;
+    if (!exporter.open(exportPath, WINDOW_WIDTH, WINDOW_HEIGHT, exportFps))
     {
-        if (particles.size() < MAX_PARTICLES)
-        {
-            Particle p;
-            p.x = x;
-            p.y = y;
-            float angle = (rand() % 360) * 3.14159f / 180.0f;
-            p.vx = cos(angle) * PARTICLE_SPEED;
-            p.vy = sin(angle) * PARTICLE_SPEED;
-            p.life = PARTICLE_LIFE;
-            p.r = r;
-            p.g = g;
-            p.b = b;
-            p.a = 1.0f;
-            particles.push_back(p);
-        }
+        printf("Failed to open %s for export\n", exportPath);
+        return 1;
     }
-}
+    frameExporter = &exporter;
 
-void updateClouds()
-{
-    for (auto &cloud : clouds)
+    init();
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    while (!assetsLoaded)
     {
-        cloud.x -= cloud.speed;
-        if (cloud.x + 100 < 0)
-        {
-            cloud.x = WINDOW_WIDTH + 100;
-            cloud.y = rand() % (WINDOW_HEIGHT / 2);
-            cloud.scale = 0.5f + (rand() % 100) / 100.0f;
-        }
+        uploadLoadedAssets();
+        if (!assetsLoaded)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-}
 
-void updateParticles()
-{
-    for (auto it = particles.begin(); it != particles.end();)
+    auto start = std::chrono::steady_clock::now();
+    long long ticksRun = 0;
+    int framesAfterEnd = 0;
+    for (long long frame = 0; framesAfterEnd < exportFps; frame++)
     {
-        it->x += it->vx;
-        it->y += it->vy;
-        it->vy += 0.2f;  // Stronger gravity effect
-        it->vx *= 0.99f; // Air resistance
-        it->life--;
-        it->a = (it->life / PARTICLE_LIFE) * (it->life / PARTICLE_LIFE); // Quadratic fade out
-
-        if (it->life <= 0)
-        {
-            it = particles.erase(it);
-        }
-        else
+        // Game time of this frame, in ticks
+        double frameTicks = static_cast<double>(frame) * world.tickRate / exportFps;
+        while (ticksRun + 1 <= frameTicks && world.state == PLAYING)
         {
-            ++it;
+            tick();
+            ticksRun++;
         }
-    }
-}
+        exportAlpha = static_cast<float>(frameTicks - ticksRun);
+        if (world.state != PLAYING)
+            framesAfterEnd++;
 
-void drawCloud(float x, float y, float scale)
-{
-    glColor4f(1.0f, 1.0f, 1.0f, 0.7f);
-    float size = 30.0f * scale;
+        display();
+    }
 
-    // Draw multiple circles to create cloud shape
-    for (int i = 0; i < 3; i++)
+    frameExporter = nullptr;
+    bool written = exporter.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ExportStats stats = exporter.stats();
+    double videoSeconds = static_cast<double>(stats.frames) / exportFps;
+    printf("Exported %d frames (%.1f s at %d fps) to %s in %.2f s: %.1f frames/s, %.1fx real time\n",
+           stats.frames, videoSeconds, exportFps, exportPath, seconds, stats.frames / seconds,
+           videoSeconds / seconds);
+    printf("Renderer: %s; encoding %.1f ms, writing %.1f ms, renderer waited for a buffer %d times\n",
+           context.renderer(), stats.encodeMs, stats.writeMs, stats.rendererStalls);
+    if (!written)
     {
-        float offsetX = i * size * 0.7f;
-        float offsetY = (i % 2) * size * 0.2f;
-        drawCircle(x + offsetX, y + offsetY, size);
+        printf("Failed to write %s\n", exportPath);
+        return 1;
     }
+    return 0;
 }
 
-void drawParticle(const Particle &p)
+// Draw circular timer for power-ups
+void drawPowerUpTimer(float x, float y, float progress, int type)
 {
-    glColor4f(p.r, p.g, p.b, p.a);
-    drawCircle(p.x, p.y, 3.0f);
+    drawPowerUpTimerRing(batch, x, y, progress, type);
+
+    // Draw remaining time in seconds, capped at 99s
+    int secondsLeft = std::min(99, (static_cast<int>(drawnWorld->powerUpTimer) / 60) + 1);
+    powerUpSecondsText.setNumber("", secondsLeft, "s");
+    batch.color(1.0f, 1.0f, 1.0f);
+    powerUpSecondsText.draw(batch, fontAtlas, x - 10, y - POWER_UP_TIMER_INNER_RADIUS - 20);
 }
 
-// Draw circular timer for power-ups
-void drawPowerUpTimer(float x, float y, float progress, int type)
+int main(int argc, char **argv)
 {
-    const float outerRadius = 25.0f;
-    const float innerRadius = 20.0f;
+    startupTime = std::chrono::steady_clock::now();
 
-    // Draw outer circle (background)
-    glBegin(GL_TRIANGLE_STRIP);
-    glColor4f(0.2f, 0.2f, 0.2f, 0.5f);
-    for (int i = 0; i <= 360; i++)
+    // Physics rate, e.g. --tick-rate 120 (rendering is independent of it)
+    int tickRate = BASE_TICK_RATE;
+    for (int i = 1; i < argc; i++)
     {
-        float angle = i * PI / 180.0f;
-        float cos_val = cos(angle);
-        float sin_val = sin(angle);
-
-        glVertex2f(x + cos_val * innerRadius, y + sin_val * innerRadius);
-        glVertex2f(x + cos_val * outerRadius, y + sin_val * outerRadius);
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            tickRate = atoi(argv[++i]);
+            if (tickRate < 30 || tickRate > 1000)
+            {
+                printf("Unsupported tick rate, using %d Hz\n", BASE_TICK_RATE);
+                tickRate = BASE_TICK_RATE;
+            }
+        }
+        else if (strcmp(argv[i], "--render-stats") == 0)
+        {
+            showRenderStats = true;
+        }
+        else if (strcmp(argv[i], "--audio-stats") == 0)
+        {
+            showAudioStats = true;
+        }
+        else if (strcmp(argv[i], "--latency-stats") == 0)
+        {
+            showLatencyStats = true;
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            double fps = atof(argv[++i]);
+            if (fps < 1.0 || fps > 1000.0)
+            {
+                printf("Unsupported frame rate, using 60 fps\n");
+                fps = 60.0;
+            }
+            framePacer.setTargetFps(fps);
+        }
+        else if (strcmp(argv[i], "--uncapped") == 0)
+        {
+            framePacer.setTargetFps(0.0);
+        }
+        else if (strcmp(argv[i], "--profile") == 0)
+        {
+            showProfiler = true;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+            traceOnExit = true;
+        }
+        else if (strcmp(argv[i], "--trace-seconds") == 0 && i + 1 < argc)
+        {
+            traceSeconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--generated-levels") == 0)
+        {
+            world.levelFeed = &levelFeed;
+        }
+        else if (strcmp(argv[i], "--swept-collisions") == 0)
+        {
+            world.sweptCollisions = true;
+        }
+        else if (strcmp(argv[i], "--sim-thread") == 0)
+        {
+            simThreadEnabled = true;
+        }
+        else if (strcmp(argv[i], "--tuning") == 0 && i + 1 < argc)
+        {
+            tuningPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc)
+        {
+            exportPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--export-fps") == 0 && i + 1 < argc)
+        {
+            exportFps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+            if (!loadReplay(loadedReplay, replayPath))
+            {
+                printf("Failed to load replay %s\n", replayPath);
+                return 1;
+            }
+        }
     }
-    glEnd();
-
-    // Draw progress arc
-    glBegin(GL_TRIANGLE_STRIP);
-    switch (type)
+    if (replayPath)
     {
-    case SHIELD:
-        glColor4f(0.0f, 0.0f, 1.0f, 0.8f);
-        break;
-    case SLOW_MOTION:
-        glColor4f(0.0f, 1.0f, 0.0f, 0.8f);
-        break;
-    case DOUBLE_POINTS:
-        glColor4f(1.0f, 1.0f, 0.0f, 0.8f);
-        break;
+        // The replay decides the physics rate and the kind of levels
+        tickRate = loadedReplay.tickRate;
+        world.levelFeed = loadedReplay.generatedLevels ? &levelFeed : nullptr;
     }
+    world.tickRate = tickRate;
+    simClock.setTickRate(tickRate);
+    profiler.setEnabled(showProfiler || traceOnExit);
 
-    int progressDegrees = progress * 360;
-    for (int i = 0; i <= progressDegrees; i++)
+#ifndef _WIN32
+    if (framePacer.uncapped())
     {
-        float angle = i * PI / 180.0f;
-        float cos_val = cos(angle);
-        float sin_val = sin(angle);
-
-        glVertex2f(x + cos_val * innerRadius, y + sin_val * innerRadius);
-        glVertex2f(x + cos_val * outerRadius, y + sin_val * outerRadius);
+        // Ask the Mesa and NVIDIA drivers not to wait for vsync in the swap
+        // (unless the environment says otherwise)
+        setenv("vblank_mode", "0", 0);
+        setenv("__GL_SYNC_TO_VBLANK", "0", 0);
     }
-    glEnd();
+#endif
 
-    // Draw icon in the middle based on power-up type
-    glBegin(GL_POLYGON);
-    switch (type)
+    // GLUT options (e.g. -display) are left in argv by the loop above
+    if (!exportPath || getenv("DISPLAY"))
     {
-    case SHIELD:
-        // Draw shield icon
-        glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-        for (int i = 0; i < 360; i++)
-        {
-            if (i * PI / 180.0f > PI * 0.2f)
-            { // Create shield shape
-                float angle = i * PI / 180.0f;
-                glVertex2f(x + cos(angle) * (innerRadius * 0.6f),
-                           y + sin(angle) * (innerRadius * 0.6f));
-            }
-        }
-        break;
-
-    case SLOW_MOTION:
-        // Draw clock icon
-        glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-        for (int i = 0; i < 12; i++)
-        {
-            float angle = i * PI / 6.0f;
-            glVertex2f(x + cos(angle) * (innerRadius * 0.6f),
-                       y + sin(angle) * (innerRadius * 0.6f));
-        }
-        // Draw clock hands
-        glVertex2f(x, y);
-        glVertex2f(x + innerRadius * 0.4f, y);
-        glVertex2f(x, y + innerRadius * 0.3f);
-        break;
+        glutInit(&argc, argv);
+        glutInitialized = true;
+    }
 
-    case DOUBLE_POINTS:
-        // Draw star icon
-        glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
-        for (int i = 0; i < 5; i++)
+    if (exportPath)
+    {
+        // Frames are rendered at exact game times, in step with the ticks
+        simThreadEnabled = false;
+        if (!replayPath || exportFps <= 0)
         {
-            float angle = i * 2 * PI / 5.0f;
-            glVertex2f(x + cos(angle) * (innerRadius * 0.6f),
-                       y + sin(angle) * (innerRadius * 0.6f));
-            angle += PI / 5.0f;
-            glVertex2f(x + cos(angle) * (innerRadius * 0.3f),
-                       y + sin(angle) * (innerRadius * 0.3f));
+            printf("--export needs a --replay and a positive --export-fps\n");
+            return 1;
         }
-        break;
+        return exportReplay();
     }
-    glEnd();
-
-    // Draw remaining time in seconds, capped at 99s
-    char timeStr[16]; // Increased buffer size to safely handle any integer
-    int secondsLeft = std::min(99, (powerUpTimer / 60) + 1);
-    snprintf(timeStr, sizeof(timeStr), "%ds", secondsLeft);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    drawText(x - 10, y - innerRadius - 20, timeStr);
-}
 
-int main(int argc, char **argv)
-{
-    glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
     glutCreateWindow("Flappy Ball by Elmstaba");
@@ -1361,10 +1339,25 @@ int main(int argc, char **argv)
     init();
 
     glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
     glutKeyboardFunc(keyboard);
-    glutTimerFunc(16, update, 0); // Start the update timer for 60 FPS
+    glutSpecialFunc(specialKey);
+    glutIdleFunc(idle);
 
     atexit(cleanupAudio); // Register cleanup function
+    if (traceOnExit)
+        atexit(writeTrace);
+    if (showLatencyStats)
+        atexit(reportLatency);
+    if (framePacer.uncapped())
+        atexit(reportFrameTimes);
+
+    // Started last so it is stopped first on exit, before the audio it plays
+    if (simThreadEnabled)
+    {
+        startSimulationThread();
+        atexit(stopSimulationThread);
+    }
 
     glutMainLoop();
     return 0;
@@ -0,0 +1,25 @@
+#include "static_layer.h"
+
+#include <GL/freeglut.h>
+
+void StaticLayer::draw(BatchRenderer &renderer, int key, void (*record)())
+{
+    renderer.flush();
+
+    if (!built || key != builtKey)
+    {
+        if (!list)
+            list = glGenLists(1);
+
+        // Client-side arrays are copied into the list when it is compiled
+        glNewList(list, GL_COMPILE);
+        record();
+        renderer.flush();
+        glEndList();
+
+        built = true;
+        builtKey = key;
+    }
+
+    glCallList(list);
+}
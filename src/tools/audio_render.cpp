@@ -0,0 +1,233 @@
+// Offline audio renderer: plays a game's sound effects through an OpenAL
+// loopback device and writes the mix to a WAV file, as fast as the CPU
+// allows. The result can be diffed against a golden file to catch audio
+// regressions without a sound card.
+#include "audio_engine.h"
+#include "level_generator.h"
+#include "policy.h"
+#include "replay.h"
+#include "wav.h"
+#include "world.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <vector>
+
+static const int CHANNELS = 2;
+
+// Silence rendered after the last tick so the final sound can ring out
+// (the longest effect lasts half a second)
+static const double TAIL_SECONDS = 0.6;
+
+static void printUsage(const char *argv0)
+{
+    printf("Usage: %s [--replay FILE | --mode 1-4 --seed N --tick-rate HZ] [--out FILE.wav]\n", argv0);
+    printf("          [--rate HZ] [--compare GOLDEN.wav [--tolerance N]]\n");
+    printf("  --replay     Render the sounds of a recorded game\n");
+    printf("  --mode       Without a replay, play one game with the scripted player, default 2\n");
+    printf("  --seed       World seed for the scripted game, default 1\n");
+    printf("  --tick-rate  Simulation steps per second for the scripted game, default %d\n", BASE_TICK_RATE);
+    printf("  --out        WAV file to write, default none\n");
+    printf("  --rate       Output sample rate, default 44100\n");
+    printf("  --compare    Fail unless the render matches this WAV file\n");
+    printf("  --tolerance  Largest per-sample difference still counted as a match, default 0\n");
+}
+
+// Compare two renders sample by sample; prints the first difference
+static bool matchesGolden(const std::vector<short> &samples, int sampleRate, const char *path, int tolerance)
+{
+    WavData golden;
+    if (!loadWav(golden, path))
+    {
+        printf("Failed to load golden file %s\n", path);
+        return false;
+    }
+    if (golden.channels != CHANNELS || golden.sampleRate != sampleRate)
+    {
+        printf("MISMATCH: golden file is %d Hz, %d channels\n", golden.sampleRate, golden.channels);
+        return false;
+    }
+    if (golden.samples.size() != samples.size())
+    {
+        printf("MISMATCH: golden file has %zu frames, render has %zu\n",
+               golden.samples.size() / CHANNELS, samples.size() / CHANNELS);
+        return false;
+    }
+
+    int maxDifference = 0;
+    size_t firstDifference = samples.size();
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        int difference = abs(samples[i] - golden.samples[i]);
+        if (difference > tolerance && firstDifference == samples.size())
+            firstDifference = i;
+        if (difference > maxDifference)
+            maxDifference = difference;
+    }
+    if (firstDifference < samples.size())
+    {
+        printf("MISMATCH: frame %zu (%.3f s) differs by more than %d, largest difference %d\n",
+               firstDifference / CHANNELS, (double)(firstDifference / CHANNELS) / sampleRate,
+               tolerance, maxDifference);
+        return false;
+    }
+    printf("Matches %s (largest difference %d)\n", path, maxDifference);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int mode = MODE_MEDIUM;
+    int tickRate = BASE_TICK_RATE;
+    uint64_t seed = 1;
+    int sampleRate = 44100;
+    int tolerance = 0;
+    const char *replayPath = nullptr;
+    const char *outPath = nullptr;
+    const char *goldenPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+        {
+            mode = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            tickRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+        {
+            sampleRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+        {
+            goldenPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+        {
+            tolerance = atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mode < MODE_EASY || mode > MODE_TIME_TRIAL || tickRate <= 0 || sampleRate <= 0 || tolerance < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    World world;
+    Replay replay;
+    ReplayPlayer player;
+    LevelFeed levelFeed(false); // Generated levels come out the same without a worker thread
+    if (replayPath)
+    {
+        if (!loadReplay(replay, replayPath))
+        {
+            printf("Failed to load replay %s\n", replayPath);
+            return 1;
+        }
+        if (replay.generatedLevels)
+            world.levelFeed = &levelFeed;
+        player.start(world, replay);
+        tickRate = replay.tickRate;
+    }
+    else
+    {
+        world.tickRate = tickRate;
+        world.seed = seed;
+        resetWorld(world, static_cast<GameMode>(mode));
+    }
+
+    AudioEngine audio;
+    if (!audio.initLoopback(sampleRate))
+    {
+        printf("OpenAL has no loopback device (ALC_SOFT_loopback) at %d Hz\n", sampleRate);
+        return 1;
+    }
+    audio.generateSounds();
+
+    // Sounds start on tick boundaries: each tick's requests are started, then
+    // the audio up to the next tick is mixed
+    std::vector<short> samples;
+    long long framesRendered = 0;
+    double mixSeconds = 0.0;
+    int ticks = 0;
+
+    auto render = [&](long long frames) {
+        size_t offset = samples.size();
+        samples.resize(offset + static_cast<size_t>(frames) * CHANNELS);
+        auto mixStart = std::chrono::steady_clock::now();
+        audio.update();
+        audio.render(&samples[offset], static_cast<int>(frames));
+        mixSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - mixStart).count();
+        framesRendered += frames;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The scripted player survives for a very long time on easier modes, so
+    // stop after ten minutes of game time
+    while (replayPath ? !player.finished() : world.state == PLAYING && ticks < tickRate * 600)
+    {
+        step(world, replayPath ? player.next() : scriptedPolicy(world));
+        audio.playEvents(world.events);
+        ticks++;
+        render(static_cast<long long>(ticks) * sampleRate / tickRate - framesRendered);
+    }
+    render(static_cast<long long>(TAIL_SECONDS * sampleRate));
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double audioSeconds = (double)framesRendered / sampleRate;
+    AudioStats stats = audio.stats();
+    audio.shutdown();
+
+    printf("Rendered %.1f s of audio (%d ticks at %d Hz, score %d) in %.3f s, %.0fx real time\n",
+           audioSeconds, ticks, tickRate, world.score, seconds, audioSeconds / seconds);
+    printf("Mixing: %.3f s total, %.2f us per tick, %.2f ms per second of audio\n",
+           mixSeconds, ticks ? mixSeconds * 1e6 / ticks : 0.0, mixSeconds * 1000.0 / audioSeconds);
+    printf("Voices: %lld played, %lld stolen, %lld dropped\n", stats.played, stats.stolen, stats.dropped);
+
+    // A replay that played out differently has the wrong sound track, so it
+    // must not pass a golden comparison
+    bool replayMatches = true;
+    if (replayPath && replay.finalHash != 0 && worldHash(world) != replay.finalHash)
+    {
+        printf("MISMATCH: state hash %016llx, recorded %016llx\n",
+               static_cast<unsigned long long>(worldHash(world)), static_cast<unsigned long long>(replay.finalHash));
+        replayMatches = false;
+    }
+
+    if (outPath)
+    {
+        if (!saveWav(outPath, samples.data(), static_cast<size_t>(framesRendered), CHANNELS, sampleRate))
+        {
+            printf("Failed to write %s\n", outPath);
+            return 1;
+        }
+        printf("Wrote %s\n", outPath);
+    }
+
+    if (goldenPath && !matchesGolden(samples, sampleRate, goldenPath, tolerance))
+        return 1;
+    return replayMatches ? 0 : 1;
+}
@@ -0,0 +1,448 @@
+// Monte Carlo batch runner: plays thousands of games per difficulty setting on
+// every core and reports survival-time and score distributions, for tuning the
+// modes[] table without hand playtesting.
+#include "world.h"
+#include "level_generator.h"
+#include "planner.h"
+#include "policy.h"
+#include "tuning.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char *modeNames[] = {"Menu", "Easy", "Medium", "Hard", "Time Trial"};
+
+enum PolicyKind
+{
+    POLICY_SCRIPTED,
+    POLICY_RANDOM,
+    POLICY_AUTOPILOT
+};
+
+static const char *policyNames[] = {"scripted", "random", "autopilot"};
+
+// A DifficultySettings field that can be swept from the command line
+struct SweepParam
+{
+    const char *name;
+    void (*set)(DifficultySettings &settings, float value);
+};
+
+static const SweepParam sweepParams[] = {
+    {"pipeSpeed", [](DifficultySettings &s, float v) { s.pipeSpeed = v; }},
+    {"gapHeight", [](DifficultySettings &s, float v) { s.gapHeight = v; }},
+    {"gravity", [](DifficultySettings &s, float v) { s.gravity = v; }},
+    {"spawnInterval", [](DifficultySettings &s, float v) { s.spawnInterval = static_cast<int>(v); }},
+    {"speedIncrease", [](DifficultySettings &s, float v) { s.speedIncrease = v; }},
+    {"gapDecrease", [](DifficultySettings &s, float v) { s.gapDecrease = v; }},
+    {"gravityIncrease", [](DifficultySettings &s, float v) { s.gravityIncrease = v; }},
+};
+
+struct Sweep
+{
+    const SweepParam *param = nullptr;
+    float from = 0.0f, to = 0.0f, stepSize = 0.0f;
+};
+
+// One mode, optionally with a swept parameter overridden
+struct Config
+{
+    GameMode mode;
+    DifficultySettings settings;
+    const SweepParam *param;
+    float value;
+};
+
+struct GameResult
+{
+    int ticks;
+    int score;
+    int worker;
+    bool capped;     // Still alive when --max-ticks ran out
+    bool impossible; // Autopilot: met pipes that no jump schedule survives
+};
+
+static void printUsage(const char *argv0)
+{
+    printf("Usage: %s [--games N] [--modes LIST] [--policy scripted|random|autopilot]\n", argv0);
+    printf("          [--noise P] [--jump-chance P] [--max-ticks N] [--tick-rate HZ] [--threads N]\n");
+    printf("          [--sweep NAME=FROM:TO:STEP] [--seed N] [--grain N] [--tuning FILE] [--generated-levels]\n");
+    printf("          [--swept-collisions]\n");
+    printf("  --games        Games per configuration, default 2000\n");
+    printf("  --modes        Comma-separated modes (1: Easy, 2: Medium, 3: Hard, 4: Time Trial), default 1,2,3,4\n");
+    printf("  --policy       scripted: chase the next gap, random: jump at random, autopilot: follow\n");
+    printf("                 planned jumps and report pipe sequences that cannot be survived, default scripted\n");
+    printf("  --noise        Chance per tick that the scripted policy makes the wrong call, default 0.005\n");
+    printf("  --jump-chance  Chance per tick that the random policy jumps, default 0.06\n");
+    printf("  --max-ticks    Stop a game that is still alive after N ticks, default 10 minutes\n");
+    printf("  --tick-rate    Simulation steps per second, default %d\n", BASE_TICK_RATE);
+    printf("  --threads      Worker threads, default one per core\n");
+    printf("  --sweep        Vary one difficulty field per mode, e.g. gravity=0.3:0.6:0.05\n");
+    printf("                 Fields:");
+    for (const auto &param : sweepParams)
+        printf(" %s", param.name);
+    printf("\n");
+    printf("  --seed         Base seed for the worlds and the policy randomness, default 1\n");
+    printf("  --grain        Games a worker takes from its queue at a time, default 4\n");
+    printf("  --tuning       Tuning config to play with instead of the built-in values\n");
+    printf("  --generated-levels\n");
+    printf("                 Spawn from the level generator (reachable gaps, see level_generator.h)\n");
+    printf("  --swept-collisions\n");
+    printf("                 Test collisions along each step instead of at its end (for low tick rates)\n");
+}
+
+static bool parseSweep(const char *arg, Sweep &sweep)
+{
+    const char *eq = strchr(arg, '=');
+    if (!eq)
+        return false;
+
+    std::string name(arg, eq);
+    for (const auto &param : sweepParams)
+    {
+        if (name == param.name)
+            sweep.param = &param;
+    }
+    if (!sweep.param)
+        return false;
+
+    if (sscanf(eq + 1, "%f:%f:%f", &sweep.from, &sweep.to, &sweep.stepSize) != 3)
+        return false;
+    return sweep.stepSize > 0.0f && sweep.to >= sweep.from;
+}
+
+static bool parseModes(const char *arg, std::vector<GameMode> &modeList)
+{
+    modeList.clear();
+    for (const char *p = arg; *p;)
+    {
+        int mode = atoi(p);
+        if (mode < MODE_EASY || mode > MODE_TIME_TRIAL)
+            return false;
+        modeList.push_back(static_cast<GameMode>(mode));
+        p = strchr(p, ',');
+        if (!p)
+            break;
+        p++;
+    }
+    return !modeList.empty();
+}
+
+// Nearest-rank percentile of an ascending array
+template <typename T>
+static T percentile(const std::vector<T> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+template <typename T>
+static void printDistribution(const char *label, const std::vector<T> &sorted, double scale)
+{
+    double sum = 0.0;
+    for (T v : sorted)
+        sum += v;
+    printf("  %-13s mean %8.2f  p10 %8.2f  p25 %8.2f  p50 %8.2f  p75 %8.2f  p90 %8.2f  p99 %8.2f  max %8.2f\n",
+           label, sum / sorted.size() * scale,
+           percentile(sorted, 10) * scale, percentile(sorted, 25) * scale, percentile(sorted, 50) * scale,
+           percentile(sorted, 75) * scale, percentile(sorted, 90) * scale, percentile(sorted, 99) * scale,
+           sorted.back() * scale);
+}
+
+template <typename T>
+static void printHistogram(const char *label, const std::vector<T> &sorted, double scale)
+{
+    const int BINS = 10;
+    const int BAR_WIDTH = 40;
+
+    double top = sorted.back() * scale;
+    double binWidth = top > 0.0 ? top / BINS : 1.0;
+    int counts[BINS] = {};
+    for (T v : sorted)
+    {
+        int bin = static_cast<int>(v * scale / binWidth);
+        counts[bin < BINS ? bin : BINS - 1]++;
+    }
+    int largest = *std::max_element(counts, counts + BINS);
+
+    printf("  %s histogram:\n", label);
+    for (int b = 0; b < BINS; b++)
+    {
+        int bar = largest ? (counts[b] * BAR_WIDTH + largest - 1) / largest : 0;
+        printf("    [%8.2f, %8.2f%c %-*s %d\n", b * binWidth, (b + 1) * binWidth,
+               b == BINS - 1 ? ']' : ')', BAR_WIDTH, std::string(bar, '#').c_str(), counts[b]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int gamesPerConfig = 2000;
+    std::vector<GameMode> modeList = {MODE_EASY, MODE_MEDIUM, MODE_HARD, MODE_TIME_TRIAL};
+    PolicyKind policy = POLICY_SCRIPTED;
+    float noise = 0.005f;
+    float jumpChance = 0.06f;
+    int tickRate = BASE_TICK_RATE;
+    int maxTicks = -1;
+    int threadCount = 0;
+    unsigned int seed = 1;
+    int grain = 4;
+    Sweep sweep;
+    Tuning tuning = DEFAULT_TUNING;
+    bool generatedLevels = false;
+    bool sweptCollisions = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && hasValue)
+        {
+            gamesPerConfig = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--modes") == 0 && hasValue)
+        {
+            if (!parseModes(argv[++i], modeList))
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--policy") == 0 && hasValue)
+        {
+            const char *name = argv[++i];
+            if (strcmp(name, "scripted") == 0)
+                policy = POLICY_SCRIPTED;
+            else if (strcmp(name, "random") == 0)
+                policy = POLICY_RANDOM;
+            else if (strcmp(name, "autopilot") == 0)
+                policy = POLICY_AUTOPILOT;
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--noise") == 0 && hasValue)
+        {
+            noise = static_cast<float>(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--jump-chance") == 0 && hasValue)
+        {
+            jumpChance = static_cast<float>(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--max-ticks") == 0 && hasValue)
+        {
+            maxTicks = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && hasValue)
+        {
+            tickRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            threadCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sweep") == 0 && hasValue)
+        {
+            if (!parseSweep(argv[++i], sweep))
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--grain") == 0 && hasValue)
+        {
+            grain = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tuning") == 0 && hasValue)
+        {
+            std::string error;
+            if (!loadTuning(tuning, argv[++i], error))
+            {
+                printf("%s\n", error.c_str());
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--generated-levels") == 0)
+        {
+            generatedLevels = true;
+        }
+        else if (strcmp(argv[i], "--swept-collisions") == 0)
+        {
+            sweptCollisions = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (maxTicks < 0)
+        maxTicks = tickRate * 60 * 10;
+
+    if (gamesPerConfig <= 0 || tickRate <= 0 || maxTicks <= 0 || grain <= 0 || threadCount < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Every mode, crossed with every sweep value when sweeping
+    std::vector<Config> configs;
+    for (GameMode mode : modeList)
+    {
+        if (!sweep.param)
+        {
+            configs.push_back(Config{mode, tuning.modes[mode - 1], nullptr, 0.0f});
+            continue;
+        }
+        int steps = static_cast<int>((sweep.to - sweep.from) / sweep.stepSize + 1e-3f);
+        for (int s = 0; s <= steps; s++)
+        {
+            Config config{mode, tuning.modes[mode - 1], sweep.param, sweep.from + s * sweep.stepSize};
+            sweep.param->set(config.settings, config.value);
+            configs.push_back(config);
+        }
+    }
+
+    WorkStealingPool pool(threadCount);
+
+    // One world per worker, each in its own allocation so hot state of
+    // neighbouring workers never shares a cache line
+    std::vector<std::unique_ptr<World>> worlds;
+    for (int w = 0; w < pool.threadCount(); w++)
+    {
+        worlds.emplace_back(new World());
+        worlds.back()->tickRate = tickRate;
+        worlds.back()->tuning = tuning;
+        worlds.back()->sweptCollisions = sweptCollisions;
+    }
+    std::vector<std::unique_ptr<Autopilot>> autopilots;
+    for (int w = 0; w < pool.threadCount(); w++)
+        autopilots.emplace_back(new Autopilot());
+
+    // Generated inline: the pool already keeps every core busy
+    std::vector<std::unique_ptr<LevelFeed>> levelFeeds;
+    for (int w = 0; w < pool.threadCount() && generatedLevels; w++)
+    {
+        levelFeeds.emplace_back(new LevelFeed(false));
+        worlds[w]->levelFeed = levelFeeds.back().get();
+    }
+
+    // Flatten (config, game) so long and short configurations balance together
+    int totalGames = static_cast<int>(configs.size()) * gamesPerConfig;
+    std::vector<GameResult> results(totalGames);
+
+    printf("Playing %d games (%d configurations x %d) on %d threads, %s policy%s%s\n",
+           totalGames, static_cast<int>(configs.size()), gamesPerConfig, pool.threadCount(),
+           policyNames[policy], generatedLevels ? ", generated levels" : "",
+           sweptCollisions ? ", swept collisions" : "");
+
+    auto start = std::chrono::steady_clock::now();
+
+    pool.parallelFor(totalGames, [&](int index, int worker) {
+        const Config &config = configs[index / gamesPerConfig];
+        World &world = *worlds[worker];
+        std::minstd_rand rng(seed * 2654435761u + static_cast<unsigned int>(index) + 1u);
+        std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+        // Seeded by game index, so results do not depend on the thread count
+        world.seed = (static_cast<uint64_t>(seed) << 32) | static_cast<unsigned int>(index);
+        resetWorld(world, config.mode, config.settings);
+        Autopilot &autopilot = *autopilots[worker];
+        autopilot.reset();
+        int impossibleBefore = autopilot.impossiblePlans();
+        int ticks = 0;
+        while (world.state == PLAYING && ticks < maxTicks)
+        {
+            Input input;
+            if (policy == POLICY_SCRIPTED)
+            {
+                input = scriptedPolicy(world);
+                if (chance(rng) < noise)
+                    input.jump = !input.jump;
+            }
+            else if (policy == POLICY_RANDOM)
+            {
+                input.jump = chance(rng) < jumpChance;
+            }
+            else
+            {
+                input = autopilot.next(world);
+            }
+            step(world, input);
+            ticks++;
+        }
+
+        GameResult &result = results[index];
+        result.ticks = ticks;
+        result.score = world.score;
+        result.worker = worker;
+        result.capped = world.state == PLAYING;
+        result.impossible = autopilot.impossiblePlans() != impossibleBefore;
+    }, grain);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long totalTicks = 0;
+    std::vector<long long> workerTicks(pool.threadCount(), 0);
+    for (const auto &result : results)
+    {
+        totalTicks += result.ticks;
+        workerTicks[result.worker] += result.ticks;
+    }
+
+    for (size_t c = 0; c < configs.size(); c++)
+    {
+        const Config &config = configs[c];
+        std::vector<int> survival, scores;
+        int capped = 0;
+        int impossible = 0;
+        for (int g = 0; g < gamesPerConfig; g++)
+        {
+            const GameResult &result = results[c * gamesPerConfig + g];
+            survival.push_back(result.ticks);
+            scores.push_back(result.score);
+            capped += result.capped;
+            impossible += result.impossible;
+        }
+        std::sort(survival.begin(), survival.end());
+        std::sort(scores.begin(), scores.end());
+
+        printf("\n== %s", modeNames[config.mode]);
+        if (config.param)
+            printf(", %s = %g", config.param->name, config.value);
+        printf(" ==  %d games", gamesPerConfig);
+        if (capped)
+            printf(", %d still alive at %d ticks", capped, maxTicks);
+        if (policy == POLICY_AUTOPILOT)
+            printf(", %d met a pipe sequence with no surviving jumps", impossible);
+        printf("\n");
+
+        printDistribution("survival (s)", survival, 1.0 / tickRate);
+        printDistribution("score", scores, 1.0);
+        printHistogram("survival (s)", survival, 1.0 / tickRate);
+        printHistogram("score", scores, 1.0);
+    }
+
+    long long busiest = *std::max_element(workerTicks.begin(), workerTicks.end());
+    long long idlest = *std::min_element(workerTicks.begin(), workerTicks.end());
+
+    printf("\nPlayed %d games, %lld ticks in %.3f s on %d threads\n",
+           totalGames, totalTicks, seconds, pool.threadCount());
+    printf("Throughput: %.0f games/s, %.0f ticks/s, %.0f ticks/s per thread\n",
+           totalGames / seconds, totalTicks / seconds, totalTicks / seconds / pool.threadCount());
+    printf("Worker load: %lld to %lld ticks per thread\n", idlest, busiest);
+    return 0;
+}
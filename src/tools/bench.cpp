@@ -0,0 +1,858 @@
+// Benchmarks for the simulation and render-command generation. Prints a
+// table, optionally writes the results as JSON, and compares them against
+// stored baselines so a regression fails the run (non-zero exit code).
+#include "world.h"
+#include "level_generator.h"
+#include "planner.h"
+#include "policy.h"
+#include "vec_env.h"
+#include "particle_pool.h"
+#include "vertex_batch.h"
+#include "world_scene.h"
+#include "glyph_atlas.h"
+#include "triple_buffer.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Keeps results alive so the optimizer cannot drop the measured work
+static volatile float benchSink;
+
+// Timing starts before a benchmark runs; benchmarks with setup work restart
+// it once the setup is done
+struct BenchTimer
+{
+    std::chrono::steady_clock::time_point begin;
+    void start() { begin = std::chrono::steady_clock::now(); }
+};
+
+struct Benchmark
+{
+    const char *name;
+    const char *description;
+    // Runs `iterations` operations and returns how many were performed (some
+    // benchmarks count particles or circles rather than calls)
+    std::function<long long(long long iterations, BenchTimer &timer)> run;
+};
+
+struct BenchResult
+{
+    std::string name;
+    double nsPerOp;
+    long long iterations;
+};
+
+static double secondsSince(const BenchTimer &timer)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - timer.begin).count();
+}
+
+// Grow the iteration count until one sample takes `sampleSeconds`, then take
+// the fastest of `samples` samples (interference from other processes only
+// ever makes a sample slower, so the minimum is the most repeatable figure)
+static BenchResult measure(const Benchmark &bench, double sampleSeconds, int samples)
+{
+    long long iterations = 1;
+    for (;;)
+    {
+        BenchTimer timer;
+        timer.start();
+        bench.run(iterations, timer);
+        double seconds = secondsSince(timer);
+        if (seconds >= sampleSeconds || iterations >= (1LL << 40))
+            break;
+        double grow = seconds > 0.0 ? sampleSeconds / seconds * 1.2 : 100.0;
+        iterations = static_cast<long long>(iterations * std::min(100.0, std::max(2.0, grow)));
+    }
+
+    std::vector<double> perOp;
+    for (int s = 0; s < samples; s++)
+    {
+        BenchTimer timer;
+        timer.start();
+        long long ops = bench.run(iterations, timer);
+        perOp.push_back(secondsSince(timer) * 1e9 / std::max(1LL, ops));
+    }
+    BenchResult result;
+    result.name = bench.name;
+    result.nsPerOp = *std::min_element(perOp.begin(), perOp.end());
+    result.iterations = iterations;
+    return result;
+}
+
+// Step a world with the scripted player until it is mid-game with pipes,
+// power-ups and particles on screen
+static void warmUpWorld(World &world, GameMode mode, uint64_t seed, int ticks)
+{
+    world.seed = seed;
+    resetWorld(world, mode);
+    for (int t = 0; t < ticks; t++)
+    {
+        step(world, scriptedPolicy(world));
+        if (world.state != PLAYING)
+        {
+            world.seed++;
+            resetWorld(world, mode);
+        }
+    }
+}
+
+// Keep the pool topped up to `count` live particles with staggered lifetimes
+static void fillParticles(ParticlePool &pool, int count, unsigned int &seed)
+{
+    while (pool.size() < count)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float vx = ((seed >> 8) & 0xFFFF) / 65535.0f * 10.0f - 5.0f;
+        float vy = ((seed >> 16) & 0xFFFF) / 65535.0f * 10.0f - 5.0f;
+        pool.spawn(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, vx, vy, 1.0f, 0.8f, 0.0f);
+    }
+}
+
+// Entity updates at scale. A busy game holds about 16 scrolling entities (5
+// clouds, a few power-ups); these run 10x and 100x that, half of each kind,
+// through the same work as step(): everything scrolls, clouds wrap around,
+// power-ups are collected or leave the screen (and are replaced here, to keep
+// the count).
+
+// The per-type vectors the game used before the entity tables
+struct VectorPowerUp
+{
+    float x;
+    float y;
+    int type;
+    bool active;
+    float prevX;
+};
+
+struct VectorCloud
+{
+    float x, y;
+    float scale;
+    float speed;
+    float prevX;
+};
+
+struct VectorEntities
+{
+    std::vector<VectorPowerUp> powerUps;
+    std::vector<VectorCloud> clouds;
+};
+
+struct TableEntities
+{
+    PowerUpTable powerUps;
+    CloudTable clouds;
+};
+
+// Spread over the screen, so a few leave it on every tick
+static float entityX(int i, int count)
+{
+    return static_cast<float>(WINDOW_WIDTH) * i / count;
+}
+
+static float entityY(int i)
+{
+    return 50.0f + (i * 53) % (WINDOW_HEIGHT - 100);
+}
+
+static void fillEntities(VectorEntities &entities, int count)
+{
+    for (int i = 0; i < count / 2; i++)
+    {
+        float x = entityX(i, count / 2);
+        entities.powerUps.push_back(VectorPowerUp{x, entityY(i), i % 3, true, x});
+        entities.clouds.push_back(VectorCloud{x, entityY(i) / 2, 1.0f, CLOUD_MIN_SPEED + (i % 4) * 0.25f, x});
+    }
+}
+
+static void fillEntities(TableEntities &entities, int count)
+{
+    for (int i = 0; i < count / 2; i++)
+    {
+        float x = entityX(i, count / 2);
+        entities.powerUps.add(Scroll{x, x, POWER_UP_SPEED}, PowerUpBody{entityY(i), i % 3});
+        entities.clouds.add(Scroll{x, x, CLOUD_MIN_SPEED + (i % 4) * 0.25f}, CloudBody{entityY(i) / 2, 1.0f});
+    }
+}
+
+static int updateEntities(VectorEntities &entities, float ballY)
+{
+    for (auto &cloud : entities.clouds)
+    {
+        cloud.prevX = cloud.x;
+        cloud.x -= cloud.speed;
+        if (cloud.x + 100 < 0)
+            cloud.x = cloud.prevX = WINDOW_WIDTH + 100;
+    }
+
+    int removed = 0;
+    for (auto it = entities.powerUps.begin(); it != entities.powerUps.end();)
+    {
+        it->prevX = it->x;
+        it->x -= POWER_UP_SPEED;
+        if ((it->active && ballTouchesPowerUp(ballY, it->x, it->y)) || it->x + POWER_UP_RADIUS < 0)
+        {
+            it = entities.powerUps.erase(it);
+            removed++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (int i = 0; i < removed; i++)
+        entities.powerUps.push_back(VectorPowerUp{WINDOW_WIDTH, entityY(i), i % 3, true, WINDOW_WIDTH});
+    return removed;
+}
+
+static void wrapClouds(CloudTable &clouds)
+{
+    Scroll *scroll = clouds.column<Scroll>();
+    for (int i = 0; i < clouds.size(); i++)
+    {
+        if (scroll[i].x + 100 < 0)
+            scroll[i].x = scroll[i].prevX = WINDOW_WIDTH + 100;
+    }
+}
+
+static int collectPowerUps(PowerUpTable &powerUps, float ballY)
+{
+    const Scroll *scroll = powerUps.column<Scroll>();
+    const PowerUpBody *body = powerUps.column<PowerUpBody>();
+    int count = powerUps.size();
+    powerUps.removeIf([&](int i) {
+        return ballTouchesPowerUp(ballY, scroll[i].x, body[i].y) || scroll[i].x + POWER_UP_RADIUS < 0;
+    });
+    int removed = count - powerUps.size();
+    for (int i = 0; i < removed; i++)
+        powerUps.add(Scroll{WINDOW_WIDTH, WINDOW_WIDTH, POWER_UP_SPEED}, PowerUpBody{entityY(i), i % 3});
+    return removed;
+}
+
+static int updateEntities(TableEntities &entities, float ballY)
+{
+    scrollEntities(entities.clouds, 1.0f);
+    wrapClouds(entities.clouds);
+    scrollEntities(entities.powerUps, 1.0f);
+    return collectPowerUps(entities.powerUps, ballY);
+}
+
+static std::function<long long(long long, BenchTimer &)> entityBench(int count, bool tables)
+{
+    return [count, tables](long long iterations, BenchTimer &timer) {
+        VectorEntities vectors;
+        TableEntities table;
+        if (tables)
+            fillEntities(table, count);
+        else
+            fillEntities(vectors, count);
+        long long removed = 0;
+        timer.start();
+        for (long long i = 0; i < iterations; i++)
+        {
+            float ballY = 100.0f + (i % 400);
+            removed += tables ? updateEntities(table, ballY) : updateEntities(vectors, ballY);
+        }
+        benchSink = static_cast<float>(removed);
+        return iterations * count;
+    };
+}
+
+// update() of a pool holding `count` live particles; lifetimes are staggered
+// so a 60th of the pool expires and respawns every frame
+static std::function<long long(long long, BenchTimer &)> particleBench(int count)
+{
+    return [count](long long iterations, BenchTimer &timer) {
+        ParticlePool pool(count);
+        unsigned int seed = 12345;
+        for (int f = 0; f < static_cast<int>(PARTICLE_LIFE); f++)
+        {
+            pool.update(1.0f);
+            fillParticles(pool, std::min(count, (f + 1) * count / static_cast<int>(PARTICLE_LIFE)), seed);
+        }
+        long long updated = 0;
+        timer.start();
+        for (long long i = 0; i < iterations; i++)
+        {
+            updated += pool.size();
+            pool.update(1.0f);
+            fillParticles(pool, count, seed);
+        }
+        benchSink = pool.x(0);
+        return updated;
+    };
+}
+
+// Glyph atlas with made-up metrics in the size range of the GLUT fonts (the
+// real ones need a GL context); layout cost does not depend on the bitmaps
+static void layoutSyntheticAtlas(GlyphAtlas &atlas)
+{
+    const int lineHeights[FONT_COUNT] = {15, 22, 28};
+    const int widest[FONT_COUNT] = {12, 17, 23};
+    int advances[FONT_COUNT][GLYPH_COUNT];
+    for (int f = 0; f < FONT_COUNT; f++)
+        for (int i = 0; i < GLYPH_COUNT; i++)
+            advances[f][i] = 4 + (i * 7) % (widest[f] - 3);
+    atlas.layout(advances, lineHeights, 512, 512);
+}
+
+static std::vector<Benchmark> makeBenchmarks()
+{
+    std::vector<Benchmark> benches;
+
+    benches.push_back({"tick_medium", "ns per step() of a Medium game with the scripted player",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           warmUpWorld(world, MODE_MEDIUM, 1, 600);
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               step(world, scriptedPolicy(world));
+                               if (world.state != PLAYING)
+                                   resetWorld(world, MODE_MEDIUM);
+                           }
+                           benchSink = world.ballY;
+                           return iterations;
+                       }});
+
+    benches.push_back({"tick_dense_pipes", "ns per step() with the pipe queue kept full at 14 px spacing (shielded)",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           warmUpWorld(world, MODE_MEDIUM, 1, 600);
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               while (!world.pipes.full())
+                               {
+                                   float x = world.pipes.empty() ? -PIPE_WIDTH : world.pipes.back().x + 14.0f;
+                                   world.pipes.push_back(Pipe{x, 150.0f + (i * 37) % 200, x});
+                               }
+                               world.hasShield = true;
+                               world.activePowerUp = SHIELD;
+                               world.powerUpTimer = POWER_UP_DURATION;
+
+                               step(world, scriptedPolicy(world));
+                               if (world.state != PLAYING)
+                                   resetWorld(world, MODE_MEDIUM);
+                           }
+                           benchSink = world.ballY;
+                           return iterations;
+                       }});
+
+    benches.push_back({"vec_env_step", "ns per game tick through VecEnv (1024 Medium games, observation-driven player)",
+                       [](long long iterations, BenchTimer &timer) {
+                           const int GAMES = 1024;
+                           VecEnv env(GAMES, MODE_MEDIUM);
+                           std::vector<uint64_t> seeds(GAMES);
+                           for (int i = 0; i < GAMES; i++)
+                               seeds[i] = i + 1;
+                           env.reset(seeds.data());
+                           uint64_t nextSeed = GAMES + 1;
+
+                           std::vector<uint8_t> actions(GAMES), dones(GAMES);
+                           std::vector<float> observations(GAMES * OBSERVATION_SIZE), rewards(GAMES);
+                           env.observe(observations.data());
+                           long long ticks = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               // The scripted player's rule on observations: flap
+                               // when falling below the centre of the gap
+                               for (int g = 0; g < GAMES; g++)
+                               {
+                                   const float *o = &observations[g * OBSERVATION_SIZE];
+                                   float target = (o[OBS_PIPE_GAP_BOTTOM] + o[OBS_PIPE_GAP_TOP]) * 0.5f;
+                                   actions[g] = o[OBS_BALL_SPEED] > 0 && o[OBS_BALL_Y] < target;
+                               }
+                               env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+                               for (int g = 0; g < GAMES; g++)
+                               {
+                                   if (dones[g])
+                                       env.reset(g, nextSeed++);
+                               }
+                               ticks += GAMES;
+                           }
+                           benchSink = observations[0];
+                           return ticks;
+                       }});
+
+    benches.push_back({"plan_hard", "ns per JumpPlanner::plan() from a mid-game Hard state, pipes on screen plus the next gap",
+                       [](long long iterations, BenchTimer &timer) {
+                           // Snapshots a second apart; each plan covers about
+                           // two seconds of play
+                           const int STATES = 16;
+                           std::vector<World> worlds(STATES);
+                           World world;
+                           warmUpWorld(world, MODE_HARD, 1, 600);
+                           for (int s = 0; s < STATES; s++)
+                           {
+                               for (int t = 0; t < BASE_TICK_RATE; t++)
+                                   step(world, scriptedPolicy(world));
+                               if (world.state != PLAYING)
+                                   warmUpWorld(world, MODE_HARD, s + 2, 600);
+                               worlds[s] = world;
+                           }
+
+                           JumpPlanner planner;
+                           long long nodes = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               const World &state = worlds[i % STATES];
+                               float nextGap = 50.0f + (i * 97) % 300;
+                               planner.plan(state, &nextGap, 1, BASE_TICK_RATE * 10);
+                               nodes += planner.nodes();
+                           }
+                           benchSink = static_cast<float>(nodes);
+                           return iterations;
+                       }});
+
+    benches.push_back({"level_generate", "ns per generated Hard spawn (reachability-checked gap), games of 256 spawns",
+                       [](long long iterations, BenchTimer &timer) {
+                           LevelGenerator generator;
+                           SpawnEntry chunk[LEVEL_CHUNK_SIZE];
+                           uint64_t seed = 1;
+                           generator.reset(seed, MODE_HARD, modes[MODE_HARD - 1], DEFAULT_TUNING);
+                           long long entries = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               if (generator.generated() == 256)
+                                   generator.reset(++seed, MODE_HARD, modes[MODE_HARD - 1], DEFAULT_TUNING);
+                               generator.generate(chunk, LEVEL_CHUNK_SIZE);
+                               entries += LEVEL_CHUNK_SIZE;
+                           }
+                           benchSink = chunk[0].gapY;
+                           return entries;
+                       }});
+
+    benches.push_back({"collision_pipes", "ns per ball-vs-pipe test",
+                       [](long long iterations, BenchTimer &timer) {
+                           std::vector<Pipe> pipes;
+                           for (int i = 0; i < 64; i++)
+                               pipes.push_back(Pipe{BALL_X - PIPE_WIDTH + i * 4.0f, 150.0f + (i * 37) % 200, 0.0f});
+                           long long tests = 0;
+                           int hits = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               float ballY = 100.0f + (i % 400);
+                               for (const auto &pipe : pipes)
+                                   hits += ballHitsPipe(ballY, pipe, GAP_HEIGHT);
+                               tests += pipes.size();
+                           }
+                           benchSink = static_cast<float>(hits);
+                           return tests;
+                       }});
+
+    benches.push_back({"collision_powerups", "ns per ball-vs-power-up test",
+                       [](long long iterations, BenchTimer &timer) {
+                           PowerUpTable powerUps;
+                           for (int i = 0; i < 64; i++)
+                               powerUps.add(Scroll{BALL_X - 32.0f + i, 0.0f, POWER_UP_SPEED}, PowerUpBody{100.0f + (i * 53) % 400, i % 3});
+                           const Scroll *scroll = powerUps.column<Scroll>();
+                           const PowerUpBody *body = powerUps.column<PowerUpBody>();
+                           long long tests = 0;
+                           int hits = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               float ballY = 100.0f + (i % 400);
+                               for (int p = 0; p < powerUps.size(); p++)
+                                   hits += ballTouchesPowerUp(ballY, scroll[p].x, body[p].y);
+                               tests += powerUps.size();
+                           }
+                           benchSink = static_cast<float>(hits);
+                           return tests;
+                       }});
+
+    benches.push_back({"collision_pipes_swept", "ns per swept ball-vs-pipe test (one 15 Hz step at Hard speed)",
+                       [](long long iterations, BenchTimer &timer) {
+                           std::vector<Pipe> pipes;
+                           for (int i = 0; i < 64; i++)
+                           {
+                               float x = BALL_X - PIPE_WIDTH + i * 4.0f;
+                               pipes.push_back(Pipe{x, 150.0f + (i * 37) % 200, x + 16.0f});
+                           }
+                           long long tests = 0;
+                           int hits = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               float prevBallY = 100.0f + (i % 400);
+                               float ballY = prevBallY + static_cast<float>(i % 41) - 20.0f;
+                               for (const auto &pipe : pipes)
+                                   hits += sweepBallPipe(prevBallY, ballY, pipe, GAP_HEIGHT) >= 0.0f;
+                               tests += pipes.size();
+                           }
+                           benchSink = static_cast<float>(hits);
+                           return tests;
+                       }});
+
+    benches.push_back({"collision_powerups_swept", "ns per swept ball-vs-power-up test (one 15 Hz step)",
+                       [](long long iterations, BenchTimer &timer) {
+                           PowerUpTable powerUps;
+                           for (int i = 0; i < 64; i++)
+                           {
+                               float x = BALL_X - 32.0f + i;
+                               powerUps.add(Scroll{x, x + 4 * POWER_UP_SPEED, POWER_UP_SPEED}, PowerUpBody{100.0f + (i * 53) % 400, i % 3});
+                           }
+                           const Scroll *scroll = powerUps.column<Scroll>();
+                           const PowerUpBody *body = powerUps.column<PowerUpBody>();
+                           long long tests = 0;
+                           int hits = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               float prevBallY = 100.0f + (i % 400);
+                               float ballY = prevBallY + static_cast<float>(i % 41) - 20.0f;
+                               for (int p = 0; p < powerUps.size(); p++)
+                                   hits += sweepBallPowerUp(prevBallY, ballY, scroll[p], body[p].y) >= 0.0f;
+                               tests += powerUps.size();
+                           }
+                           benchSink = static_cast<float>(hits);
+                           return tests;
+                       }});
+
+    benches.push_back({"entities_vector_10x", "ns per entity per tick, 160 clouds and power-ups in per-type vectors",
+                       entityBench(160, false)});
+    benches.push_back({"entities_table_10x", "ns per entity per tick, 160 clouds and power-ups in entity tables",
+                       entityBench(160, true)});
+    benches.push_back({"entities_vector_100x", "ns per entity per tick, 1600 clouds and power-ups in per-type vectors",
+                       entityBench(1600, false)});
+    benches.push_back({"entities_table_100x", "ns per entity per tick, 1600 clouds and power-ups in entity tables",
+                       entityBench(1600, true)});
+
+    benches.push_back({"entities_scheduled_100x", "ns per entity per tick, 1600 in entity tables, systems staged on a thread pool",
+                       [](long long iterations, BenchTimer &timer) {
+                           const int COUNT = 1600;
+                           TableEntities entities;
+                           fillEntities(entities, COUNT);
+
+                           // One access bit per table column; the two kinds
+                           // never conflict, so each stage runs both at once
+                           enum
+                           {
+                               CLOUD_SCROLL = 1 << 0,
+                               POWER_UP_SCROLL = 1 << 1,
+                               POWER_UP_BODY = 1 << 2
+                           };
+                           float ballY = 0.0f;
+                           long long removed = 0;
+                           SystemSchedule schedule;
+                           schedule.add("scrollClouds", 0, CLOUD_SCROLL, [&] { scrollEntities(entities.clouds, 1.0f); });
+                           schedule.add("scrollPowerUps", 0, POWER_UP_SCROLL, [&] { scrollEntities(entities.powerUps, 1.0f); });
+                           schedule.add("wrapClouds", 0, CLOUD_SCROLL, [&] { wrapClouds(entities.clouds); });
+                           schedule.add("collectPowerUps", 0, POWER_UP_SCROLL | POWER_UP_BODY,
+                                        [&] { removed += collectPowerUps(entities.powerUps, ballY); });
+                           WorkStealingPool pool(2);
+
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               ballY = 100.0f + (i % 400);
+                               schedule.run(&pool);
+                           }
+                           benchSink = static_cast<float>(removed);
+                           return iterations * COUNT;
+                       }});
+
+    benches.push_back({"particle_update", "ns per particle per update() of 10000 live particles, respawning the expired ones",
+                       particleBench(10000)});
+    benches.push_back({"particle_update_100k", "ns per particle per update() of 100000 live particles, respawning the expired ones",
+                       particleBench(100000)});
+
+    benches.push_back({"particle_emit", "ns per particle spawned by the explosion, score and jump emitters",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           resetWorld(world, MODE_MEDIUM);
+                           long long spawned = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               world.particles.clear();
+                               createExplosionEffect(world, BALL_X, 300.0f, 1.0f, 0.2f, 0.2f);
+                               createScoreEffect(world, BALL_X, 300.0f);
+                               addParticles(world, BALL_X, 300.0f, 1.0f, 1.0f, 1.0f);
+                               spawned += world.particles.size();
+                           }
+                           benchSink = world.particles.x(0);
+                           return spawned;
+                       }});
+
+    benches.push_back({"circle_tessellation", "ns per circle at the game's radii (3-39 px)",
+                       [](long long iterations, BenchTimer &timer) {
+                           const float radii[] = {3.0f, 10.0f, 15.0f, 20.0f, 25.0f, 39.0f};
+                           VertexBatch batch;
+                           long long circles = 0;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               batch.clear();
+                               for (int c = 0; c < 64; c++)
+                                   batch.circle(100.0f + c, 200.0f, radii[c % 6]);
+                               circles += 64;
+                           }
+                           benchSink = batch.vertices().back().x;
+                           return circles;
+                       }});
+
+    benches.push_back({"render_commands", "ns per frame to build the playfield vertex batch mid-game",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           warmUpWorld(world, MODE_MEDIUM, 3, 1200);
+                           createExplosionEffect(world, BALL_X, world.ballY, 1.0f, 0.2f, 0.2f);
+                           world.hasShield = true;
+                           VertexBatch batch;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               batch.clear();
+                               drawWorldScene(batch, world, 0.5f);
+                           }
+                           benchSink = batch.vertices().back().x;
+                           return iterations;
+                       }});
+
+    benches.push_back({"snapshot_publish", "ns to copy a mid-game world (explosion in flight) into a triple buffer and take it on the other side",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           warmUpWorld(world, MODE_MEDIUM, 3, 1200);
+                           createExplosionEffect(world, BALL_X, world.ballY, 1.0f, 0.2f, 0.2f);
+                           TripleBuffer<World> snapshots;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               snapshots.writeBuffer() = world;
+                               snapshots.publish();
+                               snapshots.update();
+                           }
+                           benchSink = snapshots.readBuffer().ballY;
+                           return iterations;
+                       }});
+
+    benches.push_back({"text_hud", "ns per frame to draw the HUD text (score changing once a second) into the batch",
+                       [](long long iterations, BenchTimer &timer) {
+                           GlyphAtlas atlas;
+                           layoutSyntheticAtlas(atlas);
+                           VertexBatch batch;
+                           CachedText score, lives, seconds;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               batch.clear();
+                               score.setNumber("Score: ", static_cast<int>(i / 60));
+                               score.draw(batch, atlas, 10, WINDOW_HEIGHT - 30);
+                               lives.setNumber("Lives: ", 3);
+                               lives.draw(batch, atlas, 10, WINDOW_HEIGHT - 50);
+                               seconds.setNumber("", 5 - static_cast<int>(i / 60) % 5, "s");
+                               seconds.draw(batch, atlas, 30, WINDOW_HEIGHT - 125);
+                           }
+                           benchSink = batch.vertices().back().x;
+                           return iterations;
+                       }});
+
+    // Macro scenarios: one operation is a whole run
+    benches.push_back({"macro_hard_10k_ticks", "ns per 10000-tick Hard run (restarting on game over)",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               warmUpWorld(world, MODE_HARD, 42, 10000);
+                               benchSink = world.ballY;
+                           }
+                           return iterations;
+                       }});
+
+    benches.push_back({"macro_max_particle_explosion", "ns per explosion that fills the particle pool, simulated and drawn until it fades",
+                       [](long long iterations, BenchTimer &timer) {
+                           World world;
+                           world.seed = 7;
+                           resetWorld(world, MODE_MEDIUM);
+                           VertexBatch batch;
+                           timer.start();
+                           for (long long i = 0; i < iterations; i++)
+                           {
+                               world.particles.clear();
+                               while (!world.particles.full())
+                                   createExplosionEffect(world, BALL_X, world.ballY, 1.0f, 0.2f, 0.2f);
+                               while (world.particles.size() > 0)
+                               {
+                                   world.particles.update(1.0f);
+                                   batch.clear();
+                                   drawParticles(batch, world.particles, 1.0f);
+                               }
+                           }
+                           benchSink = static_cast<float>(batch.vertices().size());
+                           return iterations;
+                       }});
+
+    return benches;
+}
+
+static bool writeJson(const std::vector<BenchResult> &results, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+    fprintf(file, "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        fprintf(file, "    {\"name\": \"%s\", \"value\": %.3f, \"iterations\": %lld}%s\n",
+                results[i].name.c_str(), results[i].nsPerOp, results[i].iterations,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+// Reads back the "name"/"value" pairs of a file written by writeJson()
+static bool readBaselines(const char *path, std::map<std::string, double> &baselines)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        text.append(chunk, n);
+    fclose(file);
+
+    const char *key = "\"name\": \"";
+    for (size_t pos = text.find(key); pos != std::string::npos; pos = text.find(key, pos))
+    {
+        pos += strlen(key);
+        size_t end = text.find('"', pos);
+        size_t value = text.find("\"value\":", end);
+        if (end == std::string::npos || value == std::string::npos)
+            return false;
+        baselines[text.substr(pos, end - pos)] = atof(text.c_str() + value + 8);
+    }
+    return !baselines.empty();
+}
+
+static void printUsage(const char *argv0)
+{
+    printf("Usage: %s [--filter TEXT] [--json FILE] [--baseline FILE] [--threshold PCT]\n", argv0);
+    printf("          [--samples N] [--sample-ms MS] [--list]\n");
+    printf("  --filter     Only run benchmarks whose name contains TEXT\n");
+    printf("  --json       Write the results as JSON (same format as the baselines)\n");
+    printf("  --baseline   Compare against a results file; exit 1 if any benchmark is slower\n");
+    printf("               than its baseline by more than the threshold\n");
+    printf("  --threshold  Allowed slowdown in percent, default 15\n");
+    printf("  --samples    Timed samples per benchmark (the fastest is reported), default 7\n");
+    printf("  --sample-ms  Minimum duration of one sample, default 50\n");
+    printf("  --list       List the benchmarks and exit\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = nullptr;
+    const char *jsonPath = nullptr;
+    const char *baselinePath = nullptr;
+    double threshold = 15.0;
+    int samples = 7;
+    double sampleMs = 50.0;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sample-ms") == 0 && i + 1 < argc)
+        {
+            sampleMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            listOnly = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (samples <= 0 || sampleMs <= 0.0 || threshold < 0.0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> baselines;
+    if (baselinePath && !readBaselines(baselinePath, baselines))
+    {
+        printf("Failed to read baselines from %s\n", baselinePath);
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (const auto &bench : makeBenchmarks())
+    {
+        if (filter && !strstr(bench.name, filter))
+            continue;
+        if (listOnly)
+        {
+            printf("%-30s %s\n", bench.name, bench.description);
+            continue;
+        }
+
+        BenchResult result = measure(bench, sampleMs / 1000.0, samples);
+        results.push_back(result);
+        printf("%-30s %14.2f ns/op", bench.name, result.nsPerOp);
+
+        auto baseline = baselines.find(bench.name);
+        if (baseline != baselines.end() && baseline->second > 0.0)
+        {
+            double change = (result.nsPerOp / baseline->second - 1.0) * 100.0;
+            bool regressed = change > threshold;
+            regressions += regressed;
+            printf("  %+7.1f%% vs baseline%s", change, regressed ? "  REGRESSION" : "");
+        }
+        printf("\n");
+    }
+
+    if (jsonPath && !writeJson(results, jsonPath))
+    {
+        printf("Failed to write %s\n", jsonPath);
+        return 1;
+    }
+
+    if (regressions)
+    {
+        printf("%d benchmark(s) regressed by more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    return 0;
+}
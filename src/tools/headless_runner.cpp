@@ -0,0 +1,482 @@
+// Headless simulation runner: steps worlds as fast as the CPU allows and
+// reports throughput. No window, GL context or audio device is needed.
+#include "world.h"
+#include "level_generator.h"
+#include "planner.h"
+#include "policy.h"
+#include "replay.h"
+#include "tuning.h"
+#include "vec_env.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static void printUsage(const char *argv0)
+{
+    printf("Usage: %s [--mode 1-4] [--worlds N] [--ticks N] [--tick-rate HZ] [--autopilot]\n", argv0);
+    printf("          [--generated-levels] [--swept-collisions]\n");
+    printf("       %s --record FILE [--mode 1-4] [--seed N] [--tick-rate HZ] [--autopilot]\n", argv0);
+    printf("          [--generated-levels] [--swept-collisions]\n");
+    printf("       %s --replay FILE\n", argv0);
+    printf("       %s --collision-check N [--seed N]\n", argv0);
+    printf("       %s --vec-env-check N [--mode 1-4] [--seed N] [--tick-rate HZ] [--tuning FILE]\n", argv0);
+    printf("  --mode       Game mode (1: Easy, 2: Medium, 3: Hard, 4: Time Trial), default 2\n");
+    printf("  --worlds     Number of independent worlds to simulate, default 64\n");
+    printf("  --ticks      Ticks to step per world, default 100000\n");
+    printf("  --tick-rate  Simulation steps per second, default %d\n", BASE_TICK_RATE);
+    printf("  --seed       Seed of the first world (world i uses seed + i), default 1\n");
+    printf("  --autopilot  Play with planned jumps (see planner.h) instead of the scripted player\n");
+    printf("  --generated-levels\n");
+    printf("               Spawn from a level generator thread (see level_generator.h)\n");
+    printf("  --swept-collisions\n");
+    printf("               Test collisions along each step instead of at its end (for low tick rates)\n");
+    printf("  --record     Play one game and save its replay\n");
+    printf("  --replay     Re-simulate a replay as fast as possible and verify its final state\n");
+    printf("  --collision-check\n");
+    printf("               Compare the swept collision tests with a fine-step reference on N random steps\n");
+    printf("  --vec-env-check\n");
+    printf("               Step VecEnv and World side by side for N game ticks and compare every game\n");
+    printf("  --tuning     Tuning file for --vec-env-check, default built-in values\n");
+}
+
+// Next input from the scripted player, or the autopilot if there is one
+static Input nextInput(const World &world, Autopilot *autopilot)
+{
+    return autopilot ? autopilot->next(world) : scriptedPolicy(world);
+}
+
+// Play one game to the end and save it as a replay
+static int recordGame(const char *path, GameMode mode, uint64_t seed, int tickRate, Autopilot *autopilot,
+                      LevelFeed *levelFeed, bool sweptCollisions)
+{
+    World world;
+    world.levelFeed = levelFeed;
+    world.sweptCollisions = sweptCollisions;
+    world.tickRate = tickRate;
+    world.seed = seed;
+    resetWorld(world, mode);
+
+    // The scripted player survives for a very long time on easier modes, so
+    // stop after ten minutes of game time
+    Replay replay;
+    beginRecording(replay, world);
+    for (int t = 0; t < tickRate * 600 && world.state == PLAYING; t++)
+    {
+        Input input = nextInput(world, autopilot);
+        recordInput(replay, input);
+        step(world, input);
+    }
+    finishRecording(replay, world);
+
+    if (!saveReplay(replay, path))
+    {
+        printf("Failed to write replay %s\n", path);
+        return 1;
+    }
+    printf("Recorded %d ticks (%.1f s of play, %d jumps, score %d) to %s\n",
+           replay.tickCount, (double)replay.tickCount / tickRate,
+           static_cast<int>(replay.jumpTicks.size()), world.score, path);
+    return 0;
+}
+
+// Re-simulate a replay without rendering and compare the final state hash
+static int runReplay(const char *path)
+{
+    Replay replay;
+    if (!loadReplay(replay, path))
+    {
+        printf("Failed to load replay %s\n", path);
+        return 1;
+    }
+
+    // Generated levels come out the same without a worker thread
+    World world;
+    LevelFeed levelFeed(false);
+    if (replay.generatedLevels)
+        world.levelFeed = &levelFeed;
+    auto start = std::chrono::steady_clock::now();
+    playReplay(world, replay);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t hash = worldHash(world);
+    printf("Replayed %d ticks (%.1f s of play at %d Hz) in %.3f ms\n",
+           replay.tickCount, (double)replay.tickCount / replay.tickRate, replay.tickRate, seconds * 1000.0);
+    printf("Final score %d, lives %d, state hash %016llx\n",
+           world.score, world.lives, static_cast<unsigned long long>(hash));
+
+    if (replay.finalHash == 0)
+    {
+        printf("Replay has no recorded hash, nothing to verify\n");
+        return 0;
+    }
+    if (hash != replay.finalHash)
+    {
+        printf("MISMATCH: recorded hash %016llx\n", static_cast<unsigned long long>(replay.finalHash));
+        return 1;
+    }
+    printf("Matches the recorded run\n");
+    return 0;
+}
+
+// Substeps of the reference the swept tests are checked against
+static const int REFERENCE_SUBSTEPS = 1024;
+
+// First of `samples` + 1 evenly spaced times in [from, to] at which hitAt()
+// holds, or -1
+template <typename HitAt>
+static float firstHit(HitAt hitAt, float from, float to, int samples)
+{
+    for (int k = 0; k <= samples; k++)
+    {
+        float t = from + (to - from) * k / samples;
+        if (hitAt(t))
+            return t;
+    }
+    return -1.0f;
+}
+
+// Tally of one swept test against the reference
+struct SweepCheck
+{
+    long long hits = 0;          // Steps the reference reports a hit on
+    long long endMisses = 0;     // ...that the end-of-step test misses
+    long long grazes = 0;        // Hits that start between two substeps
+    long long disagreements = 0; // Missed hits, or impacts the reference does not confirm
+    double maxError = 0.0;       // Between the impact and the first hitting substep
+
+    // hitAt(t) tells whether the shapes overlap at fraction t of the step
+    template <typename HitAt>
+    void add(HitAt hitAt, float toi)
+    {
+        const float substep = 1.0f / REFERENCE_SUBSTEPS;
+        float reference = firstHit(hitAt, 0.0f, 1.0f, REFERENCE_SUBSTEPS);
+        if (reference >= 0.0f)
+        {
+            hits++;
+            endMisses += !hitAt(1.0f);
+        }
+        if (toi < 0.0f)
+        {
+            disagreements += reference >= 0.0f;
+            return;
+        }
+
+        // The impact must come no later than the first hitting substep; an
+        // earlier one has to show up in a finer look at the substep after it
+        if (reference >= 0.0f && toi <= reference + 1e-4f && toi >= reference - substep - 1e-4f)
+        {
+            maxError = std::max(maxError, static_cast<double>(reference - toi));
+        }
+        else if ((reference < 0.0f || toi < reference) && firstHit(hitAt, toi, std::min(toi + substep, 1.0f), 256) >= 0.0f)
+        {
+            grazes++;
+        }
+        else
+        {
+            disagreements++;
+        }
+    }
+
+    void print(const char *name, long long cases) const
+    {
+        printf("%-10s %lld steps, %lld hits, %lld missed by the end-of-step test, %lld grazes between substeps,\n",
+               name, cases, hits, endMisses, grazes);
+        printf("           %lld disagreements, max time-of-impact error %.5f of a step\n", disagreements, maxError);
+    }
+};
+
+// Random steps (pipe speeds and ball moves up to those of a 10 Hz Time Trial
+// late game) through sweepBallPipe() and sweepBallPowerUp(), against the same
+// motion sampled at REFERENCE_SUBSTEPS points with the end-of-step tests
+static int runCollisionCheck(long long cases, uint64_t seed)
+{
+    Rng rng(seed, 4);
+    SweepCheck pipeCheck, powerUpCheck;
+    for (long long c = 0; c < cases; c++)
+    {
+        float prevBallY = rng.unit() * WINDOW_HEIGHT;
+        float ballY = prevBallY + (rng.unit() - 0.5f) * 160.0f;
+
+        Pipe pipe;
+        float pipeStep = 0.5f + rng.unit() * 90.0f;
+        float pipeRange = PIPE_WIDTH + 2 * ballRadius + pipeStep + 40.0f;
+        pipe.prevX = BALL_X - PIPE_WIDTH - ballRadius - 20.0f + rng.unit() * pipeRange;
+        pipe.x = pipe.prevX - pipeStep;
+        pipe.gapY = 50.0f + rng.unit() * 300.0f;
+        float gapHeight = 2 * ballRadius + rng.unit() * 200.0f;
+        auto pipeHitAt = [&](float t) {
+            Pipe moved = pipe;
+            moved.x = interpolate(pipe.prevX, pipe.x, t);
+            return ballHitsPipe(interpolate(prevBallY, ballY, t), moved, gapHeight);
+        };
+        pipeCheck.add(pipeHitAt, sweepBallPipe(prevBallY, ballY, pipe, gapHeight));
+
+        Scroll powerUp;
+        powerUp.speed = 0.5f + rng.unit() * 6 * POWER_UP_SPEED;
+        float reach = ballRadius + POWER_UP_RADIUS;
+        powerUp.prevX = BALL_X - reach - 10.0f + rng.unit() * (2 * reach + powerUp.speed + 20.0f);
+        powerUp.x = powerUp.prevX - powerUp.speed;
+        float powerUpY = prevBallY + (rng.unit() - 0.5f) * 200.0f;
+        auto powerUpHitAt = [&](float t) {
+            return ballTouchesPowerUp(interpolate(prevBallY, ballY, t), interpolate(powerUp.prevX, powerUp.x, t), powerUpY);
+        };
+        powerUpCheck.add(powerUpHitAt, sweepBallPowerUp(prevBallY, ballY, powerUp, powerUpY));
+    }
+
+    pipeCheck.print("Pipes:", cases);
+    powerUpCheck.print("Power-ups:", cases);
+    return pipeCheck.disagreements + powerUpCheck.disagreements == 0 ? 0 : 1;
+}
+
+// First gameplay field in which the world differs from the VecEnv game
+// copied into `copy`, or nullptr if none does
+static const char *gameplayDifference(const World &world, const World &copy)
+{
+    if (world.state != copy.state)
+        return "state";
+    if (world.state != PLAYING)
+        return nullptr; // VecEnv stops updating finished games
+    if (world.score != copy.score || world.lives != copy.lives || world.tickCount != copy.tickCount)
+        return "score, lives or tick count";
+    if (world.ballY != copy.ballY || world.ballSpeed != copy.ballSpeed)
+        return "ball";
+    if (world.invincibilityTimer != copy.invincibilityTimer || world.spawnTimer != copy.spawnTimer ||
+        world.powerUpTimer != copy.powerUpTimer || world.activePowerUp != copy.activePowerUp ||
+        world.timeTrialTimer != copy.timeTrialTimer || world.lastDifficultyIncrease != copy.lastDifficultyIncrease)
+        return "timers";
+    if (world.currentPipeSpeed != copy.currentPipeSpeed || world.currentGapHeight != copy.currentGapHeight ||
+        world.currentGravity != copy.currentGravity)
+        return "difficulty";
+    if (world.pipes.size() != copy.pipes.size())
+        return "pipe count";
+    for (int p = 0; p < world.pipes.size(); p++)
+    {
+        if (world.pipes[p].x != copy.pipes[p].x || world.pipes[p].gapY != copy.pipes[p].gapY)
+            return "pipes";
+    }
+    if (world.powerUps.size() != copy.powerUps.size())
+        return "power-up count";
+    for (int p = 0; p < world.powerUps.size(); p++)
+    {
+        if (world.powerUps.get<Scroll>(p).x != copy.powerUps.get<Scroll>(p).x ||
+            world.powerUps.get<PowerUpBody>(p).y != copy.powerUps.get<PowerUpBody>(p).y ||
+            world.powerUps.get<PowerUpBody>(p).type != copy.powerUps.get<PowerUpBody>(p).type)
+            return "power-ups";
+    }
+    Rng worldRng = world.rng, copyRng = copy.rng;
+    if (worldRng.next() != copyRng.next())
+        return "random generator";
+    return nullptr;
+}
+
+// Step a VecEnv and one World per game with the same seeds and jumps (the
+// scripted player with one input in 500 flipped) and compare every game after
+// every tick through copyToWorld(); finished games restart with new seeds
+static int runVecEnvCheck(long long ticks, GameMode mode, uint64_t seed, int tickRate, const Tuning &tuning)
+{
+    const int GAMES = 64;
+    VecEnv env(GAMES, mode, tickRate, tuning);
+    std::vector<World> worlds(GAMES);
+    std::vector<uint64_t> seeds(GAMES);
+    std::vector<uint8_t> actions(GAMES);
+    uint64_t nextSeed = seed;
+    for (int i = 0; i < GAMES; i++)
+    {
+        seeds[i] = nextSeed++;
+        worlds[i].tuning = tuning;
+        worlds[i].tickRate = tickRate;
+        worlds[i].seed = seeds[i];
+        resetWorld(worlds[i], mode);
+    }
+    env.reset(seeds.data());
+
+    Rng rng(seed, 5);
+    World copy;
+    long long checked = 0, games = GAMES, differences = 0;
+    for (int tick = 0; checked < ticks; tick++)
+    {
+        for (int i = 0; i < GAMES; i++)
+        {
+            bool jump = scriptedPolicy(worlds[i]).jump;
+            actions[i] = rng.below(500) == 0 ? !jump : jump;
+        }
+        env.step(actions.data(), nullptr, nullptr, nullptr);
+        for (int i = 0; i < GAMES; i++)
+        {
+            World &world = worlds[i];
+            step(world, Input{actions[i] != 0});
+            env.copyToWorld(i, copy);
+            const char *difference = gameplayDifference(world, copy);
+            checked++;
+            if (difference)
+            {
+                if (differences++ < 10)
+                    printf("Game %d (seed %llu) differs in %s after tick %d\n", i,
+                           static_cast<unsigned long long>(seeds[i]), difference, world.tickCount);
+                world.state = GAME_OVER; // Report each game once
+            }
+            if (world.state != PLAYING)
+            {
+                seeds[i] = nextSeed++;
+                world.seed = seeds[i];
+                resetWorld(world, mode);
+                env.reset(i, seeds[i]);
+                games++;
+            }
+        }
+    }
+
+    printf("VecEnv check: %lld game ticks in %lld games (mode %d, %d Hz, %d pipe slots), %lld differences\n",
+           checked, games, mode, tickRate, env.pipeSlots(), differences);
+    return differences == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int mode = MODE_MEDIUM;
+    int worldCount = 64;
+    long ticksPerWorld = 100000;
+    int tickRate = BASE_TICK_RATE;
+    uint64_t seed = 1;
+    const char *recordPath = nullptr;
+    Autopilot autopilotStorage;
+    Autopilot *autopilot = nullptr;
+    LevelFeed levelFeed;
+    bool generatedLevels = false;
+    bool sweptCollisions = false;
+    long long collisionChecks = 0;
+    long long vecEnvChecks = 0;
+    const char *tuningPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+        {
+            mode = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--worlds") == 0 && i + 1 < argc)
+        {
+            worldCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+        {
+            ticksPerWorld = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            tickRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--autopilot") == 0)
+        {
+            autopilot = &autopilotStorage;
+        }
+        else if (strcmp(argv[i], "--generated-levels") == 0)
+        {
+            generatedLevels = true;
+        }
+        else if (strcmp(argv[i], "--swept-collisions") == 0)
+        {
+            sweptCollisions = true;
+        }
+        else if (strcmp(argv[i], "--collision-check") == 0 && i + 1 < argc)
+        {
+            collisionChecks = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--vec-env-check") == 0 && i + 1 < argc)
+        {
+            vecEnvChecks = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tuning") == 0 && i + 1 < argc)
+        {
+            tuningPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            return runReplay(argv[++i]);
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mode < MODE_EASY || mode > MODE_TIME_TRIAL || worldCount <= 0 || ticksPerWorld <= 0 || tickRate <= 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (collisionChecks > 0)
+        return runCollisionCheck(collisionChecks, seed);
+    if (vecEnvChecks > 0)
+    {
+        Tuning tuning = DEFAULT_TUNING;
+        std::string error;
+        if (tuningPath && !loadTuning(tuning, tuningPath, error))
+        {
+            printf("%s\n", error.c_str());
+            return 1;
+        }
+        return runVecEnvCheck(vecEnvChecks, static_cast<GameMode>(mode), seed, tickRate, tuning);
+    }
+    if (recordPath)
+        return recordGame(recordPath, static_cast<GameMode>(mode), seed, tickRate, autopilot,
+                          generatedLevels ? &levelFeed : nullptr, sweptCollisions);
+
+    long long totalTicks = 0;
+    long long gamesFinished = 0;
+    long long totalScore = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    World world;
+    world.tickRate = tickRate;
+    world.sweptCollisions = sweptCollisions;
+    if (generatedLevels)
+        world.levelFeed = &levelFeed;
+    for (int w = 0; w < worldCount; w++)
+    {
+        world.seed = seed + w;
+        resetWorld(world, static_cast<GameMode>(mode));
+        autopilotStorage.reset();
+        for (long t = 0; t < ticksPerWorld; t++)
+        {
+            step(world, nextInput(world, autopilot));
+            if (world.state == GAME_OVER)
+            {
+                gamesFinished++;
+                totalScore += world.score;
+                world.seed += worldCount; // Stay clear of the other worlds' seeds
+                resetWorld(world, static_cast<GameMode>(mode));
+                autopilotStorage.reset();
+            }
+        }
+        totalTicks += ticksPerWorld;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Simulated %lld ticks across %d worlds in %.3f s\n", totalTicks, worldCount, seconds);
+    printf("Throughput: %.0f ticks/s (%.1fx real time at %d Hz)\n",
+           totalTicks / seconds, totalTicks / seconds / tickRate, tickRate);
+    printf("Games finished: %lld, mean score: %.2f\n",
+           gamesFinished, gamesFinished ? (double)totalScore / gamesFinished : 0.0);
+    if (generatedLevels)
+        printf("Level generator stalls: %lld\n", levelFeed.stalls());
+    return 0;
+}